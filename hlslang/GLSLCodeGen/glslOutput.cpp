@@ -370,7 +370,7 @@ void TGlslOutputTraverser::traverseArrayDeclarationWithInit(TIntermDeclaration*
 	assert(decl->containsArrayInitialization());
 	
 	std::stringstream* out = &current->getActiveOutput();
-	TType& type = *decl->getTypePointer();
+	const TType& type = decl->getType();
 	EGlslSymbolType symbol_type = translateType(decl->getTypePointer());
 	
 	const bool emit_120_arrays = (m_TargetVersion >= ETargetGLSL_120);
@@ -489,7 +489,7 @@ bool TGlslOutputTraverser::traverseDeclaration(bool preVisit, TIntermDeclaration
 		return false;
 	}
 
-	TType& type = *decl->getTypePointer();
+	const TType& type = decl->getType();
 	if (type.getBasicType() == EbtTexture)
 	{
 		// right now we can't do anything with "texture" type, just skip it
@@ -1845,7 +1845,7 @@ bool TGlslOutputTraverser::traverseBranch( bool preVisit, TIntermBranch *node,
 }
 
 
-GlslStruct *TGlslOutputTraverser::createStructFromType (TType *type)
+GlslStruct *TGlslOutputTraverser::createStructFromType (const TType *type)
 {
    GlslStruct *s = 0;
    std::string structName = type->getTypeName().c_str();
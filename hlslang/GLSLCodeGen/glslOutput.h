@@ -35,7 +35,7 @@ private:
 
 public:
 	TGlslOutputTraverser (TInfoSink& i, std::vector<GlslFunction*> &funcList, std::vector<GlslStruct*> &sList, std::stringstream& deferredArrayInit, std::stringstream& deferredMatrixInit, ETargetVersion version, unsigned options);
-	GlslStruct *createStructFromType( TType *type );
+	GlslStruct *createStructFromType( const TType *type );
 	
 	// Info Sink
 	TInfoSink& infoSink;
@@ -9,16 +9,26 @@
 #include "typeSamplers.h"
 #include "propagateMutable.h"
 #include "hlslLinker.h"
+#include "ParseHelper.h"
 
 HlslCrossCompiler::HlslCrossCompiler(EShLanguage l)
 :	language(l)
-,	m_ASTTransformed(false)
-,	m_GlslProduced(false)
+,	m_Source(NULL)
+,	m_AST(NULL)
+,	m_ASTVersion(ETargetGLSL_110)
+,	m_HasParseKey(false)
 {
 	linker = new HlslLinker(infoSink);
 }
 
 HlslCrossCompiler::~HlslCrossCompiler()
+{
+   SetSource(NULL);
+   delete linker;
+}
+
+
+void HlslCrossCompiler::DeleteGlslCode()
 {
    for ( std::vector<GlslFunction*>::iterator it = functionList.begin() ; it != functionList.end(); it++)
    {
@@ -29,20 +39,76 @@ HlslCrossCompiler::~HlslCrossCompiler()
    {
       delete *it;
    }
+   functionList.clear();
+   structList.clear();
+   m_DeferredArrayInit.str("");
+   m_DeferredMatrixInit.str("");
+}
+
+
+void HlslCrossCompiler::Reset()
+{
+   SetSource(NULL);
+   infoSink.info.erase();
+   infoSink.debug.erase();
+
    delete linker;
+   linker = new HlslLinker(infoSink);
+
+   m_HasParseKey = false;
 }
 
 
-void HlslCrossCompiler::TransformAST (TIntermNode *root)
+void HlslCrossCompiler::SetSource (TPreprocessedSource* source)
 {
-	m_ASTTransformed = true;
-	PropagateSamplerTypes (root, infoSink);
-	PropagateMutableUniforms (root, infoSink);
+   DeleteAST();
+   delete m_Source;
+   m_Source = source;
 }
 
-void HlslCrossCompiler::ProduceGLSL (TIntermNode *root, ETargetVersion version, unsigned options)
+
+void HlslCrossCompiler::SetAST (TIntermNode* root, ETargetVersion version)
 {
-	m_GlslProduced = true;
+   m_AST = root;
+   m_ASTVersion = version;
+}
+
+
+void HlslCrossCompiler::DeleteAST()
+{
+   DeleteGlslCode();
+   m_AST = NULL;
+   m_ASTTypes.clear();
+   m_ASTPool.popAll();
+}
+
+
+void HlslCrossCompiler::TransformAST()
+{
+	if (!m_AST)
+		return;
+
+	TPoolAllocator* threadPool = &GlobalPoolAllocator;
+	SetGlobalPoolAllocatorPtr(&m_ASTPool);
+	TTypeTable::setCurrent(&m_ASTTypes);
+	PropagateSamplerTypes (m_AST, infoSink);
+	PropagateMutableUniforms (m_AST, infoSink);
+	TTypeTable::setCurrent(NULL);
+	SetGlobalPoolAllocatorPtr(threadPool);
+}
+
+void HlslCrossCompiler::ProduceGLSL (ETargetVersion version, unsigned options)
+{
+	DeleteGlslCode();
+
+	// the GLSL code doesn't point into the pool, so this can all be thrown away
+	TPoolAllocator* threadPool = &GlobalPoolAllocator;
+	SetGlobalPoolAllocatorPtr(&m_ASTPool);
+	m_ASTPool.push();
+
 	TGlslOutputTraverser glslTraverse (infoSink, functionList, structList, m_DeferredArrayInit, m_DeferredMatrixInit, version, options);
-	root->traverse(&glslTraverse);
+	m_AST->traverse(&glslTraverse);
+
+	m_ASTPool.pop();
+	SetGlobalPoolAllocatorPtr(threadPool);
 }
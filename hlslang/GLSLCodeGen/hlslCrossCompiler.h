@@ -11,6 +11,7 @@
 
 #include "glslFunction.h"
 #include "glslStruct.h"
+#include "TranslationCache.h"
 
 class HlslLinker;
 
@@ -20,20 +21,44 @@ public:
    HlslCrossCompiler(EShLanguage l);
    ~HlslCrossCompiler();
 
+   // Forget everything about the previous shader, so the compiler can be reused for another one.
+   void Reset();
+
    EShLanguage getLanguage() const { return language; }
    TInfoSink& getInfoSink() { return infoSink; }
 
-   void TransformAST (TIntermNode* root);
-   void ProduceGLSL (TIntermNode* root, ETargetVersion version, unsigned options);
-   bool IsASTTransformed() const { return m_ASTTransformed; }
-   bool IsGlslProduced() const { return m_GlslProduced; }
+   // The shader from the last Hlsl2Glsl_Parse, kept so that it can be translated any
+   // number of times. Setting it drops the AST and GLSL code of the previous one.
+   void SetSource (TPreprocessedSource* source);
+   const TPreprocessedSource* GetSource() const { return m_Source; }
+
+   // The AST lives in this compiler's own pool; make it the global one while building
+   // or using the AST. It only depends on whether the target version is before GLSL 1.20
+   // (see TParseContext::targetVersion), so one AST serves several target versions.
+   TPoolAllocator& GetASTPool() { return m_ASTPool; }
+   // The types of the AST's nodes; make it the current one along with the pool.
+   TTypeTable& GetASTTypes() { return m_ASTTypes; }
+   void SetAST (TIntermNode* root, ETargetVersion version);
+   bool HasAST (ETargetVersion version) const { return m_AST && (m_ASTVersion < ETargetGLSL_120) == (version < ETargetGLSL_120); }
+   void DeleteAST();
+
+   void TransformAST();
+
+   // Generates the GLSL code for the AST, replacing any earlier code. Linking changes
+   // the code, so this is done for every link.
+   void ProduceGLSL (ETargetVersion version, unsigned options);
 
    HlslLinker* GetLinker() { return linker; }
 
 private:
+	void DeleteGlslCode();
+
 	EShLanguage language;
-	bool m_ASTTransformed;
-	bool m_GlslProduced;
+	TPreprocessedSource* m_Source;
+	TPoolAllocator m_ASTPool;
+	TTypeTable m_ASTTypes;
+	TIntermNode* m_AST;
+	ETargetVersion m_ASTVersion;
 
 public:
 	HlslLinker* linker;
@@ -42,6 +67,10 @@ public:
 	std::vector<GlslStruct*> structList;
 	std::stringstream m_DeferredArrayInit;
 	std::stringstream m_DeferredMatrixInit;
+
+	// Key of the last Hlsl2Glsl_Parse, for the translation cache
+	bool m_HasParseKey;
+	TCacheKey m_ParseKey;
 };
 
 #endif //HLSL_CROSS_COMPILER_H
@@ -309,6 +309,13 @@ HlslLinker::HlslLinker(TInfoSink& infoSink_)
 
 
 HlslLinker::~HlslLinker()
+{
+	clearOutput();
+}
+
+
+// Each link replaces the output of the previous one.
+void HlslLinker::clearOutput()
 {
 	for ( std::vector<ShUniformInfo>::iterator it = uniforms.begin(); it != uniforms.end(); it++)
 	{
@@ -317,6 +324,10 @@ HlslLinker::~HlslLinker()
 		delete [] it->registerSpec;
 		delete [] it->init;
 	}
+	uniforms.clear();
+	shaderPrefix.str("");
+	shader.str("");
+	m_Extensions.clear();
 }
 
 static const char* get_builtin_variable_from_semantic(EAttribSemantic sem, ETargetVersion targetVersion)
@@ -957,7 +968,7 @@ void HlslLinker::emitLibraryFunctions(const std::set<TOperator>& libFunctions, E
 	{
 		for (std::set<TOperator>::const_iterator it = libFunctions.begin(); it != libFunctions.end(); it++)
 		{
-			const std::string &func = getHLSLSupportCode(*it, m_Extensions, lang==EShLangVertex, usePrecision);
+			const std::string &func = getHLSLSupportCode(m_Target, *it, m_Extensions, lang==EShLangVertex, usePrecision);
 			if (!func.empty())
 			{
 				shaderLibFunctions += func;
@@ -1538,9 +1549,9 @@ void HlslLinker::markDuplicatedInSemantics(GlslFunction* func)
 
 bool HlslLinker::link(HlslCrossCompiler* compiler, const char* entryFunc, ETargetVersion targetVersion, unsigned options)
 {
+	clearOutput();
 	m_Target = targetVersion;
 	m_Options = options;
-	m_Extensions.clear();
 	if (!linkerSanityCheck(compiler, entryFunc))
 		return false;
 	
@@ -1717,6 +1728,15 @@ static std::string CleanupShaderText (const std::string& prefix, const std::stri
 
 
 
+void HlslLinker::setLinkResult (const std::string& prefix, const std::string& text, const std::vector<ShUniformInfo>& uniformInfo)
+{
+	clearOutput();
+	shaderPrefix << prefix;
+	shader << text;
+	uniforms = uniformInfo;
+}
+
+
 const char* HlslLinker::getShaderText() const 
 {
 	bs = CleanupShaderText (shaderPrefix.str(), shader.str());
@@ -41,16 +41,22 @@ public:
    bool link(HlslCrossCompiler*, const char* entry, ETargetVersion version, unsigned options);
 
    bool setUserAttribName (EAttribSemantic eSemantic, const char *pName);
+   const char* getUserAttribName (EAttribSemantic eSemantic) const { return userAttribString[eSemantic]; }
 
    const char* getShaderText() const;
       
    int getUniformCount() const { return (int)uniforms.size(); }
    const ShUniformInfo* getUniformInfo() const  { return (!uniforms.empty()) ? &uniforms[0] : 0; }
+
+   // Output of a link, for the translation cache. When set, the linker takes over the uniforms' strings.
+   void getLinkResult (std::string& prefix, std::string& text) const { prefix = shaderPrefix.str(); text = shader.str(); }
+   void setLinkResult (const std::string& prefix, const std::string& text, const std::vector<ShUniformInfo>& uniforms);
    
 private:
 	typedef std::vector<GlslFunction*> FunctionSet;
 	typedef std::set<std::string> ExtensionSet;
 
+	void clearOutput();
 	std::string stripSemanticModifier(const std::string &semantic, bool warn);
 	EAttribSemantic parseAttributeSemantic(const std::string &semantic);
 	
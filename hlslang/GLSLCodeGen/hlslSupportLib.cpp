@@ -10,338 +10,353 @@
 #include "hlslSupportLib.h"
 
 typedef std::map<TOperator,std::string> CodeMap;
-static CodeMap *hlslSupportLib = 0;
-static CodeMap *hlslSupportLibESOverrides = 0;
+typedef std::pair<std::string,std::string> CodeExtension; // vertex, fragment
+typedef std::map<TOperator,CodeExtension> CodeExtensionMap;
 
-typedef std::map< TOperator, std::pair<std::string,std::string> > CodeExtensionMap;
-static CodeExtensionMap *hlslSupportLibExtensions = 0;
-static CodeExtensionMap *hlslSupportLibExtensionsESOverrides = 0;
+// Support code collected while building the library for one target version.
+// Flattened into an HlslSupportLibrary right after it is filled in.
+struct SupportLibSource
+{
+	CodeMap code;
+	CodeMap codeES;
+	CodeExtensionMap extensions;
+	CodeExtensionMap extensionsES;
+};
+
+// Immutable, TOperator indexed support library for one target version. Built once
+// in initializeHLSLSupportLibrary and only read afterwards, so it can be shared
+// by all compilers (and threads).
+struct HlslSupportLibrary
+{
+	struct Entry
+	{
+		const std::string* code;
+		const std::string* codeES;
+		const CodeExtension* extension;
+		const CodeExtension* extensionES;
+	};
+
+	SupportLibSource source; // owns the strings the entries point to
+	Entry entries[EOpCount];
+};
 
-void insertPre130TextureLookups()
+static HlslSupportLibrary* s_SupportLibraries[ETargetVersionCount+1];
+
+static void insertPre130TextureLookups(SupportLibSource& lib)
 {
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex1DBias,
+    lib.code.insert( CodeMap::value_type( EOpTex1DBias,
         "vec4 xll_tex1Dbias(sampler1D s, vec4 coord) {\n"
         "  return texture1D( s, coord.x, coord.w);\n"
         "}\n\n" )
         );
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex1DLod,
+    lib.code.insert( CodeMap::value_type( EOpTex1DLod,
         "vec4 xll_tex1Dlod(sampler1D s, vec4 coord) {\n"
         "  return texture1DLod( s, coord.x, coord.w);\n"
         "}\n\n" )
         );
-    hlslSupportLibExtensions->insert (std::make_pair(EOpTex1DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
+    lib.extensions.insert (std::make_pair(EOpTex1DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex1DGrad,
+    lib.code.insert( CodeMap::value_type( EOpTex1DGrad,
         "vec4 xll_tex1Dgrad(sampler1D s, float coord, float ddx, float ddy) {\n"
         "  return texture1DGradARB( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    hlslSupportLibExtensions->insert (std::make_pair(EOpTex1DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
+    lib.extensions.insert (std::make_pair(EOpTex1DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex2DBias,
+    lib.code.insert( CodeMap::value_type( EOpTex2DBias,
         "vec4 xll_tex2Dbias(sampler2D s, vec4 coord) {\n"
         "  return texture2D( s, coord.xy, coord.w);\n"
         "}\n\n" )
         );
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex2DLod,
+    lib.code.insert( CodeMap::value_type( EOpTex2DLod,
         "vec4 xll_tex2Dlod(sampler2D s, vec4 coord) {\n"
         "   return texture2DLod( s, coord.xy, coord.w);\n"
         "}\n\n" )
         );
-    hlslSupportLibExtensions->insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
+    lib.extensions.insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLibESOverrides->insert( CodeMap::value_type( EOpTex2DLod,
+    lib.codeES.insert( CodeMap::value_type( EOpTex2DLod,
         "vec4 xll_tex2Dlod(sampler2D s, vec4 coord) {\n"
         "   return texture2DLodEXT( s, coord.xy, coord.w);\n"
         "}\n\n" )
         );
-    hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_EXT_shader_texture_lod")));
+    lib.extensionsES.insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_EXT_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex2DGrad,
+    lib.code.insert( CodeMap::value_type( EOpTex2DGrad,
         "vec4 xll_tex2Dgrad(sampler2D s, vec2 coord, vec2 ddx, vec2 ddy) {\n"
         "   return texture2DGradARB( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    hlslSupportLibExtensions->insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
+    lib.extensions.insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLibESOverrides->insert( CodeMap::value_type( EOpTex2DGrad,
+    lib.codeES.insert( CodeMap::value_type( EOpTex2DGrad,
         "vec4 xll_tex2Dgrad(sampler2D s, vec2 coord, vec2 ddx, vec2 ddy) {\n"
         "   return texture2DGradEXT( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_EXT_shader_texture_lod","GL_EXT_shader_texture_lod")));
+    lib.extensionsES.insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_EXT_shader_texture_lod","GL_EXT_shader_texture_lod")));
 
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex3DBias,
+    lib.code.insert( CodeMap::value_type( EOpTex3DBias,
         "vec4 xll_tex3Dbias(sampler3D s, vec4 coord) {\n"
         "  return texture3D( s, coord.xyz, coord.w);\n"
         "}\n\n" )
         );
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex3DLod,
+    lib.code.insert( CodeMap::value_type( EOpTex3DLod,
         "vec4 xll_tex3Dlod(sampler3D s, vec4 coord) {\n"
         "  return texture3DLod( s, coord.xyz, coord.w);\n"
         "}\n\n" )
         );
-    hlslSupportLibExtensions->insert (std::make_pair(EOpTex3DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
+    lib.extensions.insert (std::make_pair(EOpTex3DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex3DGrad,
+    lib.code.insert( CodeMap::value_type( EOpTex3DGrad,
         "vec4 xll_tex3Dgrad(sampler3D s, vec3 coord, vec3 ddx, vec3 ddy) {\n"
         "  return texture3DGradARB( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    hlslSupportLibExtensions->insert (std::make_pair(EOpTex3DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
+    lib.extensions.insert (std::make_pair(EOpTex3DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTexCubeBias,
+    lib.code.insert( CodeMap::value_type( EOpTexCubeBias,
         "vec4 xll_texCUBEbias(samplerCube s, vec4 coord) {\n"
         "  return textureCube( s, coord.xyz, coord.w);\n"
         "}\n\n" )
         );
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTexCubeLod,
+    lib.code.insert( CodeMap::value_type( EOpTexCubeLod,
         "vec4 xll_texCUBElod(samplerCube s, vec4 coord) {\n"
         "  return textureCubeLod( s, coord.xyz, coord.w);\n"
         "}\n\n" )
         );
-    hlslSupportLibExtensions->insert (std::make_pair(EOpTexCubeLod, std::make_pair("","GL_ARB_shader_texture_lod")));
+    lib.extensions.insert (std::make_pair(EOpTexCubeLod, std::make_pair("","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLibESOverrides->insert( CodeMap::value_type( EOpTexCubeLod,
+    lib.codeES.insert( CodeMap::value_type( EOpTexCubeLod,
 		"vec4 xll_texCUBElod(samplerCube s, vec4 coord) {\n"
 		"  return textureCubeLodEXT( s, coord.xyz, coord.w);\n"
 		"}\n\n" )
 		);
-	hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpTexCubeLod, std::make_pair("","GL_EXT_shader_texture_lod")));
+	lib.extensionsES.insert (std::make_pair(EOpTexCubeLod, std::make_pair("","GL_EXT_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTexCubeGrad,
+    lib.code.insert( CodeMap::value_type( EOpTexCubeGrad,
         "vec4 xll_texCUBEgrad(samplerCube s, vec3 coord, vec3 ddx, vec3 ddy) {\n"
         "  return textureCubeGradARB( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    hlslSupportLibExtensions->insert (std::make_pair(EOpTexCubeGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
+    lib.extensions.insert (std::make_pair(EOpTexCubeGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLibESOverrides->insert( CodeMap::value_type( EOpTexCubeGrad,
+    lib.codeES.insert( CodeMap::value_type( EOpTexCubeGrad,
 		"vec4 xll_texCUBEgrad(samplerCube s, vec3 coord, vec3 ddx, vec3 ddy) {\n"
 		"  return textureCubeGradEXT( s, coord, ddx, ddy);\n"
 		"}\n\n" )
 		);
-	hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpTexCubeGrad, std::make_pair("GL_EXT_shader_texture_lod","GL_EXT_shader_texture_lod")));
+	lib.extensionsES.insert (std::make_pair(EOpTexCubeGrad, std::make_pair("GL_EXT_shader_texture_lod","GL_EXT_shader_texture_lod")));
 
     // shadow2D / shadow2Dproj
-    hlslSupportLib->insert(CodeMap::value_type(EOpShadow2D,
+    lib.code.insert(CodeMap::value_type(EOpShadow2D,
         "float xll_shadow2D(sampler2DShadow s, vec3 coord) { return shadow2D (s, coord).r; }\n"
         ));
-    hlslSupportLibESOverrides->insert(CodeMap::value_type(EOpShadow2D,
+    lib.codeES.insert(CodeMap::value_type(EOpShadow2D,
         "float xll_shadow2D(sampler2DShadow s, vec3 coord) { return shadow2DEXT (s, coord); }\n"
         ));
-    hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpShadow2D, std::make_pair("","GL_EXT_shadow_samplers")));
+    lib.extensionsES.insert (std::make_pair(EOpShadow2D, std::make_pair("","GL_EXT_shadow_samplers")));
 
-    hlslSupportLib->insert(CodeMap::value_type(EOpShadow2DProj,
+    lib.code.insert(CodeMap::value_type(EOpShadow2DProj,
         "float xll_shadow2Dproj(sampler2DShadow s, vec4 coord) { return shadow2DProj (s, coord).r; }\n"
         ));
-    hlslSupportLibESOverrides->insert(CodeMap::value_type(EOpShadow2DProj,
+    lib.codeES.insert(CodeMap::value_type(EOpShadow2DProj,
         "float xll_shadow2Dproj(sampler2DShadow s, vec4 coord) { return shadow2DProjEXT (s, coord); }\n"
         ));
-    hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpShadow2DProj, std::make_pair("","GL_EXT_shadow_samplers")));
+    lib.extensionsES.insert (std::make_pair(EOpShadow2DProj, std::make_pair("","GL_EXT_shadow_samplers")));
 
 	// texture arrays
-	hlslSupportLib->insert(CodeMap::value_type(EOpTex2DArray, "vec4 xll_tex2DArray(sampler2DArray s, vec3 coord) { return texture2DArray (s, coord); }\n"));
-	hlslSupportLibExtensions->insert (std::make_pair(EOpTex2DArray, std::make_pair("GL_EXT_texture_array","GL_EXT_texture_array")));
-	hlslSupportLibESOverrides->insert(CodeMap::value_type(EOpTex2DArray, "vec4 xll_tex2DArray(sampler2DArrayNV s, vec3 coord) { return texture2DArrayNV (s, coord); }\n"));
-	hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpTex2DArray, std::make_pair("GL_NV_texture_array","GL_NV_texture_array")));
-
-	hlslSupportLib->insert(CodeMap::value_type(EOpTex2DArrayLod, "vec4 xll_tex2DArrayLod(sampler2DArray s, vec4 coord) { return texture2DArrayLod (s, coord.xyz, coord.w); }\n"));
-	hlslSupportLibExtensions->insert (std::make_pair(EOpTex2DArrayLod, std::make_pair("GL_EXT_texture_array","GL_EXT_texture_array")));
-	hlslSupportLibESOverrides->insert(CodeMap::value_type(EOpTex2DArrayLod, "vec4 xll_tex2DArrayLod(sampler2DArrayNV s, vec4 coord) { return texture2DArrayLodNV (s, coord.xyz, coord.w); }\n"));
-	hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpTex2DArrayLod, std::make_pair("GL_NV_texture_array","GL_NV_texture_array")));
-
-	hlslSupportLib->insert(CodeMap::value_type(EOpTex2DArrayBias, "vec4 xll_tex2DArrayBias(sampler2DArray s, vec4 coord) { return texture2DArray (s, coord.xyz, coord.w); }\n"));
-	hlslSupportLibExtensions->insert (std::make_pair(EOpTex2DArrayBias, std::make_pair("GL_EXT_texture_array","GL_EXT_texture_array")));
-	hlslSupportLibESOverrides->insert(CodeMap::value_type(EOpTex2DArrayBias, "vec4 xll_tex2DArrayBias(sampler2DArrayNV s, vec4 coord) { return texture2DArrayNV (s, coord.xyz, coord.w); }\n"));
-	hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpTex2DArrayBias, std::make_pair("GL_NV_texture_array","GL_NV_texture_array")));
+	lib.code.insert(CodeMap::value_type(EOpTex2DArray, "vec4 xll_tex2DArray(sampler2DArray s, vec3 coord) { return texture2DArray (s, coord); }\n"));
+	lib.extensions.insert (std::make_pair(EOpTex2DArray, std::make_pair("GL_EXT_texture_array","GL_EXT_texture_array")));
+	lib.codeES.insert(CodeMap::value_type(EOpTex2DArray, "vec4 xll_tex2DArray(sampler2DArrayNV s, vec3 coord) { return texture2DArrayNV (s, coord); }\n"));
+	lib.extensionsES.insert (std::make_pair(EOpTex2DArray, std::make_pair("GL_NV_texture_array","GL_NV_texture_array")));
+
+	lib.code.insert(CodeMap::value_type(EOpTex2DArrayLod, "vec4 xll_tex2DArrayLod(sampler2DArray s, vec4 coord) { return texture2DArrayLod (s, coord.xyz, coord.w); }\n"));
+	lib.extensions.insert (std::make_pair(EOpTex2DArrayLod, std::make_pair("GL_EXT_texture_array","GL_EXT_texture_array")));
+	lib.codeES.insert(CodeMap::value_type(EOpTex2DArrayLod, "vec4 xll_tex2DArrayLod(sampler2DArrayNV s, vec4 coord) { return texture2DArrayLodNV (s, coord.xyz, coord.w); }\n"));
+	lib.extensionsES.insert (std::make_pair(EOpTex2DArrayLod, std::make_pair("GL_NV_texture_array","GL_NV_texture_array")));
+
+	lib.code.insert(CodeMap::value_type(EOpTex2DArrayBias, "vec4 xll_tex2DArrayBias(sampler2DArray s, vec4 coord) { return texture2DArray (s, coord.xyz, coord.w); }\n"));
+	lib.extensions.insert (std::make_pair(EOpTex2DArrayBias, std::make_pair("GL_EXT_texture_array","GL_EXT_texture_array")));
+	lib.codeES.insert(CodeMap::value_type(EOpTex2DArrayBias, "vec4 xll_tex2DArrayBias(sampler2DArrayNV s, vec4 coord) { return texture2DArrayNV (s, coord.xyz, coord.w); }\n"));
+	lib.extensionsES.insert (std::make_pair(EOpTex2DArrayBias, std::make_pair("GL_NV_texture_array","GL_NV_texture_array")));
 }
 
-void insertPost120TextureLookups()
+static void insertPost120TextureLookups(SupportLibSource& lib)
 {
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex1DBias,
+    lib.code.insert( CodeMap::value_type( EOpTex1DBias,
         "vec4 xll_tex1Dbias(sampler1D s, vec4 coord) {\n"
         "  return texture( s, coord.x, coord.w);\n"
         "}\n\n" )
         );
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex1DLod,
+    lib.code.insert( CodeMap::value_type( EOpTex1DLod,
         "vec4 xll_tex1Dlod(sampler1D s, vec4 coord) {\n"
         "  return textureLod( s, coord.x, coord.w);\n"
         "}\n\n" )
         );
-    hlslSupportLibExtensions->insert (std::make_pair(EOpTex1DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
+    lib.extensions.insert (std::make_pair(EOpTex1DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
 
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex2DBias,
+    lib.code.insert( CodeMap::value_type( EOpTex2DBias,
         "vec4 xll_tex2Dbias(sampler2D s, vec4 coord) {\n"
         "  return texture( s, coord.xy, coord.w);\n"
         "}\n\n" )
         );
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex2DLod,
+    lib.code.insert( CodeMap::value_type( EOpTex2DLod,
         "vec4 xll_tex2Dlod(sampler2D s, vec4 coord) {\n"
         "   return textureLod( s, coord.xy, coord.w);\n"
         "}\n\n" )
         );
-    //hlslSupportLibExtensions->insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
+    //lib.extensions.insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLibESOverrides->insert( CodeMap::value_type( EOpTex2DLod,
+    lib.codeES.insert( CodeMap::value_type( EOpTex2DLod,
         "vec4 xll_tex2Dlod(sampler2D s, vec4 coord) {\n"
         "   return textureLod( s, coord.xy, coord.w);\n"
         "}\n\n" )
         );
-    //hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_EXT_shader_texture_lod")));
-    hlslSupportLibExtensions->insert (std::make_pair(EOpTex1DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
+    //lib.extensionsES.insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_EXT_shader_texture_lod")));
+    lib.extensions.insert (std::make_pair(EOpTex1DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex1DGrad,
+    lib.code.insert( CodeMap::value_type( EOpTex1DGrad,
         "vec4 xll_tex1Dgrad(sampler1D s, float coord, float ddx, float ddy) {\n"
         "   return textureGrad( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    //hlslSupportLibExtensions->insert (std::make_pair(EOpTex1DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
+    //lib.extensions.insert (std::make_pair(EOpTex1DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex2DBias,
+    lib.code.insert( CodeMap::value_type( EOpTex2DBias,
         "vec4 xll_tex2Dbias(sampler2D s, vec4 coord) {\n"
         "  return texture( s, coord.xy, coord.w);\n"
         "}\n\n" )
         );
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex2DGrad,
+    lib.code.insert( CodeMap::value_type( EOpTex2DGrad,
         "vec4 xll_tex2Dgrad(sampler2D s, vec2 coord, vec2 ddx, vec2 ddy) {\n"
         "   return textureGrad( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex2DLod,
+    lib.code.insert( CodeMap::value_type( EOpTex2DLod,
         "vec4 xll_tex2Dlod(sampler2D s, vec4 coord) {\n"
         "   return textureLod( s, coord.xy, coord.w);\n"
         "}\n\n" )
         );
-    //hlslSupportLibExtensions->insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
-    //hlslSupportLibExtensions->insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
+    //lib.extensions.insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
+    //lib.extensions.insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
 
-    //hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_EXT_shader_texture_lod","GL_EXT_shader_texture_lod")));
-    //hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_EXT_shader_texture_lod")));
+    //lib.extensionsES.insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_EXT_shader_texture_lod","GL_EXT_shader_texture_lod")));
+    //lib.extensionsES.insert (std::make_pair(EOpTex2DLod, std::make_pair("","GL_EXT_shader_texture_lod")));
 
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex3DBias,
+    lib.code.insert( CodeMap::value_type( EOpTex3DBias,
         "vec4 xll_tex3Dbias(sampler3D s, vec4 coord) {\n"
         "  return texture( s, coord.xyz, coord.w);\n"
         "}\n\n" )
         );
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex2DGrad,
+    lib.code.insert( CodeMap::value_type( EOpTex2DGrad,
         "vec4 xll_tex2Dgrad(sampler2D s, vec2 coord, vec2 ddx, vec2 ddy) {\n"
         "   return textureGrad( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    //hlslSupportLibExtensions->insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
+    //lib.extensions.insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex3DLod,
+    lib.code.insert( CodeMap::value_type( EOpTex3DLod,
         "vec4 xll_tex3Dlod(sampler3D s, vec4 coord) {\n"
         "  return textureLod( s, coord.xyz, coord.w);\n"
         "}\n\n" )
         );
-    hlslSupportLibESOverrides->insert( CodeMap::value_type( EOpTex2DGrad,
+    lib.codeES.insert( CodeMap::value_type( EOpTex2DGrad,
         "vec4 xll_tex2Dgrad(sampler2D s, vec2 coord, vec2 ddx, vec2 ddy) {\n"
         "   return textureGrad( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    //hlslSupportLibExtensions->insert (std::make_pair(EOpTex3DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
-    //hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_EXT_shader_texture_lod","GL_EXT_shader_texture_lod")));
+    //lib.extensions.insert (std::make_pair(EOpTex3DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
+    //lib.extensionsES.insert (std::make_pair(EOpTex2DGrad, std::make_pair("GL_EXT_shader_texture_lod","GL_EXT_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex3DGrad,
+    lib.code.insert( CodeMap::value_type( EOpTex3DGrad,
         "vec4 xll_tex3Dgrad(sampler3D s, vec3 coord, vec3 ddx, vec3 ddy) {\n"
         "  return textureGrad( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    //hlslSupportLibExtensions->insert (std::make_pair(EOpTex3DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
+    //lib.extensions.insert (std::make_pair(EOpTex3DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex3DBias,
+    lib.code.insert( CodeMap::value_type( EOpTex3DBias,
         "vec4 xll_tex3Dbias(sampler3D s, vec4 coord) {\n"
         "  return texture( s, coord.xyz, coord.w);\n"
         "}\n\n" )
         );
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTexCubeBias,
+    lib.code.insert( CodeMap::value_type( EOpTexCubeBias,
         "vec4 xll_texCUBEbias(samplerCube s, vec4 coord) {\n"
         "  return texture( s, coord.xyz, coord.w);\n"
         "}\n\n" )
         );
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex3DLod,
+    lib.code.insert( CodeMap::value_type( EOpTex3DLod,
         "vec4 xll_tex3Dlod(sampler3D s, vec4 coord) {\n"
         "  return textureLod( s, coord.xyz, coord.w);\n"
         "}\n\n" )
         );
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTexCubeLod,
+    lib.code.insert( CodeMap::value_type( EOpTexCubeLod,
         "vec4 xll_texCUBElod(samplerCube s, vec4 coord) {\n"
         "  return textureLod( s, coord.xyz, coord.w);\n"
         "}\n\n" )
         );
-    //hlslSupportLibExtensions->insert (std::make_pair(EOpTexCubeLod, std::make_pair("","GL_ARB_shader_texture_lod")));
+    //lib.extensions.insert (std::make_pair(EOpTexCubeLod, std::make_pair("","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTexCubeGrad,
+    lib.code.insert( CodeMap::value_type( EOpTexCubeGrad,
         "vec4 xll_texCUBEgrad(samplerCube s, vec3 coord, vec3 ddx, vec3 ddy) {\n"
         "  return textureGrad( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    //hlslSupportLibExtensions->insert (std::make_pair(EOpTexCubeGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
-    //hlslSupportLibExtensions->insert (std::make_pair(EOpTex3DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
+    //lib.extensions.insert (std::make_pair(EOpTexCubeGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
+    //lib.extensions.insert (std::make_pair(EOpTex3DLod, std::make_pair("","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTex3DGrad,
+    lib.code.insert( CodeMap::value_type( EOpTex3DGrad,
         "vec4 xll_tex3Dgrad(sampler3D s, vec3 coord, vec3 ddx, vec3 ddy) {\n"
         "  return textureGrad( s, coord, ddx, ddy);\n"
         "}\n\n" )
         );
-    //hlslSupportLibExtensions->insert (std::make_pair(EOpTex3DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
+    //lib.extensions.insert (std::make_pair(EOpTex3DGrad, std::make_pair("GL_ARB_shader_texture_lod","GL_ARB_shader_texture_lod")));
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpTexCubeBias,
+    lib.code.insert( CodeMap::value_type( EOpTexCubeBias,
         "vec4 xll_texCUBEbias(samplerCube s, vec4 coord) {\n"
         "  return texture( s, coord.xyz, coord.w);\n"
         "}\n\n" )
         );
 
     // shadow2D / shadow2Dproj
-    hlslSupportLib->insert(CodeMap::value_type(EOpShadow2D,
+    lib.code.insert(CodeMap::value_type(EOpShadow2D,
         "float xll_shadow2D(sampler2DShadow s, vec3 coord) { return texture (s, coord); }\n"
         ));
-    hlslSupportLibESOverrides->insert(CodeMap::value_type(EOpShadow2D,
+    lib.codeES.insert(CodeMap::value_type(EOpShadow2D,
         "float xll_shadow2D(mediump sampler2DShadow s, vec3 coord) { return texture (s, coord); }\n"
         ));
-    //hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpShadow2D, std::make_pair("","GL_EXT_shadow_samplers")));
+    //lib.extensionsES.insert (std::make_pair(EOpShadow2D, std::make_pair("","GL_EXT_shadow_samplers")));
 
-    hlslSupportLib->insert(CodeMap::value_type(EOpShadow2DProj,
+    lib.code.insert(CodeMap::value_type(EOpShadow2DProj,
         "float xll_shadow2Dproj(sampler2DShadow s, vec4 coord) { return textureProj (s, coord); }\n"
         ));
-    hlslSupportLibESOverrides->insert(CodeMap::value_type(EOpShadow2DProj,
+    lib.codeES.insert(CodeMap::value_type(EOpShadow2DProj,
         "float xll_shadow2Dproj(mediump sampler2DShadow s, vec4 coord) { return textureProj (s, coord); }\n"
         ));
-    //hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpShadow2DProj, std::make_pair("","GL_EXT_shadow_samplers")));
+    //lib.extensionsES.insert (std::make_pair(EOpShadow2DProj, std::make_pair("","GL_EXT_shadow_samplers")));
 
 	// texture arrays
-	hlslSupportLib->insert(CodeMap::value_type(EOpTex2DArray, "vec4 xll_tex2DArray(sampler2DArray s, vec3 coord) { return texture (s, coord); }\n"));
-	hlslSupportLib->insert(CodeMap::value_type(EOpTex2DArrayLod, "vec4 xll_tex2DArrayLod(sampler2DArray s, vec4 coord) { return textureLod (s, coord.xyz, coord.w); }\n"));
-	hlslSupportLib->insert(CodeMap::value_type(EOpTex2DArrayBias, "vec4 xll_tex2DArrayBias(sampler2DArray s, vec4 coord) { return texture (s, coord.xyz, coord.w); }\n"));
+	lib.code.insert(CodeMap::value_type(EOpTex2DArray, "vec4 xll_tex2DArray(sampler2DArray s, vec3 coord) { return texture (s, coord); }\n"));
+	lib.code.insert(CodeMap::value_type(EOpTex2DArrayLod, "vec4 xll_tex2DArrayLod(sampler2DArray s, vec4 coord) { return textureLod (s, coord.xyz, coord.w); }\n"));
+	lib.code.insert(CodeMap::value_type(EOpTex2DArrayBias, "vec4 xll_tex2DArrayBias(sampler2DArray s, vec4 coord) { return texture (s, coord.xyz, coord.w); }\n"));
 }
 
 
-void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
+static void buildSupportLibSource(SupportLibSource& lib, ETargetVersion targetVersion)
 {
-	assert (hlslSupportLib == 0);
-	assert (hlslSupportLibExtensions == 0);
-	assert (hlslSupportLibESOverrides == 0);
-	assert (hlslSupportLibExtensionsESOverrides == 0);
-
-	hlslSupportLib = new CodeMap();
-	hlslSupportLibExtensions = new CodeExtensionMap();
-	hlslSupportLibESOverrides = new CodeMap();
-	hlslSupportLibExtensionsESOverrides = new CodeExtensionMap();
-
     //ACS: some texture lookup types were deprecated after 1.20, and 1.40 won't accept them
     bool usePost120TextureLookups = false;
     if(targetVersion!=ETargetVersionCount) //default
@@ -351,9 +366,9 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
 
    // Initialize GLSL code for the op codes that require support helper functions
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpNull, ""));
+   lib.code.insert( CodeMap::value_type( EOpNull, ""));
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpAbs,
+   lib.code.insert( CodeMap::value_type( EOpAbs,
       "mat2 xll_abs_mf2x2(mat2 m) {\n"
       "  return mat2( abs(m[0]), abs(m[1]));\n"
       "}\n\n"
@@ -365,7 +380,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpAcos,
+   lib.code.insert( CodeMap::value_type( EOpAcos,
       "mat2 xll_acos_mf2x2(mat2 m) {\n"
       "  return mat2( acos(m[0]), acos(m[1]));\n"
       "}\n\n"
@@ -377,7 +392,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpCos,
+   lib.code.insert( CodeMap::value_type( EOpCos,
       "mat2 xll_cos_mf2x2(mat2 m) {\n"
       "  return mat2( cos(m[0]), cos(m[1]));\n"
       "}\n\n"
@@ -389,7 +404,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpAsin,
+   lib.code.insert( CodeMap::value_type( EOpAsin,
       "mat2 xll_asin_mf2x2(mat2 m) {\n"
       "  return mat2( asin(m[0]), asin(m[1]));\n"
       "}\n\n"
@@ -401,7 +416,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpSin,
+   lib.code.insert( CodeMap::value_type( EOpSin,
       "mat2 xll_sin_mf2x2(mat2 m) {\n"
       "  return mat2( sin(m[0]), sin(m[1]));\n"
       "}\n\n"
@@ -413,7 +428,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpDPdx,
+   lib.code.insert( CodeMap::value_type( EOpDPdx,
 	  "float xll_dFdx_f(float f) {\n"
 	  "  return dFdx(f);\n"
 	  "}\n\n"
@@ -438,9 +453,9 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       );
 
 	if (targetVersion < ETargetGLSL_ES_300)
-	hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpDPdx, std::make_pair("","GL_OES_standard_derivatives")));
+	lib.extensionsES.insert (std::make_pair(EOpDPdx, std::make_pair("","GL_OES_standard_derivatives")));
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpDPdy,
+   lib.code.insert( CodeMap::value_type( EOpDPdy,
 	  "float xll_dFdy_f(float f) {\n"
 	  "  return dFdy(f);\n"
 	  "}\n\n"
@@ -465,9 +480,9 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       );
 
 	if (targetVersion < ETargetGLSL_ES_300)
-	hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpDPdy, std::make_pair("","GL_OES_standard_derivatives")));
+	lib.extensionsES.insert (std::make_pair(EOpDPdy, std::make_pair("","GL_OES_standard_derivatives")));
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpExp,
+   lib.code.insert( CodeMap::value_type( EOpExp,
       "mat2 xll_exp_mf2x2(mat2 m) {\n"
       "  return mat2( exp(m[0]), exp(m[1]));\n"
       "}\n\n"
@@ -479,7 +494,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpExp2,
+   lib.code.insert( CodeMap::value_type( EOpExp2,
       "mat2 xll_exp2_mf2x2(mat2 m) {\n"
       "  return mat2( exp2(m[0]), exp2(m[1]));\n"
       "}\n\n"
@@ -491,7 +506,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpLog,
+   lib.code.insert( CodeMap::value_type( EOpLog,
       "mat2 xll_log_mf2x2(mat2 m) {\n"
       "  return mat2( log(m[0]), log(m[1]));\n"
       "}\n\n"
@@ -503,7 +518,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpLog2,
+   lib.code.insert( CodeMap::value_type( EOpLog2,
       "mat2 xll_log2_mf2x2(mat2 m) {\n"
       "  return mat2( log2(m[0]), log2(m[1]));\n"
       "}\n\n"
@@ -515,7 +530,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpTan,
+   lib.code.insert( CodeMap::value_type( EOpTan,
       "mat2 xll_tan_mf2x2(mat2 m) {\n"
       "  return mat2( tan(m[0]), tan(m[1]));\n"
       "}\n\n"
@@ -527,7 +542,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpAtan,
+   lib.code.insert( CodeMap::value_type( EOpAtan,
       "mat2 xll_atan_mf2x2(mat2 m) {\n"
       "  return mat2( atan(m[0]), atan(m[1]));\n"
       "}\n\n"
@@ -539,7 +554,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpDegrees,
+   lib.code.insert( CodeMap::value_type( EOpDegrees,
       "mat2 xll_degrees_mf2x2(mat2 m) {\n"
       "  return mat2( degrees(m[0]), degrees(m[1]));\n"
       "}\n\n"
@@ -551,7 +566,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpRadians,
+    lib.code.insert( CodeMap::value_type( EOpRadians,
       "mat2 xll_radians_mf2x2(mat2 m) {\n"
       "  return mat2( radians(m[0]), radians(m[1]));\n"
       "}\n\n"
@@ -563,7 +578,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-    hlslSupportLib->insert( CodeMap::value_type( EOpSqrt,
+    lib.code.insert( CodeMap::value_type( EOpSqrt,
       "mat2 xll_sqrt_mf2x2(mat2 m) {\n"
       "  return mat2( sqrt(m[0]), sqrt(m[1]));\n"
       "}\n\n"
@@ -575,7 +590,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpInverseSqrt,
+   lib.code.insert( CodeMap::value_type( EOpInverseSqrt,
       "mat2 xll_inversesqrt_mf2x2(mat2 m) {\n"
       "  return mat2( inversesqrt(m[0]), inversesqrt(m[1]));\n"
       "}\n\n"
@@ -587,7 +602,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpFloor,
+   lib.code.insert( CodeMap::value_type( EOpFloor,
       "mat2 xll_floor_mf2x2(mat2 m) {\n"
       "  return mat2( floor(m[0]), floor(m[1]));\n"
       "}\n\n"
@@ -599,7 +614,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpSign,
+   lib.code.insert( CodeMap::value_type( EOpSign,
       "mat2 xll_sign_mf2x2(mat2 m) {\n"
       "  return mat2( sign(m[0]), sign(m[1]));\n"
       "}\n\n"
@@ -611,7 +626,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpCeil,
+   lib.code.insert( CodeMap::value_type( EOpCeil,
       "mat2 xll_ceil_mf2x2(mat2 m) {\n"
       "  return mat2( ceil(m[0]), ceil(m[1]));\n"
       "}\n\n"
@@ -623,7 +638,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpFract,
+   lib.code.insert( CodeMap::value_type( EOpFract,
       "mat2 xll_fract_mf2x2(mat2 m) {\n"
       "  return mat2( fract(m[0]), fract(m[1]));\n"
       "}\n\n"
@@ -635,7 +650,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpFwidth,
+   lib.code.insert( CodeMap::value_type( EOpFwidth,
 	  "float xll_fwidth_f(float f) {\n"
 	  "  return fwidth(f);\n"
 	  "}\n\n"
@@ -659,9 +674,9 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 	if (targetVersion < ETargetGLSL_ES_300)
-    hlslSupportLibExtensionsESOverrides->insert (std::make_pair(EOpFwidth, std::make_pair("","GL_OES_standard_derivatives")));
+    lib.extensionsES.insert (std::make_pair(EOpFwidth, std::make_pair("","GL_OES_standard_derivatives")));
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpFclip,
+   lib.code.insert( CodeMap::value_type( EOpFclip,
 	   "void xll_clip_f(float x) {\n"
 	   "  if ( x<0.0 ) discard;\n"
 	   "}\n"
@@ -676,7 +691,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
 	   "}\n"
 	));
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpPow,
+   lib.code.insert( CodeMap::value_type( EOpPow,
       "mat2 xll_pow_mf2x2_mf2x2(mat2 m, mat2 y) {\n"
       "  return mat2( pow(m[0],y[0]), pow(m[1],y[1]));\n"
       "}\n\n"
@@ -688,7 +703,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpAtan2,
+   lib.code.insert( CodeMap::value_type( EOpAtan2,
       "mat2 xll_atan2_mf2x2_mf2x2(mat2 m, mat2 y) {\n"
       "  return mat2( atan(m[0],y[0]), atan(m[1],y[1]));\n"
       "}\n\n"
@@ -700,7 +715,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpMin,
+   lib.code.insert( CodeMap::value_type( EOpMin,
       "mat2 xll_min_mf2x2_mf2x2(mat2 m, mat2 y) {\n"
       "  return mat2( min(m[0],y[0]), min(m[1],y[1]));\n"
       "}\n\n"
@@ -712,7 +727,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpMax,
+   lib.code.insert( CodeMap::value_type( EOpMax,
       "mat2 xll_max_mf2x2_mf2x2(mat2 m, mat2 y) {\n"
       "  return mat2( max(m[0],y[0]), max(m[1],y[1]));\n"
       "}\n\n"
@@ -724,7 +739,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
       "}\n\n")
       );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpTranspose,
+   lib.code.insert( CodeMap::value_type( EOpTranspose,
         "mat2 xll_transpose_mf2x2(mat2 m) {\n"
         "  return mat2( m[0][0], m[1][0], m[0][1], m[1][1]);\n"
         "}\n\n"
@@ -743,7 +758,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
 
 	// Note: constructing temporary vector and assigning individual components; seems to avoid
 	// some GLSL bugs on AMD (Win7, Radeon HD 58xx, Catalyst 10.5).
-	hlslSupportLib->insert( CodeMap::value_type( EOpMatrixIndex,
+	lib.code.insert( CodeMap::value_type( EOpMatrixIndex,
 		"vec2 xll_matrixindex_mf2x2_i (mat2 m, int i) { vec2 v; v.x=m[0][i]; v.y=m[1][i]; return v; }\n"
 		"vec3 xll_matrixindex_mf3x3_i (mat3 m, int i) { vec3 v; v.x=m[0][i]; v.y=m[1][i]; v.z=m[2][i]; return v; }\n"
 		"vec4 xll_matrixindex_mf4x4_i (mat4 m, int i) { vec4 v; v.x=m[0][i]; v.y=m[1][i]; v.z=m[2][i]; v.w=m[3][i]; return v; }\n")
@@ -753,7 +768,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
 	// (except when the operand is a uniform in vertex shaders). The GLSL specification
 	// leaves it open to vendors to support this or not. So, for NaCl we use if statements to
 	// simulate the indexing.
-	hlslSupportLib->insert( CodeMap::value_type( EOpMatrixIndexDynamic,
+	lib.code.insert( CodeMap::value_type( EOpMatrixIndexDynamic,
 		"#if defined(SHADER_API_GLES) && defined(SHADER_API_DESKTOP)\n"
 		"vec2 xll_matrixindexdynamic_mf2x2_i (mat2 m, int i) {\n"
 		"	mat2 m2 = xll_transpose_mf2x2(m);\n"
@@ -776,7 +791,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
 
 
 	// Used in pre-GLSL 1.20
-	hlslSupportLib->insert( CodeMap::value_type( EOpConstructMat2x2FromMat,
+	lib.code.insert( CodeMap::value_type( EOpConstructMat2x2FromMat,
 		"mat2 xll_constructMat2_mf3x3( mat3 m) {\n"
         "  return mat2( vec2( m[0]), vec2( m[1]));\n"
         "}\n\n"
@@ -784,13 +799,13 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
         "  return mat2( vec2( m[0]), vec2( m[1]));\n"
         "}\n")
         );
-	hlslSupportLib->insert( CodeMap::value_type( EOpConstructMat3x3FromMat,
+	lib.code.insert( CodeMap::value_type( EOpConstructMat3x3FromMat,
 		"mat3 xll_constructMat3_mf4x4( mat4 m) {\n"
         "  return mat3( vec3( m[0]), vec3( m[1]), vec3( m[2]));\n"
         "}\n")
         );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpDeterminant,
+   lib.code.insert( CodeMap::value_type( EOpDeterminant,
         "float xll_determinant_mf2x2( mat2 m) {\n"
         "    return m[0][0]*m[1][1] - m[0][1]*m[1][0];\n"
         "}\n\n"
@@ -811,7 +826,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
         "}\n")
         );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpSaturate,
+   lib.code.insert( CodeMap::value_type( EOpSaturate,
         "float xll_saturate_f( float x) {\n"
         "  return clamp( x, 0.0, 1.0);\n"
         "}\n\n"
@@ -836,7 +851,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
         );
 
 	// \todo [pyry] There is mod() built-in in GLSL
-   hlslSupportLib->insert( CodeMap::value_type( EOpMod,
+   lib.code.insert( CodeMap::value_type( EOpMod,
 	   "float xll_mod_f_f( float x, float y ) {\n"
 	   "  float d = x / y;\n"
 	   "  float f = fract (abs(d)) * y;\n"
@@ -861,7 +876,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
 	   );
 
 	// \todo [pyry] GLSL ES 3 includes built-in function for this
-   hlslSupportLib->insert( CodeMap::value_type( EOpModf,
+   lib.code.insert( CodeMap::value_type( EOpModf,
         "float xll_modf_f_i( float x, out int ip) {\n"
 		"  ip = int (x);\n"
 		"  return x-float(ip);\n"
@@ -902,7 +917,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
         );
 
 	// \todo [pyry] Built-in function exists in GLSL ES 3
-	hlslSupportLib->insert (CodeMap::value_type(EOpRound,
+	lib.code.insert (CodeMap::value_type(EOpRound,
 		"float xll_round_f (float x) { return floor (x+0.5); }\n"
 		"vec2 xll_round_vf2 (vec2 x) { return floor (x+vec2(0.5)); }\n"
 		"vec3 xll_round_vf3 (vec3 x) { return floor (x+vec3(0.5)); }\n"
@@ -910,7 +925,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
 	));
 
 	// \todo [pyry] Built-in function exists in GLSL ES 3
-	hlslSupportLib->insert (CodeMap::value_type(EOpTrunc,
+	lib.code.insert (CodeMap::value_type(EOpTrunc,
 		"float xll_trunc_f (float x) { return x < 0.0 ? -floor(-x) : floor(x); }\n"
 		"vec2 xll_trunc_vf2 (vec2 v) { return vec2(\n"
 		"  v.x < 0.0 ? -floor(-v.x) : floor(v.x),\n"
@@ -930,7 +945,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
 	));
 
 	// \todo [pyry] Built-in function exists in GLSL ES 3
-   hlslSupportLib->insert( CodeMap::value_type( EOpLdexp,
+   lib.code.insert( CodeMap::value_type( EOpLdexp,
         "float xll_ldexp_f_f( float x, float expon) {\n"
         "  return x * exp2 ( expon );\n"
         "}\n\n"
@@ -955,7 +970,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
         );
 
 	// \todo [pyry] Built-in function exists in GLSL ES 3
-   hlslSupportLib->insert( CodeMap::value_type( EOpSinCos,
+   lib.code.insert( CodeMap::value_type( EOpSinCos,
         "void xll_sincos_f_f_f( float x, out float s, out float c) {\n"
         "  s = sin(x); \n"
         "  c = cos(x); \n"
@@ -986,7 +1001,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
         "}\n\n" )
         );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpLog10,
+   lib.code.insert( CodeMap::value_type( EOpLog10,
         "float xll_log10_f( float x ) {\n"
         "  return log2 ( x ) / 3.32192809; \n"
         "}\n\n"
@@ -1010,7 +1025,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
         "}\n\n")
         );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpMix,
+   lib.code.insert( CodeMap::value_type( EOpMix,
         "mat2 xll_mix_mf2x2_mf2x2_mf2x2( mat2 x, mat2 y, mat2 s ) {\n"
         "  return mat2( mix(x[0],y[0],s[0]), mix(x[1],y[1],s[1]) ); \n"
         "}\n\n"
@@ -1022,13 +1037,13 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
         "}\n\n")
         );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpLit,
+   lib.code.insert( CodeMap::value_type( EOpLit,
         "vec4 xll_lit_f_f_f( float n_dot_l, float n_dot_h, float m ) {\n"
         "   return vec4(1, max(0.0, n_dot_l), pow(max(0.0, n_dot_h) * step(0.0, n_dot_l), m), 1.0);\n"
         "}\n\n")
         );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpSmoothStep,
+   lib.code.insert( CodeMap::value_type( EOpSmoothStep,
         "mat2 xll_smoothstep_mf2x2_mf2x2_mf2x2( mat2 x, mat2 y, mat2 s ) {\n"
         "  return mat2( smoothstep(x[0],y[0],s[0]), smoothstep(x[1],y[1],s[1]) ); \n"
         "}\n\n"
@@ -1040,7 +1055,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
         "}\n\n")
         );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpClamp,
+   lib.code.insert( CodeMap::value_type( EOpClamp,
         "mat2 xll_clamp_mf2x2_mf2x2_mf2x2( mat2 x, mat2 y, mat2 s ) {\n"
         "  return mat2( clamp(x[0],y[0],s[0]), clamp(x[1],y[1],s[1]) ); \n"
         "}\n\n"
@@ -1052,7 +1067,7 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
         "}\n\n")
         );
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpStep,
+   lib.code.insert( CodeMap::value_type( EOpStep,
       "mat2 xll_step_mf2x2_mf2x2(mat2 m, mat2 y) {\n"
       "  return mat2( step(m[0],y[0]), step(m[1],y[1]));\n"
       "}\n\n"
@@ -1066,19 +1081,19 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
 
    //ACS: if we're post-1.20 use the newer, non-deprecated, texture lookups
    if(usePost120TextureLookups) {
-       insertPost120TextureLookups();
+       insertPost120TextureLookups(lib);
    }
    else {
-       insertPre130TextureLookups();
+       insertPre130TextureLookups(lib);
    }
 
-   hlslSupportLib->insert( CodeMap::value_type( EOpD3DCOLORtoUBYTE4,
+   lib.code.insert( CodeMap::value_type( EOpD3DCOLORtoUBYTE4,
         "ivec4 xll_D3DCOLORtoUBYTE4(vec4 x) {\n"
         "  return ivec4 ( x.zyxw * 255.001953 );\n"
         "}\n\n" )
         );
 
-	hlslSupportLib->insert( CodeMap::value_type( EOpVecTernarySel,
+	lib.code.insert( CodeMap::value_type( EOpVecTernarySel,
 		"vec2 xll_vecTSel_vb2_vf2_vf2 (bvec2 a, vec2 b, vec2 c) {\n"
 		"  return vec2 (a.x ? b.x : c.x, a.y ? b.y : c.y);\n"
 		"}\n"
@@ -1093,65 +1108,73 @@ void initializeHLSLSupportLibrary(ETargetVersion targetVersion)
 }
 
 
-void finalizeHLSLSupportLibrary()
+template <typename T>
+static const T* findSupportLibEntry(const std::map<TOperator,T>& map, int op)
 {
-	delete hlslSupportLib;
-	hlslSupportLib = 0;
-	delete hlslSupportLibExtensions;
-	hlslSupportLibExtensions = 0;
-	delete hlslSupportLibESOverrides;
-	hlslSupportLibESOverrides = 0;
-	delete hlslSupportLibExtensionsESOverrides;
-	hlslSupportLibExtensionsESOverrides = 0;
+	typename std::map<TOperator,T>::const_iterator it = map.find(TOperator(op));
+	return it != map.end() ? &it->second : NULL;
 }
 
-std::string getHLSLSupportCode (TOperator op, ExtensionSet& extensions, bool vertexShader, bool gles)
+void initializeHLSLSupportLibrary()
 {
-	assert (hlslSupportLibExtensions);
-	assert (hlslSupportLibExtensionsESOverrides);
-
-	// if we're using gles, attempt to find the ES version first
-	bool found = false;
-	if (gles)
+	for (int version = 0; version <= ETargetVersionCount; ++version)
 	{
-		CodeExtensionMap::iterator eit = hlslSupportLibExtensionsESOverrides->find(op);
-		if (eit != hlslSupportLibExtensionsESOverrides->end())
+		assert (s_SupportLibraries[version] == 0);
+
+		HlslSupportLibrary* lib = new HlslSupportLibrary();
+		buildSupportLibSource(lib->source, ETargetVersion(version));
+
+		const CodeMap::const_iterator nullCode = lib->source.code.find(EOpNull); // this always exists
+		assert (nullCode != lib->source.code.end());
+
+		for (int op = 0; op < EOpCount; ++op)
 		{
-			const std::string& ext = vertexShader ? eit->second.first : eit->second.second;
-			if (!ext.empty())
-				extensions.insert(ext);
-			found = true;
+			HlslSupportLibrary::Entry& e = lib->entries[op];
+			e.code = findSupportLibEntry(lib->source.code, op);
+			if (!e.code)
+				e.code = &nullCode->second;
+			e.codeES = findSupportLibEntry(lib->source.codeES, op);
+			e.extension = findSupportLibEntry(lib->source.extensions, op);
+			e.extensionES = findSupportLibEntry(lib->source.extensionsES, op);
 		}
+
+		s_SupportLibraries[version] = lib;
 	}
+}
 
-	if (!found)
+
+void finalizeHLSLSupportLibrary()
+{
+	for (int version = 0; version <= ETargetVersionCount; ++version)
 	{
-		CodeExtensionMap::iterator eit = hlslSupportLibExtensions->find(op);
-		if (eit != hlslSupportLibExtensions->end())
-		{
-			const std::string& ext = vertexShader ? eit->second.first : eit->second.second;
-			if (!ext.empty())
-				extensions.insert(ext);
-		}
+		delete s_SupportLibraries[version];
+		s_SupportLibraries[version] = 0;
 	}
+}
+
+const std::string& getHLSLSupportCode (ETargetVersion targetVersion, TOperator op, ExtensionSet& extensions, bool vertexShader, bool gles)
+{
+	assert (targetVersion >= 0 && targetVersion <= ETargetVersionCount);
+	assert (op >= 0 && op < EOpCount);
+	const HlslSupportLibrary* lib = s_SupportLibraries[targetVersion];
+	assert (lib);
+	const HlslSupportLibrary::Entry& e = lib->entries[op];
 
-	assert (hlslSupportLib);
-	assert (hlslSupportLibESOverrides);
+	// if we're using gles, attempt to find the ES version first
+	const CodeExtension* ext = (gles && e.extensionES) ? e.extensionES : e.extension;
+	if (ext)
+	{
+		const std::string& name = vertexShader ? ext->first : ext->second;
+		if (!name.empty())
+			extensions.insert(name);
+	}
 
 	// same as above, search for a gles version first
 	bool tex2DLodVSHack = false;
 	if (vertexShader && op == EOpTex2DLod)
 		tex2DLodVSHack = true;
-	if (gles && !tex2DLodVSHack)
-	{
-		CodeMap::iterator it = hlslSupportLibESOverrides->find(op);
-		if (it != hlslSupportLibESOverrides->end())
-			return it->second;
-	}
-
-	CodeMap::iterator it = hlslSupportLib->find(op);
-	if (it == hlslSupportLib->end())
-		it = hlslSupportLib->find(EOpNull); // this always exists
+	if (gles && !tex2DLodVSHack && e.codeES)
+		return *e.codeES;
 
-	return it->second;
+	return *e.code;
 }
@@ -11,11 +11,13 @@
 #include "../Include/intermediate.h"
 #include "../../include/hlsl2glsl.h" // for ETargetVersion
 
-void initializeHLSLSupportLibrary(ETargetVersion targetVersion);
+// Builds the support library for every target version; done once at
+// Hlsl2Glsl_Initialize time, the tables are read-only afterwards.
+void initializeHLSLSupportLibrary();
 void finalizeHLSLSupportLibrary();
 
 typedef std::set<std::string> ExtensionSet;
 
-std::string getHLSLSupportCode (TOperator op, ExtensionSet& extensions, bool vertexShader, bool gles);
+const std::string& getHLSLSupportCode (ETargetVersion targetVersion, TOperator op, ExtensionSet& extensions, bool vertexShader, bool gles);
 
 #endif //HLSL_SUPPORT_LIB_H
@@ -7,22 +7,19 @@
 #include "localintermediate.h"
 
 
+// Collects the uses of each symbol, and which symbols are mutable uniforms
+// in any of them, in one traversal.
 struct TPropagateMutable : public TIntermTraverser 
 {
 	static void traverseSymbol(TIntermSymbol*, TIntermTraverser*);
 	
 	TInfoSink& infoSink;
 	
-	bool abort;
+	std::map<int, std::vector<TIntermSymbol*> > uses;
+	std::set<int> mutableIds;
 	
-	// These are used to go into "propagating mode"
-	bool propagating;
-	int id;
 	
-	std::set<int> fixedIds; // to prevent infinite loops
-	
-	
-	TPropagateMutable(TInfoSink &is) : infoSink(is), abort(false), propagating(false), id(0)
+	TPropagateMutable(TInfoSink &is) : infoSink(is)
 	{
 		visitSymbol = traverseSymbol;
 	}
@@ -34,41 +31,22 @@ void TPropagateMutable::traverseSymbol( TIntermSymbol *node, TIntermTraverser *i
 {
 	TPropagateMutable* sit = static_cast<TPropagateMutable*>(it);
 
-	if (sit->abort)
-		return;
-
-	if (sit->propagating && sit->id == node->getId())
-	{
-		node->getTypePointer()->changeQualifier( EvqMutableUniform );
-	}
-	else if (!sit->propagating && sit->fixedIds.find(node->getId()) == sit->fixedIds.end())
-	{
-		if (node->getQualifier() == EvqMutableUniform)
-		{
-			sit->abort = true;
-			sit->id = node->getId();
-			sit->fixedIds.insert(sit->id);
-		}
-	}
+	sit->uses[node->getId()].push_back(node);
+	if (node->getQualifier() == EvqMutableUniform)
+		sit->mutableIds.insert(node->getId());
 }
 
 void PropagateMutableUniforms (TIntermNode* root, TInfoSink &info)
 {
 	TPropagateMutable st(info);
 
-	do
-	{
-		st.abort = false;
-		root->traverse(&st);
+	root->traverse(&st);
 
-		// If we aborted, try to type the node we aborted for
-		if (st.abort)
-		{
-			st.propagating = true;
-			st.abort = false;
-			root->traverse(&st);
-			st.propagating = false;
-			st.abort = true;
-		}
-	} while (st.abort);
+	// If a symbol is a mutable uniform anywhere, it is everywhere
+	for (std::set<int>::iterator id = st.mutableIds.begin(); id != st.mutableIds.end(); ++id)
+	{
+		std::vector<TIntermSymbol*>& symbols = st.uses[*id];
+		for (size_t i = 0; i < symbols.size(); ++i)
+			symbols[i]->changeQualifier( EvqMutableUniform );
+	}
 }
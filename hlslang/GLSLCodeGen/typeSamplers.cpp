@@ -6,443 +6,315 @@
 #include "typeSamplers.h"
 #include "localintermediate.h"
 #include "glslOutput.h"
-
-struct TSamplerTraverser : public TIntermTraverser 
+#include <queue>
+
+//
+// A generic sampler gets its type from the first thing that types it: being
+// passed to a texture lookup, or to a function parameter that has been typed.
+// "First" is in tree order, and typing one sampler can make another typeable
+// (a typed parameter types the arguments passed to it), so this used to be
+// done by traversing the tree until something got typed, and starting over.
+//
+// Instead, everything that can type a sampler is collected in one traversal,
+// as a list of events in tree order, along with all the uses of each symbol.
+// Then the events are fired from a priority queue, earliest first, which types
+// the samplers in the same order (and so to the same types) as before.
+//
+struct TSamplerTraverser : public TIntermTraverser
 {
-	static void traverseSymbol(TIntermSymbol*, TIntermTraverser*);
-	static void traverseParameterSymbol(TIntermSymbol *node, TIntermTraverser *it);
-	static bool traverseBinary(bool preVisit, TIntermBinary*, TIntermTraverser*);
-	static bool traverseUnary(bool preVisit, TIntermUnary*, TIntermTraverser*);
-	static bool traverseSelection(bool preVisit, TIntermSelection*, TIntermTraverser*);
-	static bool traverseAggregate(bool preVisit, TIntermAggregate*, TIntermTraverser*);
-	static bool traverseLoop(bool preVisit, TIntermLoop*, TIntermTraverser*);
-	static bool traverseBranch(bool preVisit, TIntermBranch*,  TIntermTraverser*);
-	
-	/// Set the type for the sampler
-	void typeSampler( TIntermTyped *node, TBasicType samp);
-	
-	TInfoSink& infoSink;
-	
-	bool abort;
-	
-	// These are used to go into "typing mode"
-	bool typing;
-	int id;
-	TBasicType sampType;
-	
-	std::map<std::string,TNodeArray* > functionMap;
-	
-	std::string currentFunction;
-	
-	TSamplerTraverser(TInfoSink &is) : infoSink(is), abort(false), typing(false), id(0), sampType(EbtSamplerGeneric) 
-	{
-		visitSymbol = traverseSymbol;
-		//visitConstant = traverseConstant;
-		visitBinary = traverseBinary;
-		visitUnary = traverseUnary;
-		visitSelection = traverseSelection;
-		visitAggregate = traverseAggregate;
-		visitLoop = traverseLoop;
-		visitBranch = traverseBranch;
-	}
-};
+   static void traverseSymbol(TIntermSymbol*, TIntermTraverser*);
+   static bool traverseAggregate(bool preVisit, TIntermAggregate*, TIntermTraverser*);
 
+   // Something that types a sampler symbol, if it is still generic
+   struct TEvent
+   {
+      int site;               // tree order of the texture lookup or call
+      int argument;           // for calls: later arguments are typed first
+      TIntermSymbol* sampler;
+      TIntermSymbol* parameter; // for calls: the parameter whose type is taken
+      TBasicType sampType;    // for texture lookups
+   };
+
+   // A texture lookup, for reporting sampler misuse once all are typed
+   struct TTextureLookup
+   {
+      TIntermAggregate* node;
+      TBasicType sampType;
+   };
 
+   void addCallEvents(int site, TIntermAggregate* call);
+   void typeSamplers();
+   void reportErrors();
 
-void TSamplerTraverser::traverseSymbol( TIntermSymbol *node, TIntermTraverser *it )
-{
-   TSamplerTraverser* sit = static_cast<TSamplerTraverser*>(it);
+   TInfoSink& infoSink;
 
-   if (sit->abort)
-      return;
+   int sites;
+   std::map<int, std::vector<TIntermSymbol*> > uses;
+   std::vector<TTextureLookup> lookups;
+   std::vector<std::pair<int, TIntermAggregate*> > calls;
+   std::vector<TEvent> events;
 
-   if (sit->typing && sit->id == node->getId())
+   std::map<std::string,TNodeArray* > functionMap;
+
+   std::string currentFunction;
+
+   TSamplerTraverser(TInfoSink &is) : infoSink(is), sites(0)
    {
-      TType* type = node->getTypePointer();
-      // Technically most of these should never happen
-	  type->setBasicType (sit->sampType);
+      visitSymbol = traverseSymbol;
+      visitAggregate = traverseAggregate;
    }
-}
+};
 
 
-bool TSamplerTraverser::traverseBinary( bool preVisit, TIntermBinary *node, TIntermTraverser *it )
+// The sampler type a texture lookup takes, or EbtVoid if it isn't one
+static TBasicType GetLookupSamplerType(TOperator op)
 {
-   TSamplerTraverser* sit = static_cast<TSamplerTraverser*>(it);
-
-   if (sit->abort)
-      return false;
-
-   switch (node->getOp())
+   switch (op)
    {
-   case EOpAssign:
-      //believed to be disallowed on samplers...
-      break;
-
-   case EOpIndexDirect:
-   case EOpIndexIndirect:
-      //not planning to support arrays of samplers with different types 
-      break;
-
-   case EOpIndexDirectStruct:
-      //Structs in samplers not supported
-      break;
+   case EOpTex1D:
+   case EOpTex1DProj:
+   case EOpTex1DLod:
+   case EOpTex1DBias:
+   case EOpTex1DGrad:
+      return EbtSampler1D;
+
+   case EOpTex2D:
+   case EOpTex2DProj:
+   case EOpTex2DLod:
+   case EOpTex2DBias:
+   case EOpTex2DGrad:
+      return EbtSampler2D;
+
+   case EOpShadow2D:
+   case EOpShadow2DProj:
+      return EbtSampler2DShadow;
+
+   case EOpTex2DArray:
+   case EOpTex2DArrayLod:
+   case EOpTex2DArrayBias:
+      return EbtSampler2DArray;
+
+   case EOpTexRect:
+   case EOpTexRectProj:
+      return EbtSamplerRect;
+
+   case EOpTex3D:
+   case EOpTex3DProj:
+   case EOpTex3DLod:
+   case EOpTex3DBias:
+   case EOpTex3DGrad:
+      return EbtSampler3D;
+
+   case EOpTexCube:
+   case EOpTexCubeProj:
+   case EOpTexCubeLod:
+   case EOpTexCubeBias:
+   case EOpTexCubeGrad:
+      return EbtSamplerCube;
 
    default:
-      break;
+      return EbtVoid;
    }
-
-   return !(sit->abort);
 }
 
 
-bool TSamplerTraverser::traverseUnary( bool preVisit, TIntermUnary *node, TIntermTraverser *it)
+void TSamplerTraverser::traverseSymbol( TIntermSymbol *node, TIntermTraverser *it )
 {
    TSamplerTraverser* sit = static_cast<TSamplerTraverser*>(it);
 
-   return !(sit->abort);
+   sit->uses[node->getId()].push_back(node);
 }
 
 
-bool TSamplerTraverser::traverseSelection( bool preVisit, TIntermSelection *node, TIntermTraverser *it)
+bool TSamplerTraverser::traverseAggregate( bool preVisit, TIntermAggregate *node, TIntermTraverser *it)
 {
-   //TODO: might need to run down this rat hole for ?: operator
    TSamplerTraverser* sit = static_cast<TSamplerTraverser*>(it);
 
-   return !(sit->abort);
-}
-
+   switch (node->getOp())
+   {
+   case EOpFunction:
+      // Store the current function name to use to setup the parameters
+      sit->currentFunction = node->getName().c_str();
+      break;
 
-bool TSamplerTraverser::traverseAggregate( bool preVisit, TIntermAggregate *node, TIntermTraverser *it)
-{
-   TSamplerTraverser* sit = static_cast<TSamplerTraverser*>(it);
-   TInfoSink &infoSink = sit->infoSink;
+   case EOpParameters:
+      // Store the parameters to the function in the map
+      sit->functionMap[sit->currentFunction.c_str()] = &(node->getNodes());
+      break;
 
-   if (sit->abort)
-      return false;
+   case EOpFunctionCall:
+      // The function may be defined further down, so these are looked at
+      // once the whole tree has been seen.
+      sit->calls.push_back(std::make_pair(sit->sites++, node));
+      break;
 
-   if (! (sit->typing) )
-   {
-      switch (node->getOp())
+   default:
       {
-      
-      case EOpFunction:
-         // Store the current function name to use to setup the parameters
-         sit->currentFunction = node->getName().c_str(); 
-         break;
-
-      case EOpParameters:
-         // Store the parameters to the function in the map
-         sit->functionMap[sit->currentFunction.c_str()] = &(node->getNodes());
-         break;
-
-      case EOpFunctionCall:
+         TBasicType sampType = GetLookupSamplerType(node->getOp());
+         if (sampType == EbtVoid)
+            break;
+
+         int site = sit->sites++;
+         TNodeArray& nodes = node->getNodes();
+         assert(nodes.size());
+         TIntermTyped *sampArg = nodes[0]->getAsTyped();
+         assert(sampArg);
+         if (!sampArg)
+            break;
+
+         TTextureLookup lookup = { node, sampType };
+         sit->lookups.push_back(lookup);
+
+         TIntermSymbol *symNode = sampArg->getAsSymbolNode();
+         if (symNode && symNode->getBasicType() == EbtSamplerGeneric)
          {
-            // This is a bit tricky.  Find the function in the map.  Loop over the parameters
-            // and see if the parameters have been marked as a typed sampler.  If so, propagate
-            // the sampler type to the caller
-            if ( sit->functionMap.find ( node->getName().c_str() ) != sit->functionMap.end() )
-            {
-               // Get the sequence of function parameters
-               TNodeArray *funcSequence = sit->functionMap[node->getName().c_str()];
-               
-               // Get the sequence of parameters being passed to function
-               TNodeArray& nodes = node->getNodes();
-
-               // Grab iterators to both sequences
-               TNodeArray::iterator symit = nodes.begin();
-               TNodeArray::iterator funcIt = funcSequence->begin();
-
-               assert (nodes.size() == funcSequence->size());
-               if (nodes.size() == funcSequence->size())
-               {
-                  while (symit != nodes.end())
-                  {
-                     TIntermSymbol *sym = (*symit)->getAsSymbolNode();
-                     TIntermSymbol *funcSym = (*funcIt)->getAsSymbolNode();
-                     
-                     if ( sym != NULL && funcSym != NULL)
-                     {
-                        // If the parameter is generic, and the sampler to which
-                        // it is being passed has been marked, propogate its sampler
-                        // type to the caller.
-                        if ( sym->getBasicType() == EbtSamplerGeneric &&
-                             funcSym->getBasicType() != EbtSamplerGeneric )
-                        {
-                           sit->typeSampler ( sym, funcSym->getBasicType() );
-                        }
-                     }
-                     symit++;
-                     funcIt++;
-                  }
-               }
-            }
+            TEvent event = { site, 0, symNode, NULL, sampType };
+            sit->events.push_back(event);
          }
-         break;
-
-         //HLSL texture functions
-      case EOpTex1D:
-      case EOpTex1DProj:
-      case EOpTex1DLod:
-      case EOpTex1DBias:
-      case EOpTex1DGrad:
-         {
-            TNodeArray& nodes = node->getNodes();
-            assert(nodes.size());
-            TIntermTyped *sampArg = nodes[0]->getAsTyped();
-            if ( sampArg)
-            {
-               if (sampArg->getBasicType() == EbtSamplerGeneric)
-               {
-                  //type the sampler
-                  sit->typeSampler( sampArg, EbtSampler1D);
-               }
-               else if (sampArg->getBasicType() != EbtSampler1D)
-               {
-                  //We have a sampler mismatch error
-                  infoSink.info << "Error: " << node->getLine() << ": Sampler type mismatch, likely using a generic sampler as two types\n";
-               }
-            }
-            else
-            {
-               assert(0);
-            }
+      }
+      // We need to continue the traverse here, because the calls could be nested
+      break;
+   }
 
-         }
-         // We need to continue the traverse here, because the calls could be nested 
-         break;
+   return true;
+}
 
 
-      case EOpTex2D:
-      case EOpTex2DProj:
-      case EOpTex2DLod:
-      case EOpTex2DBias:
-      case EOpTex2DGrad:
-         {
-            TNodeArray& nodes = node->getNodes();
-            assert(nodes.size());
-            TIntermTyped *sampArg = nodes[0]->getAsTyped();
-            if ( sampArg)
-            {
-               if (sampArg->getBasicType() == EbtSamplerGeneric)
-               {
-                  //type the sampler
-                  sit->typeSampler( sampArg, EbtSampler2D);
-               }
-               else if (sampArg->getBasicType() != EbtSampler2D)
-               {
-                  //We have a sampler mismatch error
-                  infoSink.info << "Error: " << node->getLine() << ": Sampler type mismatch, likely using a generic sampler as two types\n";
-               }
-            }
-            else
-            {
-               assert(0);
-            }
+void TSamplerTraverser::addCallEvents(int site, TIntermAggregate* call)
+{
+   // This is a bit tricky.  Find the function in the map.  Loop over the parameters
+   // and see if the parameters have been marked as a typed sampler.  If so, propagate
+   // the sampler type to the caller
+   std::map<std::string,TNodeArray* >::iterator func = functionMap.find(call->getName().c_str());
+   if (func == functionMap.end())
+      return;
 
-         }
-         // We need to continue the traverse here, because the calls could be nested 
-         break;
-			  
-		case EOpShadow2D:
-		case EOpShadow2DProj:
-		{
-			TNodeArray& nodes = node->getNodes();
-			assert(nodes.size());
-			TIntermTyped *sampArg = nodes[0]->getAsTyped();
-			if (sampArg)
-			{
-				if (sampArg->getBasicType() == EbtSamplerGeneric)
-					sit->typeSampler(sampArg, EbtSampler2DShadow);
-				else if (sampArg->getBasicType() != EbtSampler2DShadow)
-					infoSink.info << "Error: " << node->getLine() << ": Sampler type mismatch, likely using a generic sampler as two types\n";
-			}
-			else
-			{
-				assert(0);
-			}
-		}
-		// We need to continue the traverse here, because the calls could be nested
-		break;
-
-		case EOpTex2DArray:
-		case EOpTex2DArrayLod:
-		case EOpTex2DArrayBias:
-		{
-			TNodeArray& nodes = node->getNodes();
-			assert(nodes.size());
-			TIntermTyped *sampArg = nodes[0]->getAsTyped();
-			if (sampArg)
-			{
-				if (sampArg->getBasicType() == EbtSamplerGeneric)
-					sit->typeSampler(sampArg, EbtSampler2DArray);
-				else if (sampArg->getBasicType() != EbtSampler2DArray)
-					infoSink.info << "Error: " << node->getLine() << ": Sampler type mismatch, likely using a generic sampler as two types\n";
-			}
-			else
-			{
-				assert(0);
-			}
-		  }
-		
-		// We need to continue the traverse here, because the calls could be nested 
-		break;
-			  
-	  case EOpTexRect:
-	  case EOpTexRectProj:
-		  {
-			  TNodeArray& nodes = node->getNodes();
-			  assert(nodes.size());
-			  TIntermTyped *sampArg = nodes[0]->getAsTyped();
-			  if ( sampArg)
-			  {
-				  if (sampArg->getBasicType() == EbtSamplerGeneric)
-				  {
-					  //type the sampler
-					  sit->typeSampler( sampArg, EbtSamplerRect);
-				  }
-				  else if (sampArg->getBasicType() != EbtSamplerRect)
-				  {
-					  //We have a sampler mismatch error
-					  infoSink.info << "Error: " << node->getLine() << ": Sampler type mismatch, likely using a generic sampler as two types\n";
-				  }
-			  }
-			  else
-			  {
-				  assert(0);
-			  }
-			  
-		  }
-		  // We need to continue the traverse here, because the calls could be nested 
-		  break;
-			  
-			  
-      case EOpTex3D:
-      case EOpTex3DProj:
-      case EOpTex3DLod:
-      case EOpTex3DBias:
-      case EOpTex3DGrad:
-         {
-            TNodeArray& nodes = node->getNodes();
-            assert(nodes.size());
-            TIntermTyped *sampArg = nodes[0]->getAsTyped();
-            if ( sampArg)
-            {
-               if (sampArg->getBasicType() == EbtSamplerGeneric)
-               {
-                  //type the sampler
-                  sit->typeSampler( sampArg, EbtSampler3D);
-               }
-               else if (sampArg->getBasicType() != EbtSampler3D)
-               {
-                  //We have a sampler mismatch error
-                  infoSink.info << "Error: " << node->getLine() << ": Sampler type mismatch, likely using a generic sampler as two types\n";
-               }
-            }
-            else
-            {
-               assert(0);
-            }
+   // Get the sequence of function parameters
+   TNodeArray *funcSequence = func->second;
 
-         }
-         // We need to continue the traverse here, because the calls could be nested 
-         break;
-
-      case EOpTexCube:
-      case EOpTexCubeProj:
-      case EOpTexCubeLod:
-      case EOpTexCubeBias:
-      case EOpTexCubeGrad:
-         {
-            TNodeArray& nodes = node->getNodes();
-            assert(nodes.size());
-            TIntermTyped *sampArg = nodes[0]->getAsTyped();
-            if ( sampArg)
-            {
-               if (sampArg->getBasicType() == EbtSamplerGeneric)
-               {
-                  //type the sampler
-                  sit->typeSampler( sampArg, EbtSamplerCube);
-               }
-               else if (sampArg->getBasicType() != EbtSamplerCube)
-               {
-                  //We have a sampler mismatch error
-                  infoSink.info << "Error: " << node->getLine() << ": Sampler type mismatch, likely using a generic sampler as two types\n";
-               }
-            }
-            else
-            {
-               assert(0);
-            }
+   // Get the sequence of parameters being passed to function
+   TNodeArray& nodes = call->getNodes();
 
-         }
-         // We need to continue the traverse here, because the calls could be nested 
-         break;
+   assert (nodes.size() == funcSequence->size());
+   if (nodes.size() != funcSequence->size())
+      return;
 
-      default: 
-         break;
+   for (size_t i = 0; i < nodes.size(); ++i)
+   {
+      TIntermSymbol *sym = nodes[i]->getAsSymbolNode();
+      TIntermSymbol *funcSym = (*funcSequence)[i]->getAsSymbolNode();
+      if (sym != NULL && funcSym != NULL && sym->getBasicType() == EbtSamplerGeneric)
+      {
+         TEvent event = { site, -int(i), sym, funcSym, EbtVoid };
+         events.push_back(event);
       }
    }
-
-
-   return !(sit->abort);
 }
 
 
-bool TSamplerTraverser::traverseLoop( bool preVisit, TIntermLoop *node, TIntermTraverser *it)
+// Orders the priority queue of events, earliest first
+struct TEventOrder
 {
-   TSamplerTraverser* sit = static_cast<TSamplerTraverser*>(it);
-
-   return !(sit->abort);
-}
+   const std::vector<TSamplerTraverser::TEvent>& events;
+   TEventOrder(const std::vector<TSamplerTraverser::TEvent>& e) : events(e) { }
+   bool operator()(int a, int b) const
+   {
+      if (events[a].site != events[b].site)
+         return events[a].site > events[b].site;
+      return events[a].argument > events[b].argument;
+   }
+};
 
 
-bool TSamplerTraverser::traverseBranch( bool preVisit, TIntermBranch *node,  TIntermTraverser *it)
+void TSamplerTraverser::typeSamplers()
 {
-   TSamplerTraverser* sit = static_cast<TSamplerTraverser*>(it);
+   for (size_t i = 0; i < calls.size(); ++i)
+      addCallEvents(calls[i].first, calls[i].second);
 
-   return !(sit->abort);
+   // Events on each typed parameter wait here until the parameter is typed
+   std::map<int, std::vector<int> > waiting;
+   std::priority_queue<int, std::vector<int>, TEventOrder> ready((TEventOrder(events)));
+   for (size_t i = 0; i < events.size(); ++i)
+   {
+      const TEvent& e = events[i];
+      if (e.parameter && e.parameter->getBasicType() == EbtSamplerGeneric)
+         waiting[e.parameter->getId()].push_back(int(i));
+      else
+         ready.push(int(i));
+   }
+
+   while (!ready.empty())
+   {
+      const TEvent& e = events[ready.top()];
+      ready.pop();
+
+      // If the parameter is generic, and the sampler to which it is being
+      // passed has been marked, propogate its sampler type to the caller.
+      if (e.sampler->getBasicType() != EbtSamplerGeneric)
+         continue;
+      if (e.parameter && e.parameter->getBasicType() == EbtSamplerGeneric)
+         continue;
+
+      TBasicType sampType = e.parameter ? e.parameter->getBasicType() : e.sampType;
+      int id = e.sampler->getId();
+      std::vector<TIntermSymbol*>& symbols = uses[id];
+      for (size_t i = 0; i < symbols.size(); ++i)
+      {
+         TType t(symbols[i]->getType());
+         t.setBasicType(sampType);
+         symbols[i]->setType(t);
+      }
+
+      std::map<int, std::vector<int> >::iterator w = waiting.find(id);
+      if (w != waiting.end())
+      {
+         for (size_t i = 0; i < w->second.size(); ++i)
+            ready.push(w->second[i]);
+         waiting.erase(w);
+      }
+   }
 }
 
 
-void TSamplerTraverser::typeSampler( TIntermTyped *node, TBasicType samp )
+void TSamplerTraverser::reportErrors()
 {
-   TIntermSymbol *symNode = node->getAsSymbolNode();
-
-   if ( !symNode)
+   for (size_t i = 0; i < lookups.size(); ++i)
    {
-      //TODO: add logic to handle sampler arrays and samplers as struct members
+      TIntermAggregate* node = lookups[i].node;
+      TIntermTyped *sampArg = node->getNodes()[0]->getAsTyped();
+      if (sampArg->getBasicType() == EbtSamplerGeneric)
+      {
+         //TODO: add logic to handle sampler arrays and samplers as struct members
 
-      //Don't try typing this one, it is a complex expression
-      TIntermBinary *biNode = node->getAsBinaryNode();
+         //Don't try typing this one, it is a complex expression
+         TIntermBinary *biNode = sampArg->getAsBinaryNode();
 
-      if ( biNode )
-      {
-         switch (biNode->getOp())
+         if ( biNode )
          {
-         case EOpIndexDirect:
-         case EOpIndexIndirect:
-            infoSink.info << "Warning: " << node->getLine() <<  ": typing of sampler arrays presently unsupported\n";
-            break;
-
-         case EOpIndexDirectStruct:
-            infoSink.info << "Warning: " << node->getLine() <<  ": typing of samplers as struct members presently unsupported\n";
-            break;
-         default:
-            break;
+            switch (biNode->getOp())
+            {
+            case EOpIndexDirect:
+            case EOpIndexIndirect:
+               infoSink.info << "Warning: " << sampArg->getLine() <<  ": typing of sampler arrays presently unsupported\n";
+               break;
+
+            case EOpIndexDirectStruct:
+               infoSink.info << "Warning: " << sampArg->getLine() <<  ": typing of samplers as struct members presently unsupported\n";
+               break;
+            default:
+               break;
+            }
+         }
+         else
+         {
+            infoSink.info << "Warning: " << sampArg->getLine() <<  ": unexpected expression type for sampler, cannot type\n";
          }
       }
-      else
+      else if (sampArg->getBasicType() != lookups[i].sampType)
       {
-         infoSink.info << "Warning: " << node->getLine() <<  ": unexpected expression type for sampler, cannot type\n";
+         //We have a sampler mismatch error
+         infoSink.info << "Error: " << node->getLine() << ": Sampler type mismatch, likely using a generic sampler as two types\n";
       }
-      abort = false;
-   }
-   else
-   {
-      // We really have something to type, abort this traverse and activate typing
-      abort = true;
-      id = symNode->getId();
-      sampType = samp;
    }
 }
 
@@ -451,19 +323,7 @@ void PropagateSamplerTypes (TIntermNode* root, TInfoSink &info)
 {
    TSamplerTraverser st(info);
 
-   do
-   {
-      st.abort = false;
-      root->traverse( &st);
-
-      // If we aborted, try to type the node we aborted for
-      if (st.abort)
-      {
-         st.typing = true;
-         st.abort = false;
-         root->traverse( &st);
-         st.typing = false;
-         st.abort = true;
-      }
-   } while (st.abort);
+   root->traverse(&st);
+   st.typeSamplers();
+   st.reportErrors();
 }
@@ -30,12 +30,42 @@
 
 // -----------------------------------------------------------------------------
 
+// How a pool gets memory from the OS, and what it keeps.
+struct TPoolOptions
+{
+   size_t pageSize;      // bytes of the first page; allocations that don't fit in one get a block of their own
+   size_t maxPageSize;   // each new page from the OS is twice as big as the last one, up to this
+   size_t keepBytes;     // popped pages are kept for reuse up to this many bytes, the rest are freed
+   bool reuseFreed;      // keep buffers that containers free (e.g. when they grow) for allocations of their size
+
+   TPoolOptions() : pageSize(8*1024), maxPageSize(8*1024), keepBytes(static_cast<size_t>(-1)), reuseFreed(false) { }
+};
+
+// Counters of a pool, since the last resetStats() (or since creation).
+struct TPoolStats
+{
+   size_t bytesRequested;      // bytes asked for by all allocations
+   size_t bytesReused;         // of those, bytes given out from freed buffers
+   size_t bytesReserved;       // bytes of pages holding allocations right now
+   size_t peakBytes;           // the most bytesReserved there was
+   size_t freeBytes;           // bytes of popped pages kept for reuse
+   unsigned allocations;
+   unsigned reusedAllocations; // allocations given out from freed buffers
+   unsigned largeAllocations;  // allocations that got a block of their own
+   unsigned pages;             // pages (and blocks) holding allocations right now
+   unsigned osAllocations;     // pages (and blocks) that had to come from the OS
+};
+
 class TPoolAllocator {
 public:
    TPoolAllocator();
    // Use popAll() or pop() to free up memory!
    ~TPoolAllocator();
 
+   // Takes effect for pages taken after this; frees the kept pages and buffers.
+   void setOptions(const TPoolOptions& options);
+   const TPoolOptions& getOptions() const { return options; }
+
    // Establish a new place to pop memory to.  Does not
    // have to be called to get things started.
    void push();
@@ -51,34 +81,65 @@ public:
    // available, otherwise a properly aligned pointer to 'numBytes' of memory.
    void* allocate(size_t numBytes);
 
-   // There is no deallocate.  The point of this class is that
+   // There is no need to deallocate.  The point of this class is that
    // deallocation can be skipped by the user of it, as the model
    // of use is to simultaneously deallocate everything at once
    // by calling pop(), and to not have to solve memory leak problems.
+   // With TPoolOptions::reuseFreed, small buffers given back here are
+   // handed out again by allocations of the same size until the next pop().
+   void deallocate(void* memory, size_t numBytes)
+   {
+      if (options.reuseFreed && memory && numBytes && numBytes <= kMaxReusedSize)
+         addReusable(memory, numBytes);
+   }
+
+   // Bytes of pages holding allocations right now, and the most there were since
+   // the last resetPeakBytes() (or since creation).
+   size_t getBytesInUse() const { return stats.bytesReserved; }
+   size_t getPeakBytes() const { return stats.peakBytes; }
+   void resetPeakBytes() { stats.peakBytes = stats.bytesReserved; }
+
+   const TPoolStats& getStats() const { return stats; }
+   void resetStats();
 
 private:
 	struct AllocHeader;
 
+	enum { kMaxReusedSize = 1024 };
+
+	void addBytesInUse(size_t bytes);
+	AllocHeader* newPage(size_t size, bool large);
+	void releasePage(AllocHeader* page);
+	void freePages();
+	void addReusable(void* memory, size_t numBytes);
+	void clearReusable();
+	bool inUseListHas(const void* memory) const;
+
 	struct AllocState
 	{
 		size_t offset;
 		AllocHeader* page;
 	};
 
-	size_t pageSize;        // granularity of allocation from the OS
+	TPoolOptions options;
+	size_t nextPageSize;    // bytes of the next page taken from the OS
 	size_t alignment;       // all returned allocations will be aligned at
 						 //      this granularity, which will be a power of 2
 	size_t alignmentMask;
 	size_t headerSkip;      // amount of memory to skip to make room for the
 						 //      header (basically, size of header, rounded
 						 //      up to make it aligned
+	size_t currentPageSize;    // bytes of the top of inUseList
 	size_t currentPageOffset;  // next offset in top of inUseList to allocate from
 	AllocHeader* freeList;      // list of popped memory
 	AllocHeader* inUseList;     // list of all memory currently being used
 	std::vector<AllocState> stack;      // stack of where to allocate from, to partition pool
 
-	int numCalls;           // just an interesting statistic
-	size_t totalBytes;      // just an interesting statistic
+	// freed buffers by size, in units of the alignment
+	void* reusable[kMaxReusedSize / 16 + 1];
+	bool hasReusable;
+
+	TPoolStats stats;
 
 private:
 	// no copying
@@ -92,7 +153,22 @@ private:
 // different times.  But a simple use is to have a global pop
 // with everyone using the same global allocator.
 //
+// Every pool string, container and node goes through GlobalPoolAllocator,
+// so where the compiler has thread local variables, it's an inline read
+// of one. Otherwise it's looked up in OS thread local storage.
+//
+#if defined(_MSC_VER)
+	#define POOL_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+	#define POOL_THREAD_LOCAL __thread
+#endif
+
+#ifdef POOL_THREAD_LOCAL
+extern POOL_THREAD_LOCAL TPoolAllocator* CurrentPoolAllocator;
+inline TPoolAllocator& GetGlobalPoolAllocator() { return *CurrentPoolAllocator; }
+#else
 extern TPoolAllocator& GetGlobalPoolAllocator();
+#endif
 #define GlobalPoolAllocator GetGlobalPoolAllocator()
 
 
@@ -176,8 +252,8 @@ public:
       return reinterpret_cast<pointer>(getAllocator().allocate(n * sizeof(T)));
    }
 
-   void deallocate(void*, size_type) { }
-   void deallocate(pointer, size_type) { }
+   void deallocate(void* p, size_type n) { getAllocator().deallocate(p, n * sizeof(T)); }
+   void deallocate(pointer p, size_type n) { getAllocator().deallocate(p, n * sizeof(T)); }
 #endif
 
    pointer _Charalloc(size_t n)
@@ -46,7 +46,7 @@ public:
 	bool matrix;
 	bool array;
 	int arraySize;
-	TType* userDef;
+	const TType* userDef;
 	TSourceLoc line;
 
 	void setBasic(TBasicType bt, TQualifier q, const TSourceLoc& ln = gNullSourceLoc)
@@ -108,15 +108,14 @@ public:
    explicit TType() { }
    explicit TType(TBasicType t, TPrecision p, TQualifier q = EvqTemporary, int cols = 1, int rows = 1, bool m = false, bool a = false) :
       type(t), precision(p), qualifier(q), matcols(cols), matrows(rows), line(gNullSourceLoc), matrix(m), array(a), arraySize(0),
-      structure(0), structureSize(0), maxArraySize(0), arrayInformationType(0), fieldName(0), mangled(0), typeName(0),
-      semantic(0)
+      structure(0), structureSize(0), maxArraySize(0), fieldName(0), mangled(0), typeName(0), semantic(0)
    {
       checkInvariants();
    }
    explicit TType(const TPublicType &p) :
       type(p.type), precision(p.precision), qualifier(p.qualifier), matrows(p.matrows), matcols(p.matcols), line(p.line), matrix(p.matrix),
       array(p.array), arraySize(p.arraySize), structure(0), structureSize(0), maxArraySize(0),
-      arrayInformationType(0), fieldName(0), mangled(0), typeName(0), semantic(0)
+      fieldName(0), mangled(0), typeName(0), semantic(0)
    {
       if (p.userDef)
       {
@@ -128,7 +127,7 @@ public:
    }
    explicit TType(TTypeList* userDef, const TString& n, TPrecision p = EbpUndefined, const TSourceLoc& l = gNullSourceLoc) :
       type(EbtStruct), precision(p), qualifier(EvqTemporary), matrows(1), matcols(1), line(l), matrix(false), array(false), arraySize(0),
-      structure(userDef), maxArraySize(0), arrayInformationType(0), fieldName(0), mangled(0), semantic(0)
+      structure(userDef), maxArraySize(0), fieldName(0), mangled(0), semantic(0)
    {
       typeName = NewPoolTString(n.c_str());
       checkInvariants();
@@ -187,8 +186,6 @@ public:
 
       structureSize = copyOf.structureSize;
       maxArraySize = copyOf.maxArraySize;
-      assert(copyOf.arrayInformationType == 0);
-      arrayInformationType = 0; // arrayInformationType should not be set for builtIn symbol table level
 
       checkInvariants();
    }
@@ -204,8 +201,9 @@ public:
    void setType(TBasicType t, int cols, int rows, bool m, bool a, int aS = 0)
    {
       type = t; matcols = cols; matrows = rows; matrix = m; array = a; arraySize = aS;
+      mangled = 0;
    }
-   void setType(TBasicType t, int cols, int rows, bool m, TType* userDef = 0)
+   void setType(TBasicType t, int cols, int rows, bool m, const TType* userDef = 0)
    {
       type = t; 
       matcols = cols; 
@@ -214,6 +212,7 @@ public:
       if (userDef)
          structure = userDef->getStruct();
       // leave array information intact.
+      mangled = 0;
    }
    void setTypeName(const TString& n)
    {
@@ -240,15 +239,15 @@ public:
    TQualifier getQualifier() const { return qualifier; }
    const TSourceLoc& getLine() const { return line; }
 
-   void setBasicType(TBasicType t) { type = t; }
+   void setBasicType(TBasicType t) { type = t; mangled = 0; }
    void setPrecision(TPrecision p) { precision = p; }
    void changeQualifier(TQualifier q) { qualifier = q; }
 
    int getColsCount() const { return matcols; }
-   void setColsCount(int count) { matcols = count; }
+   void setColsCount(int count) { matcols = count; mangled = 0; }
 
    int getRowsCount() const { return matrows; }
-   void setRowsCount(int count) { matrows = count; }
+   void setRowsCount(int count) { matrows = count; mangled = 0; }
 
    // Full-dimensional size of single instance of type
    int getInstanceSize() const
@@ -268,16 +267,14 @@ public:
    }
 
    bool isMatrix() const { return matrix ? true : false; }
-   void setMatrix(bool m) { matrix = m; }
-   void setArray(bool is_array) { array = is_array; }
+   void setMatrix(bool m) { matrix = m; mangled = 0; }
+   void setArray(bool is_array) { array = is_array; mangled = 0; }
    bool isArray() const { return array ? true : false; }
    int getArraySize() const { return arraySize; }
-   void setArraySize(int s) { array = true; arraySize = s; }
+   void setArraySize(int s) { array = true; arraySize = s; mangled = 0; }
    void setMaxArraySize (int s) { maxArraySize = s; }
    int getMaxArraySize () const { return maxArraySize; }
-   void clearArrayness() { array = false; arraySize = 0; maxArraySize = 0; }
-   void setArrayInformationType(TType* t) { arrayInformationType = t; }
-   TType* getArrayInformationType() { return arrayInformationType; }
+   void clearArrayness() { array = false; arraySize = 0; maxArraySize = 0; mangled = 0; }
    bool isVector() const { return matrows > 1 && !matrix; }
    static const char* getBasicString(TBasicType t)
    {
@@ -301,7 +298,7 @@ public:
       }
    }
    TTypeList* getStruct() const { return structure; }
-   void setStruct(TTypeList* s) { structure = s; }
+   void setStruct(TTypeList* s) { structure = s; mangled = 0; }
 	
    int getObjectSize() const
    {
@@ -320,7 +317,7 @@ public:
       return totalSize;
    }
 
-   TString& getMangledName()
+   const TString& getMangledName() const
    {
       if (!mangled)
       {
@@ -341,6 +338,8 @@ public:
    }
    bool operator==(const TType& right) const
    {
+      if (this == &right)
+         return true;
       return      type == right.type   &&
       matrows == right.matrows &&
       matcols == right.matcols &&
@@ -381,6 +380,9 @@ public:
    ECompatibility determineCompatibility ( const TType *pType ) const;
 
 private:
+   friend class TTypeTable;
+   friend const TType* InternType(const TType& t);
+
    int getStructSize() const;
 
    TPrecision precision;
@@ -396,14 +398,64 @@ private:
    TTypeList* structure;      // 0 unless this is a struct
    mutable int structureSize;
    int maxArraySize;
-   TType* arrayInformationType;
    TString *fieldName;         // for structure field names
-   TString *mangled;
+   mutable TString *mangled;
    TString *typeName;          // for structure field type name
    TString *semantic; //for semantics on structure fields
 };
 
 
+//
+// The types of the nodes of one AST. Every distinct type is kept once, in the
+// pool the AST is built in, so nodes share their types instead of each holding
+// a copy, and mangled names are built once per type. Types in the table must
+// never be changed; a node whose type changes is given another one. Node types
+// have no line, nodes have their own; only struct types keep the line the
+// struct is declared at, which is the same for all types of the struct.
+//
+// The types are in the pool, but the hash index to find them is on the heap;
+// clear() frees it, and must be called when the pool is popped.
+//
+class TTypeTable
+{
+public:
+   TTypeTable() : count(0) { }
+
+   // The table nodes get their types from on this thread, NULL if there is none.
+   static TTypeTable* getCurrent();
+   static void setCurrent(TTypeTable* table);
+
+   const TType* intern(const TType& t);
+
+   // Forget all types and free the index, when the pool they are in is popped.
+   void clear();
+
+private:
+   static unsigned hash(const TType& t);
+   static bool identical(const TType& a, const TType& b);
+
+   struct TSlot
+   {
+      unsigned hash;
+      const TType* type;
+   };
+   std::vector<TSlot> slots;
+   unsigned count;
+};
+
+// Type for a node: shared from the current table, or a pool copy if there is no table.
+inline const TType* InternType(const TType& t)
+{
+   TTypeTable* table = TTypeTable::getCurrent();
+   if (table)
+      return table->intern(t);
+   TType* copy = new TType(t);
+   if (copy->type != EbtStruct)
+      copy->line = gNullSourceLoc;
+   return copy;
+}
+
+
 class TAnnotation
 {
 public:
@@ -424,10 +476,11 @@ class TTypeInfo
 {
 public:
 	POOL_ALLOCATOR_NEW_DELETE(GlobalPoolAllocator)
-	TTypeInfo( const TString &s, TAnnotation *ann) : semantic(s), annotation(ann)
+	// strings are made in the current pool, not copied with the allocator of the ones passed in
+	TTypeInfo( const TString &s, TAnnotation *ann) : semantic(s.c_str(), s.size()), annotation(ann)
 	{
 	}
-	TTypeInfo( const TString &s, const TString &r, TAnnotation *ann) : semantic(s), registerSpec(r), annotation(ann)
+	TTypeInfo( const TString &s, const TString &r, TAnnotation *ann) : semantic(s.c_str(), s.size()), registerSpec(r.c_str(), r.size()), annotation(ann)
 	{
 	}
 	~TTypeInfo() { } // deallocation should be handled by the pool
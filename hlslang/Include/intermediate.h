@@ -247,6 +247,8 @@ enum TOperator
 
 	// Ternary selection on vector
 	EOpVecTernarySel,
+
+	EOpCount // number of operators, keep last
 };
 
 class TIntermTraverser;
@@ -266,6 +268,8 @@ class TIntermDeclaration;
 class TIntermNode
 {
 public:
+	// Nodes are never deleted one by one; the whole tree goes away when the
+	// AST pool is popped. Anything a node owns must come from the pool too.
 	POOL_ALLOCATOR_NEW_DELETE(GlobalPoolAllocator)
 
 	TIntermNode() : line(gNullSourceLoc)
@@ -307,32 +311,43 @@ class TIntermBinary;
 class TIntermTyped : public TIntermNode
 {
 public:
-	TIntermTyped(const TType& t) : type(t)
+	TIntermTyped(const TType& t) : type(InternType(t))
 	{
 	}
 
 	virtual TIntermTyped* getAsTyped() { return this; }
 
-	void setType(const TType& t) { type = t; }
-	TType getType() const { return type; }
-	TType* getTypePointer() { return &type; }
-
-	TBasicType getBasicType() const { return type.getBasicType(); }
-	TQualifier getQualifier() const { return type.getQualifier(); }
-	TPrecision getPrecision() const { return type.getPrecision(); }
-	int getColsCount() const { return type.getColsCount(); }
-	int getRowsCount() const { return type.getRowsCount(); }
-	int getSize() const { return type.getInstanceSize(); }
-	bool isMatrix() const { return type.isMatrix(); }
-	bool isArray()  const { return type.isArray(); }
-	bool isVector() const { return type.isVector(); }
-	bool isScalar() const { return type.isScalar(); }
-	const char* getBasicString() const { return type.getBasicString(); }
-	const char* getQualifierString() const { return type.getQualifierString(); }
-	TString getCompleteString() const { return type.getCompleteString(); }
+	// Types are shared between nodes (see TTypeTable), so changing a node's type
+	// means setting a new one; the one returned by getType can't be changed.
+	void setType(const TType& t) { type = InternType(t); }
+	const TType& getType() const { return *type; }
+	const TType* getTypePointer() const { return type; }
+
+	TBasicType getBasicType() const { return type->getBasicType(); }
+	TQualifier getQualifier() const { return type->getQualifier(); }
+	TPrecision getPrecision() const { return type->getPrecision(); }
+	int getColsCount() const { return type->getColsCount(); }
+	int getRowsCount() const { return type->getRowsCount(); }
+	int getSize() const { return type->getInstanceSize(); }
+	bool isMatrix() const { return type->isMatrix(); }
+	bool isArray()  const { return type->isArray(); }
+	bool isVector() const { return type->isVector(); }
+	bool isScalar() const { return type->isScalar(); }
+	const char* getBasicString() const { return type->getBasicString(); }
+	const char* getQualifierString() const { return type->getQualifierString(); }
+	TString getCompleteString() const { return type->getCompleteString(); }
+
+	void changeQualifier(TQualifier q)
+	{
+		if (q == type->getQualifier())
+			return;
+		TType t(*type);
+		t.changeQualifier(q);
+		setType(t);
+	}
 
 protected:
-	TType type;
+	const TType* type;
 };
 
 
@@ -394,22 +409,19 @@ protected:
 class TIntermSymbol : public TIntermTyped
 {
 public:
-	// if symbol is initialized as symbol(sym), the memory comes from the poolallocator of sym. If sym comes from
-	// per process globalpoolallocator, then it causes increased memory usage per compile
-	// it is essential to use "symbol = sym" to assign to symbol
-	TIntermSymbol(int i, const TString& sym, const TType& t) : 
-		TIntermTyped(t), id(i), info(0), global(false)
+	// sym is not copied; it's the name of the symbol (an atom, see TAtomTable), which
+	// lives in a pool at least as long as the tree does
+	TIntermSymbol(int i, const TString* sym, const TType& t) : 
+		TIntermTyped(t), id(i), global(false), symbol(sym), info(0)
 	{
-		symbol = sym;
 	} 
-	TIntermSymbol(int i, const TString& sym, const TTypeInfo *inf, const TType& t) : 
-		TIntermTyped(t), id(i), info(inf), global(false)
+	TIntermSymbol(int i, const TString* sym, const TTypeInfo *inf, const TType& t) : 
+		TIntermTyped(t), id(i), global(false), symbol(sym), info(inf)
 	{
-		symbol = sym;
 	} 
 
 	int getId() const { return id; }
-	const TString& getSymbol() const { return symbol; }
+	const TString& getSymbol() const { return *symbol; }
 	bool isGlobal() const { return global; }
 	void setGlobal(bool g) { global = g; }
 
@@ -425,7 +437,7 @@ public:
 protected:
 	int id;
 	bool global;
-	TString symbol;
+	const TString* symbol;
 	const TTypeInfo *info;
 };
 
@@ -466,7 +478,7 @@ private:
 class TIntermConstant : public TIntermTyped
 {
 public:
-	TIntermConstant(const TType& t) : TIntermTyped(t)
+	TIntermConstant(const TType& t) : TIntermTyped(t), count(0), valueType(EbtVoid), values(inlineValues)
 	{
 		grow(t.getObjectSize() - 1);
 	}
@@ -476,6 +488,12 @@ public:
 		return this;
 	}
 
+	union Scalar {
+		int asInt;
+		float asFloat;
+		bool asBool;
+	};
+
 	struct Value {
 		TBasicType type;
 		union {
@@ -485,7 +503,8 @@ public:
 		};
 	};
 	
-	#define defset(i, t) Value& v = values[(i)]; v.as##t = (val); v.type = Ebt##t
+	// All values of a constant have the same type, which is kept once per node.
+	#define defset(i, t) values[(i)].as##t = (val); valueType = Ebt##t
 	void setValue(unsigned val)			{ defset(0, Int); }
 	void setValue(int val)				{ defset(0, Int); }
 	void setValue(float val)			{ defset(0, Float); }
@@ -493,31 +512,47 @@ public:
 	void setValue(unsigned i, int val)	{ grow(i); defset(i, Int); }
 	void setValue(unsigned i, float val){ grow(i); defset(i, Float); ;}
 	void setValue(unsigned i, bool val) { grow(i); defset(i, Bool); }
-	void setValue(unsigned i, const Value& val) { values[i] = val; }
+	void setValue(unsigned i, const Value& val) { grow(i); values[i].asInt = val.asInt; valueType = val.type; }
 
-	int toInt(unsigned i = 0) { return values[i].asInt; }
-	float toFloat(unsigned i = 0) { return values[i].asFloat; }
-	bool toBool(unsigned i = 0) { return values[i].asBool; }
+	int toInt(unsigned i = 0) const { return values[i].asInt; }
+	float toFloat(unsigned i = 0) const { return values[i].asFloat; }
+	bool toBool(unsigned i = 0) const { return values[i].asBool; }
 	#undef defset
 	
-	const Value& getValue(unsigned i = 0) const { return values[i]; }
-	Value& getValue(unsigned i = 0) { return values[i]; }
+	Value getValue(unsigned i = 0) const
+	{
+		Value v;
+		v.type = valueType;
+		v.asInt = values[i].asInt;
+		return v;
+	}
 	
-	unsigned getCount() {
-		return values.size();
+	unsigned getCount() const {
+		return count;
 	}
 	
-	void copyValuesFrom(const TIntermConstant& c) { values = c.values; }
+	void copyValuesFrom(const TIntermConstant& c);
 
 	virtual void traverse(TIntermTraverser* );
 protected:
+	// Most constants are literals, so up to a float4 is kept in the node itself;
+	// bigger ones get one pool block of exactly the size they need.
+	enum { kInlineValues = 4 };
+
 	void grow(unsigned ix) {
-		if (values.size() <= ix)
-			values.resize(ix + 1);
+		if (ix >= count)
+			resize(ix + 1);
 	}
-	
-	typedef TVector<Value> Values;
-	Values values;
+	void resize(unsigned n);
+
+	unsigned count;
+	TBasicType valueType;
+	Scalar* values;
+	Scalar inlineValues[kInlineValues];
+
+private:
+	TIntermConstant(const TIntermConstant&);
+	TIntermConstant& operator=(const TIntermConstant&);
 };
 
 //
@@ -0,0 +1,973 @@
+// Generated by hlsl2glslbuiltins from the built-in prototypes in Initialize.cpp, do not edit.
+// See Initialize.h.
+
+#ifndef _BUILT_IN_SYMBOLS_INCLUDED_
+#define _BUILT_IN_SYMBOLS_INCLUDED_
+
+static const TBuiltInType kBuiltInTypes[] = {
+	{ EbtFloat, EbpHigh, EvqIn, 1, 1, false },
+	{ EbtFloat, EbpHigh, EvqGlobal, 1, 1, false },
+	{ EbtFloat, EbpHigh, EvqIn, 1, 2, false },
+	{ EbtFloat, EbpHigh, EvqGlobal, 1, 2, false },
+	{ EbtFloat, EbpHigh, EvqIn, 1, 3, false },
+	{ EbtFloat, EbpHigh, EvqGlobal, 1, 3, false },
+	{ EbtFloat, EbpHigh, EvqIn, 1, 4, false },
+	{ EbtFloat, EbpHigh, EvqGlobal, 1, 4, false },
+	{ EbtFloat, EbpHigh, EvqIn, 2, 2, true },
+	{ EbtFloat, EbpHigh, EvqGlobal, 2, 2, true },
+	{ EbtFloat, EbpHigh, EvqIn, 3, 3, true },
+	{ EbtFloat, EbpHigh, EvqGlobal, 3, 3, true },
+	{ EbtFloat, EbpHigh, EvqIn, 4, 4, true },
+	{ EbtFloat, EbpHigh, EvqGlobal, 4, 4, true },
+	{ EbtInt, EbpHigh, EvqOut, 1, 1, false },
+	{ EbtFloat, EbpHigh, EvqOut, 1, 1, false },
+	{ EbtInt, EbpHigh, EvqOut, 1, 2, false },
+	{ EbtFloat, EbpHigh, EvqOut, 1, 2, false },
+	{ EbtInt, EbpHigh, EvqOut, 1, 3, false },
+	{ EbtFloat, EbpHigh, EvqOut, 1, 3, false },
+	{ EbtInt, EbpHigh, EvqOut, 1, 4, false },
+	{ EbtFloat, EbpHigh, EvqOut, 1, 4, false },
+	{ EbtVoid, EbpUndefined, EvqGlobal, 1, 1, false },
+	{ EbtFloat, EbpHigh, EvqOut, 2, 2, true },
+	{ EbtFloat, EbpHigh, EvqOut, 3, 3, true },
+	{ EbtFloat, EbpHigh, EvqOut, 4, 4, true },
+	{ EbtFloat, EbpHigh, EvqIn, 3, 2, true },
+	{ EbtFloat, EbpHigh, EvqIn, 4, 2, true },
+	{ EbtFloat, EbpHigh, EvqGlobal, 3, 2, true },
+	{ EbtFloat, EbpHigh, EvqGlobal, 4, 2, true },
+	{ EbtFloat, EbpHigh, EvqIn, 2, 3, true },
+	{ EbtFloat, EbpHigh, EvqGlobal, 2, 3, true },
+	{ EbtFloat, EbpHigh, EvqGlobal, 4, 3, true },
+	{ EbtFloat, EbpHigh, EvqIn, 2, 4, true },
+	{ EbtFloat, EbpHigh, EvqGlobal, 2, 4, true },
+	{ EbtFloat, EbpHigh, EvqGlobal, 3, 4, true },
+	{ EbtFloat, EbpHigh, EvqIn, 4, 3, true },
+	{ EbtFloat, EbpHigh, EvqIn, 3, 4, true },
+	{ EbtBool, EbpHigh, EvqIn, 1, 2, false },
+	{ EbtBool, EbpHigh, EvqGlobal, 1, 1, false },
+	{ EbtBool, EbpHigh, EvqIn, 1, 3, false },
+	{ EbtBool, EbpHigh, EvqIn, 1, 4, false },
+	{ EbtSampler1D, EbpUndefined, EvqIn, 1, 1, false },
+	{ EbtSampler1DShadow, EbpLow, EvqIn, 1, 1, false },
+	{ EbtSampler2D, EbpUndefined, EvqIn, 1, 1, false },
+	{ EbtSampler2DShadow, EbpLow, EvqIn, 1, 1, false },
+	{ EbtSampler3D, EbpLow, EvqIn, 1, 1, false },
+	{ EbtSamplerCube, EbpUndefined, EvqIn, 1, 1, false },
+	{ EbtSamplerRect, EbpUndefined, EvqIn, 1, 1, false },
+	{ EbtSamplerRectShadow, EbpLow, EvqIn, 1, 1, false },
+	{ EbtSampler2DArray, EbpLow, EvqIn, 1, 1, false },
+	{ EbtSamplerGeneric, EbpUndefined, EvqIn, 1, 1, false },
+	{ EbtInt, EbpHigh, EvqGlobal, 1, 4, false },
+};
+
+static const TBuiltInParameter kBuiltInParameters[] = {
+	{ "degrees", 0 },
+	{ "degrees", 2 },
+	{ "degrees", 4 },
+	{ "degrees", 6 },
+	{ "degrees", 8 },
+	{ "degrees", 10 },
+	{ "degrees", 12 },
+	{ "radians", 0 },
+	{ "radians", 2 },
+	{ "radians", 4 },
+	{ "radians", 6 },
+	{ "radians", 8 },
+	{ "radians", 10 },
+	{ "radians", 12 },
+	{ "angle", 0 },
+	{ "angle", 2 },
+	{ "angle", 4 },
+	{ "angle", 6 },
+	{ "angle", 8 },
+	{ "angle", 10 },
+	{ "angle", 12 },
+	{ "x", 0 },
+	{ "x", 2 },
+	{ "x", 4 },
+	{ "x", 6 },
+	{ "x", 8 },
+	{ "x", 10 },
+	{ "x", 12 },
+	{ "y", 0 },
+	{ "x", 0 },
+	{ "y", 2 },
+	{ "x", 2 },
+	{ "y", 4 },
+	{ "x", 4 },
+	{ "y", 6 },
+	{ "x", 6 },
+	{ "y", 8 },
+	{ "x", 8 },
+	{ "y", 10 },
+	{ "x", 10 },
+	{ "y", 12 },
+	{ "x", 12 },
+	{ "y_over_x", 0 },
+	{ "y_over_x", 2 },
+	{ "y_over_x", 4 },
+	{ "y_over_x", 6 },
+	{ "y_over_x", 8 },
+	{ "y_over_x", 10 },
+	{ "y_over_x", 12 },
+	{ "x", 0 },
+	{ "y", 0 },
+	{ "x", 2 },
+	{ "y", 2 },
+	{ "x", 4 },
+	{ "y", 4 },
+	{ "x", 6 },
+	{ "y", 6 },
+	{ "x", 8 },
+	{ "y", 8 },
+	{ "x", 10 },
+	{ "y", 10 },
+	{ "x", 12 },
+	{ "y", 12 },
+	{ "x", 0 },
+	{ "minVal", 0 },
+	{ "maxVal", 0 },
+	{ "x", 2 },
+	{ "minVal", 2 },
+	{ "maxVal", 2 },
+	{ "x", 4 },
+	{ "minVal", 4 },
+	{ "maxVal", 4 },
+	{ "x", 6 },
+	{ "minVal", 6 },
+	{ "maxVal", 6 },
+	{ "x", 8 },
+	{ "minVal", 8 },
+	{ "maxVal", 8 },
+	{ "x", 10 },
+	{ "minVal", 10 },
+	{ "maxVal", 10 },
+	{ "x", 12 },
+	{ "minVal", 12 },
+	{ "maxVal", 12 },
+	{ "x", 0 },
+	{ "ip", 14 },
+	{ "x", 0 },
+	{ "ip", 15 },
+	{ "x", 2 },
+	{ "ip", 16 },
+	{ "x", 2 },
+	{ "ip", 17 },
+	{ "x", 4 },
+	{ "ip", 18 },
+	{ "x", 4 },
+	{ "ip", 19 },
+	{ "x", 6 },
+	{ "ip", 20 },
+	{ "x", 6 },
+	{ "ip", 21 },
+	{ "x", 0 },
+	{ "expon", 0 },
+	{ "x", 2 },
+	{ "expon", 2 },
+	{ "x", 4 },
+	{ "expon", 4 },
+	{ "x", 6 },
+	{ "expon", 6 },
+	{ "x", 8 },
+	{ "expon", 8 },
+	{ "x", 10 },
+	{ "expon", 10 },
+	{ "x", 12 },
+	{ "expon", 12 },
+	{ "x", 0 },
+	{ "s", 15 },
+	{ "c", 15 },
+	{ "x", 2 },
+	{ "s", 17 },
+	{ "c", 17 },
+	{ "x", 4 },
+	{ "s", 19 },
+	{ "c", 19 },
+	{ "x", 6 },
+	{ "s", 21 },
+	{ "c", 21 },
+	{ "x", 8 },
+	{ "s", 23 },
+	{ "c", 23 },
+	{ "x", 10 },
+	{ "s", 24 },
+	{ "c", 24 },
+	{ "x", 12 },
+	{ "s", 25 },
+	{ "c", 25 },
+	{ "x", 0 },
+	{ "y", 0 },
+	{ "a", 0 },
+	{ "x", 2 },
+	{ "y", 2 },
+	{ "a", 2 },
+	{ "x", 4 },
+	{ "y", 4 },
+	{ "a", 4 },
+	{ "x", 6 },
+	{ "y", 6 },
+	{ "a", 6 },
+	{ "x", 8 },
+	{ "y", 8 },
+	{ "a", 8 },
+	{ "x", 10 },
+	{ "y", 10 },
+	{ "a", 10 },
+	{ "x", 12 },
+	{ "y", 12 },
+	{ "a", 12 },
+	{ "edge", 0 },
+	{ "x", 0 },
+	{ "edge", 2 },
+	{ "x", 2 },
+	{ "edge", 4 },
+	{ "x", 4 },
+	{ "edge", 6 },
+	{ "x", 6 },
+	{ "edge", 8 },
+	{ "x", 8 },
+	{ "edge", 10 },
+	{ "x", 10 },
+	{ "edge", 12 },
+	{ "x", 12 },
+	{ "edge0", 0 },
+	{ "edge1", 0 },
+	{ "x", 0 },
+	{ "edge0", 2 },
+	{ "edge1", 2 },
+	{ "x", 2 },
+	{ "edge0", 4 },
+	{ "edge1", 4 },
+	{ "x", 4 },
+	{ "edge0", 6 },
+	{ "edge1", 6 },
+	{ "x", 6 },
+	{ "edge0", 8 },
+	{ "edge1", 8 },
+	{ "x", 8 },
+	{ "edge0", 10 },
+	{ "edge1", 10 },
+	{ "x", 10 },
+	{ "edge0", 12 },
+	{ "edge1", 12 },
+	{ "x", 12 },
+	{ "n_dot_l", 0 },
+	{ "n_dot_h", 0 },
+	{ "m", 0 },
+	{ "p0", 0 },
+	{ "p1", 0 },
+	{ "p0", 2 },
+	{ "p1", 2 },
+	{ "p0", 4 },
+	{ "p1", 4 },
+	{ "p0", 6 },
+	{ "p1", 6 },
+	{ "N", 0 },
+	{ "I", 0 },
+	{ "Nref", 0 },
+	{ "N", 2 },
+	{ "I", 2 },
+	{ "Nref", 2 },
+	{ "N", 4 },
+	{ "I", 4 },
+	{ "Nref", 4 },
+	{ "N", 6 },
+	{ "I", 6 },
+	{ "Nref", 6 },
+	{ "I", 0 },
+	{ "N", 0 },
+	{ "I", 2 },
+	{ "N", 2 },
+	{ "I", 4 },
+	{ "N", 4 },
+	{ "I", 6 },
+	{ "N", 6 },
+	{ "I", 0 },
+	{ "N", 0 },
+	{ "eta", 0 },
+	{ "I", 2 },
+	{ "N", 2 },
+	{ "eta", 0 },
+	{ "I", 4 },
+	{ "N", 4 },
+	{ "eta", 0 },
+	{ "I", 6 },
+	{ "N", 6 },
+	{ "eta", 0 },
+	{ "x", 2 },
+	{ "y", 0 },
+	{ "x", 2 },
+	{ "y", 8 },
+	{ "x", 2 },
+	{ "y", 26 },
+	{ "x", 2 },
+	{ "y", 27 },
+	{ "x", 0 },
+	{ "y", 8 },
+	{ "x", 8 },
+	{ "y", 0 },
+	{ "x", 8 },
+	{ "y", 2 },
+	{ "x", 8 },
+	{ "y", 26 },
+	{ "x", 8 },
+	{ "y", 27 },
+	{ "x", 0 },
+	{ "y", 30 },
+	{ "x", 30 },
+	{ "y", 0 },
+	{ "x", 30 },
+	{ "y", 2 },
+	{ "x", 30 },
+	{ "y", 8 },
+	{ "x", 30 },
+	{ "y", 26 },
+	{ "x", 30 },
+	{ "y", 27 },
+	{ "x", 0 },
+	{ "y", 33 },
+	{ "x", 33 },
+	{ "y", 0 },
+	{ "x", 33 },
+	{ "y", 2 },
+	{ "x", 33 },
+	{ "y", 8 },
+	{ "x", 33 },
+	{ "y", 26 },
+	{ "x", 33 },
+	{ "y", 27 },
+	{ "x", 0 },
+	{ "y", 4 },
+	{ "x", 4 },
+	{ "y", 0 },
+	{ "x", 4 },
+	{ "y", 30 },
+	{ "x", 4 },
+	{ "y", 10 },
+	{ "x", 4 },
+	{ "y", 36 },
+	{ "x", 0 },
+	{ "y", 26 },
+	{ "x", 26 },
+	{ "y", 0 },
+	{ "x", 26 },
+	{ "y", 4 },
+	{ "x", 26 },
+	{ "y", 30 },
+	{ "x", 26 },
+	{ "y", 10 },
+	{ "x", 26 },
+	{ "y", 36 },
+	{ "x", 0 },
+	{ "y", 10 },
+	{ "x", 10 },
+	{ "y", 0 },
+	{ "x", 10 },
+	{ "y", 4 },
+	{ "x", 10 },
+	{ "y", 30 },
+	{ "x", 10 },
+	{ "y", 36 },
+	{ "x", 0 },
+	{ "y", 37 },
+	{ "x", 37 },
+	{ "y", 0 },
+	{ "x", 37 },
+	{ "y", 4 },
+	{ "x", 37 },
+	{ "y", 30 },
+	{ "x", 37 },
+	{ "y", 10 },
+	{ "x", 37 },
+	{ "y", 36 },
+	{ "x", 0 },
+	{ "y", 6 },
+	{ "x", 6 },
+	{ "y", 0 },
+	{ "x", 6 },
+	{ "y", 33 },
+	{ "x", 6 },
+	{ "y", 37 },
+	{ "x", 6 },
+	{ "y", 12 },
+	{ "x", 0 },
+	{ "y", 27 },
+	{ "x", 27 },
+	{ "y", 0 },
+	{ "x", 27 },
+	{ "y", 6 },
+	{ "x", 27 },
+	{ "y", 33 },
+	{ "x", 27 },
+	{ "y", 37 },
+	{ "x", 27 },
+	{ "y", 12 },
+	{ "x", 0 },
+	{ "y", 36 },
+	{ "x", 36 },
+	{ "y", 0 },
+	{ "x", 36 },
+	{ "y", 6 },
+	{ "x", 36 },
+	{ "y", 33 },
+	{ "x", 36 },
+	{ "y", 37 },
+	{ "x", 36 },
+	{ "y", 12 },
+	{ "x", 0 },
+	{ "y", 12 },
+	{ "x", 12 },
+	{ "y", 6 },
+	{ "x", 12 },
+	{ "y", 33 },
+	{ "x", 12 },
+	{ "y", 37 },
+	{ "m", 8 },
+	{ "m", 10 },
+	{ "m", 12 },
+	{ "x", 38 },
+	{ "x", 40 },
+	{ "x", 41 },
+	{ "s", 42 },
+	{ "coord", 0 },
+	{ "s", 43 },
+	{ "coord", 2 },
+	{ "s", 42 },
+	{ "coord", 0 },
+	{ "ddx", 0 },
+	{ "ddy", 0 },
+	{ "s", 42 },
+	{ "coord", 6 },
+	{ "s", 43 },
+	{ "coord", 6 },
+	{ "s", 44 },
+	{ "coord", 2 },
+	{ "s", 45 },
+	{ "coord", 4 },
+	{ "s", 44 },
+	{ "coord", 2 },
+	{ "ddx", 2 },
+	{ "ddy", 2 },
+	{ "s", 44 },
+	{ "coord", 6 },
+	{ "s", 45 },
+	{ "coord", 6 },
+	{ "s", 44 },
+	{ "coord2", 2 },
+	{ "ddx", 2 },
+	{ "ddy", 2 },
+	{ "s", 46 },
+	{ "coord", 4 },
+	{ "s", 46 },
+	{ "coord", 4 },
+	{ "ddx", 4 },
+	{ "ddy", 4 },
+	{ "s", 46 },
+	{ "coord", 6 },
+	{ "s", 47 },
+	{ "coord", 4 },
+	{ "s", 47 },
+	{ "coord", 4 },
+	{ "ddx", 4 },
+	{ "ddy", 4 },
+	{ "s", 47 },
+	{ "coord", 6 },
+	{ "s", 48 },
+	{ "coord", 2 },
+	{ "s", 49 },
+	{ "coord", 4 },
+	{ "s", 48 },
+	{ "coord", 6 },
+	{ "s", 49 },
+	{ "coord", 6 },
+	{ "s", 48 },
+	{ "coord", 4 },
+	{ "s", 50 },
+	{ "coord", 4 },
+	{ "s", 50 },
+	{ "coord", 6 },
+	{ "s", 51 },
+	{ "coord", 0 },
+	{ "s", 51 },
+	{ "coord", 0 },
+	{ "ddx", 0 },
+	{ "ddy", 0 },
+	{ "s", 51 },
+	{ "coord", 6 },
+	{ "s", 51 },
+	{ "coord", 2 },
+	{ "s", 51 },
+	{ "coord", 2 },
+	{ "ddx", 2 },
+	{ "ddy", 2 },
+	{ "s", 51 },
+	{ "coord2", 2 },
+	{ "ddx", 2 },
+	{ "ddy", 2 },
+	{ "s", 51 },
+	{ "coord", 4 },
+	{ "s", 51 },
+	{ "coord", 4 },
+	{ "ddx", 4 },
+	{ "ddy", 4 },
+	{ "p", 0 },
+	{ "p", 2 },
+	{ "p", 4 },
+	{ "p", 6 },
+	{ "p", 8 },
+	{ "p", 10 },
+	{ "p", 12 },
+};
+
+// in unique ID order
+static const TBuiltInFunction kBuiltInFunctions[] = {
+	{ "radians", EOpRadians, 1, 0, 1, 1 },
+	{ "radians", EOpRadians, 3, 1, 1, 2 },
+	{ "radians", EOpRadians, 5, 2, 1, 3 },
+	{ "radians", EOpRadians, 7, 3, 1, 4 },
+	{ "radians", EOpRadians, 9, 4, 1, 5 },
+	{ "radians", EOpRadians, 11, 5, 1, 6 },
+	{ "radians", EOpRadians, 13, 6, 1, 7 },
+	{ "degrees", EOpDegrees, 1, 7, 1, 8 },
+	{ "degrees", EOpDegrees, 3, 8, 1, 9 },
+	{ "degrees", EOpDegrees, 5, 9, 1, 10 },
+	{ "degrees", EOpDegrees, 7, 10, 1, 11 },
+	{ "degrees", EOpDegrees, 9, 11, 1, 12 },
+	{ "degrees", EOpDegrees, 11, 12, 1, 13 },
+	{ "degrees", EOpDegrees, 13, 13, 1, 14 },
+	{ "sin", EOpSin, 1, 14, 1, 15 },
+	{ "sin", EOpSin, 3, 15, 1, 16 },
+	{ "sin", EOpSin, 5, 16, 1, 17 },
+	{ "sin", EOpSin, 7, 17, 1, 18 },
+	{ "sin", EOpSin, 9, 18, 1, 19 },
+	{ "sin", EOpSin, 11, 19, 1, 20 },
+	{ "sin", EOpSin, 13, 20, 1, 21 },
+	{ "cos", EOpCos, 1, 14, 1, 22 },
+	{ "cos", EOpCos, 3, 15, 1, 23 },
+	{ "cos", EOpCos, 5, 16, 1, 24 },
+	{ "cos", EOpCos, 7, 17, 1, 25 },
+	{ "cos", EOpCos, 9, 18, 1, 26 },
+	{ "cos", EOpCos, 11, 19, 1, 27 },
+	{ "cos", EOpCos, 13, 20, 1, 28 },
+	{ "tan", EOpTan, 1, 14, 1, 29 },
+	{ "tan", EOpTan, 3, 15, 1, 30 },
+	{ "tan", EOpTan, 5, 16, 1, 31 },
+	{ "tan", EOpTan, 7, 17, 1, 32 },
+	{ "tan", EOpTan, 9, 18, 1, 33 },
+	{ "tan", EOpTan, 11, 19, 1, 34 },
+	{ "tan", EOpTan, 13, 20, 1, 35 },
+	{ "asin", EOpAsin, 1, 21, 1, 36 },
+	{ "asin", EOpAsin, 3, 22, 1, 37 },
+	{ "asin", EOpAsin, 5, 23, 1, 38 },
+	{ "asin", EOpAsin, 7, 24, 1, 39 },
+	{ "asin", EOpAsin, 9, 25, 1, 40 },
+	{ "asin", EOpAsin, 11, 26, 1, 41 },
+	{ "asin", EOpAsin, 13, 27, 1, 42 },
+	{ "acos", EOpAcos, 1, 21, 1, 43 },
+	{ "acos", EOpAcos, 3, 22, 1, 44 },
+	{ "acos", EOpAcos, 5, 23, 1, 45 },
+	{ "acos", EOpAcos, 7, 24, 1, 46 },
+	{ "acos", EOpAcos, 9, 25, 1, 47 },
+	{ "acos", EOpAcos, 11, 26, 1, 48 },
+	{ "acos", EOpAcos, 13, 27, 1, 49 },
+	{ "atan2", EOpAtan2, 1, 28, 2, 50 },
+	{ "atan2", EOpAtan2, 3, 30, 2, 51 },
+	{ "atan2", EOpAtan2, 5, 32, 2, 52 },
+	{ "atan2", EOpAtan2, 7, 34, 2, 53 },
+	{ "atan2", EOpAtan2, 9, 36, 2, 54 },
+	{ "atan2", EOpAtan2, 11, 38, 2, 55 },
+	{ "atan2", EOpAtan2, 13, 40, 2, 56 },
+	{ "atan", EOpAtan, 1, 42, 1, 57 },
+	{ "atan", EOpAtan, 3, 43, 1, 58 },
+	{ "atan", EOpAtan, 5, 44, 1, 59 },
+	{ "atan", EOpAtan, 7, 45, 1, 60 },
+	{ "atan", EOpAtan, 9, 46, 1, 61 },
+	{ "atan", EOpAtan, 11, 47, 1, 62 },
+	{ "atan", EOpAtan, 13, 48, 1, 63 },
+	{ "pow", EOpPow, 1, 49, 2, 64 },
+	{ "pow", EOpPow, 3, 51, 2, 65 },
+	{ "pow", EOpPow, 5, 53, 2, 66 },
+	{ "pow", EOpPow, 7, 55, 2, 67 },
+	{ "pow", EOpPow, 9, 57, 2, 68 },
+	{ "pow", EOpPow, 11, 59, 2, 69 },
+	{ "pow", EOpPow, 13, 61, 2, 70 },
+	{ "exp", EOpExp, 1, 21, 1, 71 },
+	{ "exp", EOpExp, 3, 22, 1, 72 },
+	{ "exp", EOpExp, 5, 23, 1, 73 },
+	{ "exp", EOpExp, 7, 24, 1, 74 },
+	{ "exp", EOpExp, 9, 25, 1, 75 },
+	{ "exp", EOpExp, 11, 26, 1, 76 },
+	{ "exp", EOpExp, 13, 27, 1, 77 },
+	{ "log", EOpLog, 1, 21, 1, 78 },
+	{ "log", EOpLog, 3, 22, 1, 79 },
+	{ "log", EOpLog, 5, 23, 1, 80 },
+	{ "log", EOpLog, 7, 24, 1, 81 },
+	{ "log", EOpLog, 9, 25, 1, 82 },
+	{ "log", EOpLog, 11, 26, 1, 83 },
+	{ "log", EOpLog, 13, 27, 1, 84 },
+	{ "exp2", EOpExp2, 1, 21, 1, 85 },
+	{ "exp2", EOpExp2, 3, 22, 1, 86 },
+	{ "exp2", EOpExp2, 5, 23, 1, 87 },
+	{ "exp2", EOpExp2, 7, 24, 1, 88 },
+	{ "exp2", EOpExp2, 9, 25, 1, 89 },
+	{ "exp2", EOpExp2, 11, 26, 1, 90 },
+	{ "exp2", EOpExp2, 13, 27, 1, 91 },
+	{ "log2", EOpLog2, 1, 21, 1, 92 },
+	{ "log2", EOpLog2, 3, 22, 1, 93 },
+	{ "log2", EOpLog2, 5, 23, 1, 94 },
+	{ "log2", EOpLog2, 7, 24, 1, 95 },
+	{ "log2", EOpLog2, 9, 25, 1, 96 },
+	{ "log2", EOpLog2, 11, 26, 1, 97 },
+	{ "log2", EOpLog2, 13, 27, 1, 98 },
+	{ "log10", EOpLog10, 1, 21, 1, 99 },
+	{ "log10", EOpLog10, 3, 22, 1, 100 },
+	{ "log10", EOpLog10, 5, 23, 1, 101 },
+	{ "log10", EOpLog10, 7, 24, 1, 102 },
+	{ "log10", EOpLog10, 9, 25, 1, 103 },
+	{ "log10", EOpLog10, 11, 26, 1, 104 },
+	{ "log10", EOpLog10, 13, 27, 1, 105 },
+	{ "sqrt", EOpSqrt, 1, 21, 1, 106 },
+	{ "sqrt", EOpSqrt, 3, 22, 1, 107 },
+	{ "sqrt", EOpSqrt, 5, 23, 1, 108 },
+	{ "sqrt", EOpSqrt, 7, 24, 1, 109 },
+	{ "sqrt", EOpSqrt, 9, 25, 1, 110 },
+	{ "sqrt", EOpSqrt, 11, 26, 1, 111 },
+	{ "sqrt", EOpSqrt, 13, 27, 1, 112 },
+	{ "rsqrt", EOpInverseSqrt, 1, 21, 1, 113 },
+	{ "rsqrt", EOpInverseSqrt, 3, 22, 1, 114 },
+	{ "rsqrt", EOpInverseSqrt, 5, 23, 1, 115 },
+	{ "rsqrt", EOpInverseSqrt, 7, 24, 1, 116 },
+	{ "rsqrt", EOpInverseSqrt, 9, 25, 1, 117 },
+	{ "rsqrt", EOpInverseSqrt, 11, 26, 1, 118 },
+	{ "rsqrt", EOpInverseSqrt, 13, 27, 1, 119 },
+	{ "abs", EOpAbs, 1, 21, 1, 120 },
+	{ "abs", EOpAbs, 3, 22, 1, 121 },
+	{ "abs", EOpAbs, 5, 23, 1, 122 },
+	{ "abs", EOpAbs, 7, 24, 1, 123 },
+	{ "abs", EOpAbs, 9, 25, 1, 124 },
+	{ "abs", EOpAbs, 11, 26, 1, 125 },
+	{ "abs", EOpAbs, 13, 27, 1, 126 },
+	{ "sign", EOpSign, 1, 21, 1, 127 },
+	{ "sign", EOpSign, 3, 22, 1, 128 },
+	{ "sign", EOpSign, 5, 23, 1, 129 },
+	{ "sign", EOpSign, 7, 24, 1, 130 },
+	{ "sign", EOpSign, 9, 25, 1, 131 },
+	{ "sign", EOpSign, 11, 26, 1, 132 },
+	{ "sign", EOpSign, 13, 27, 1, 133 },
+	{ "floor", EOpFloor, 1, 21, 1, 134 },
+	{ "floor", EOpFloor, 3, 22, 1, 135 },
+	{ "floor", EOpFloor, 5, 23, 1, 136 },
+	{ "floor", EOpFloor, 7, 24, 1, 137 },
+	{ "floor", EOpFloor, 9, 25, 1, 138 },
+	{ "floor", EOpFloor, 11, 26, 1, 139 },
+	{ "floor", EOpFloor, 13, 27, 1, 140 },
+	{ "ceil", EOpCeil, 1, 21, 1, 141 },
+	{ "ceil", EOpCeil, 3, 22, 1, 142 },
+	{ "ceil", EOpCeil, 5, 23, 1, 143 },
+	{ "ceil", EOpCeil, 7, 24, 1, 144 },
+	{ "ceil", EOpCeil, 9, 25, 1, 145 },
+	{ "ceil", EOpCeil, 11, 26, 1, 146 },
+	{ "ceil", EOpCeil, 13, 27, 1, 147 },
+	{ "frac", EOpFract, 1, 21, 1, 148 },
+	{ "frac", EOpFract, 3, 22, 1, 149 },
+	{ "frac", EOpFract, 5, 23, 1, 150 },
+	{ "frac", EOpFract, 7, 24, 1, 151 },
+	{ "frac", EOpFract, 9, 25, 1, 152 },
+	{ "frac", EOpFract, 11, 26, 1, 153 },
+	{ "frac", EOpFract, 13, 27, 1, 154 },
+	{ "fmod", EOpMod, 1, 49, 2, 155 },
+	{ "fmod", EOpMod, 3, 51, 2, 156 },
+	{ "fmod", EOpMod, 5, 53, 2, 157 },
+	{ "fmod", EOpMod, 7, 55, 2, 158 },
+	{ "min", EOpMin, 1, 49, 2, 159 },
+	{ "min", EOpMin, 3, 51, 2, 160 },
+	{ "min", EOpMin, 5, 53, 2, 161 },
+	{ "min", EOpMin, 7, 55, 2, 162 },
+	{ "min", EOpMin, 9, 57, 2, 163 },
+	{ "min", EOpMin, 11, 59, 2, 164 },
+	{ "min", EOpMin, 13, 61, 2, 165 },
+	{ "max", EOpMax, 1, 49, 2, 166 },
+	{ "max", EOpMax, 3, 51, 2, 167 },
+	{ "max", EOpMax, 5, 53, 2, 168 },
+	{ "max", EOpMax, 7, 55, 2, 169 },
+	{ "max", EOpMax, 9, 57, 2, 170 },
+	{ "max", EOpMax, 11, 59, 2, 171 },
+	{ "max", EOpMax, 13, 61, 2, 172 },
+	{ "clamp", EOpClamp, 1, 63, 3, 173 },
+	{ "clamp", EOpClamp, 3, 66, 3, 174 },
+	{ "clamp", EOpClamp, 5, 69, 3, 175 },
+	{ "clamp", EOpClamp, 7, 72, 3, 176 },
+	{ "clamp", EOpClamp, 9, 75, 3, 177 },
+	{ "clamp", EOpClamp, 11, 78, 3, 178 },
+	{ "clamp", EOpClamp, 13, 81, 3, 179 },
+	{ "saturate", EOpSaturate, 1, 21, 1, 180 },
+	{ "saturate", EOpSaturate, 3, 22, 1, 181 },
+	{ "saturate", EOpSaturate, 5, 23, 1, 182 },
+	{ "saturate", EOpSaturate, 7, 24, 1, 183 },
+	{ "saturate", EOpSaturate, 9, 25, 1, 184 },
+	{ "saturate", EOpSaturate, 11, 26, 1, 185 },
+	{ "saturate", EOpSaturate, 13, 27, 1, 186 },
+	{ "modf", EOpModf, 1, 84, 2, 187 },
+	{ "modf", EOpModf, 1, 86, 2, 188 },
+	{ "modf", EOpModf, 3, 88, 2, 189 },
+	{ "modf", EOpModf, 3, 90, 2, 190 },
+	{ "modf", EOpModf, 5, 92, 2, 191 },
+	{ "modf", EOpModf, 5, 94, 2, 192 },
+	{ "modf", EOpModf, 7, 96, 2, 193 },
+	{ "modf", EOpModf, 7, 98, 2, 194 },
+	{ "round", EOpRound, 1, 21, 1, 195 },
+	{ "round", EOpRound, 3, 22, 1, 196 },
+	{ "round", EOpRound, 5, 23, 1, 197 },
+	{ "round", EOpRound, 7, 24, 1, 198 },
+	{ "trunc", EOpTrunc, 1, 21, 1, 199 },
+	{ "trunc", EOpTrunc, 3, 22, 1, 200 },
+	{ "trunc", EOpTrunc, 5, 23, 1, 201 },
+	{ "trunc", EOpTrunc, 7, 24, 1, 202 },
+	{ "ldexp", EOpLdexp, 1, 100, 2, 203 },
+	{ "ldexp", EOpLdexp, 3, 102, 2, 204 },
+	{ "ldexp", EOpLdexp, 5, 104, 2, 205 },
+	{ "ldexp", EOpLdexp, 7, 106, 2, 206 },
+	{ "ldexp", EOpLdexp, 9, 108, 2, 207 },
+	{ "ldexp", EOpLdexp, 11, 110, 2, 208 },
+	{ "ldexp", EOpLdexp, 13, 112, 2, 209 },
+	{ "sincos", EOpSinCos, 22, 114, 3, 210 },
+	{ "sincos", EOpSinCos, 22, 117, 3, 211 },
+	{ "sincos", EOpSinCos, 22, 120, 3, 212 },
+	{ "sincos", EOpSinCos, 22, 123, 3, 213 },
+	{ "sincos", EOpSinCos, 22, 126, 3, 214 },
+	{ "sincos", EOpSinCos, 22, 129, 3, 215 },
+	{ "sincos", EOpSinCos, 22, 132, 3, 216 },
+	{ "lerp", EOpMix, 1, 135, 3, 217 },
+	{ "lerp", EOpMix, 3, 138, 3, 218 },
+	{ "lerp", EOpMix, 5, 141, 3, 219 },
+	{ "lerp", EOpMix, 7, 144, 3, 220 },
+	{ "lerp", EOpMix, 9, 147, 3, 221 },
+	{ "lerp", EOpMix, 11, 150, 3, 222 },
+	{ "lerp", EOpMix, 13, 153, 3, 223 },
+	{ "step", EOpStep, 1, 156, 2, 224 },
+	{ "step", EOpStep, 3, 158, 2, 225 },
+	{ "step", EOpStep, 5, 160, 2, 226 },
+	{ "step", EOpStep, 7, 162, 2, 227 },
+	{ "step", EOpStep, 9, 164, 2, 228 },
+	{ "step", EOpStep, 11, 166, 2, 229 },
+	{ "step", EOpStep, 13, 168, 2, 230 },
+	{ "smoothstep", EOpSmoothStep, 1, 170, 3, 231 },
+	{ "smoothstep", EOpSmoothStep, 3, 173, 3, 232 },
+	{ "smoothstep", EOpSmoothStep, 5, 176, 3, 233 },
+	{ "smoothstep", EOpSmoothStep, 7, 179, 3, 234 },
+	{ "smoothstep", EOpSmoothStep, 9, 182, 3, 235 },
+	{ "smoothstep", EOpSmoothStep, 11, 185, 3, 236 },
+	{ "smoothstep", EOpSmoothStep, 13, 188, 3, 237 },
+	{ "lit", EOpLit, 7, 191, 3, 238 },
+	{ "length", EOpLength, 1, 21, 1, 239 },
+	{ "length", EOpLength, 1, 22, 1, 240 },
+	{ "length", EOpLength, 1, 23, 1, 241 },
+	{ "length", EOpLength, 1, 24, 1, 242 },
+	{ "distance", EOpDistance, 1, 194, 2, 243 },
+	{ "distance", EOpDistance, 1, 196, 2, 244 },
+	{ "distance", EOpDistance, 1, 198, 2, 245 },
+	{ "distance", EOpDistance, 1, 200, 2, 246 },
+	{ "dot", EOpDot, 1, 49, 2, 247 },
+	{ "dot", EOpDot, 1, 51, 2, 248 },
+	{ "dot", EOpDot, 1, 53, 2, 249 },
+	{ "dot", EOpDot, 1, 55, 2, 250 },
+	{ "cross", EOpCross, 5, 53, 2, 251 },
+	{ "normalize", EOpNormalize, 1, 21, 1, 252 },
+	{ "normalize", EOpNormalize, 3, 22, 1, 253 },
+	{ "normalize", EOpNormalize, 5, 23, 1, 254 },
+	{ "normalize", EOpNormalize, 7, 24, 1, 255 },
+	{ "faceforward", EOpFaceForward, 1, 202, 3, 256 },
+	{ "faceforward", EOpFaceForward, 3, 205, 3, 257 },
+	{ "faceforward", EOpFaceForward, 5, 208, 3, 258 },
+	{ "faceforward", EOpFaceForward, 7, 211, 3, 259 },
+	{ "reflect", EOpReflect, 1, 214, 2, 260 },
+	{ "reflect", EOpReflect, 3, 216, 2, 261 },
+	{ "reflect", EOpReflect, 5, 218, 2, 262 },
+	{ "reflect", EOpReflect, 7, 220, 2, 263 },
+	{ "refract", EOpRefract, 1, 222, 3, 264 },
+	{ "refract", EOpRefract, 3, 225, 3, 265 },
+	{ "refract", EOpRefract, 5, 228, 3, 266 },
+	{ "refract", EOpRefract, 7, 231, 3, 267 },
+	{ "mul", EOpMul, 3, 29, 2, 268 },
+	{ "mul", EOpMul, 3, 234, 2, 269 },
+	{ "mul", EOpMul, 1, 51, 2, 270 },
+	{ "mul", EOpMul, 3, 236, 2, 271 },
+	{ "mul", EOpMul, 5, 238, 2, 272 },
+	{ "mul", EOpMul, 7, 240, 2, 273 },
+	{ "mul", EOpMul, 9, 242, 2, 274 },
+	{ "mul", EOpMul, 9, 244, 2, 275 },
+	{ "mul", EOpMul, 3, 246, 2, 276 },
+	{ "mul", EOpMul, 9, 57, 2, 277 },
+	{ "mul", EOpMul, 28, 248, 2, 278 },
+	{ "mul", EOpMul, 29, 250, 2, 279 },
+	{ "mul", EOpMul, 31, 252, 2, 280 },
+	{ "mul", EOpMul, 31, 254, 2, 281 },
+	{ "mul", EOpMul, 5, 256, 2, 282 },
+	{ "mul", EOpMul, 31, 258, 2, 283 },
+	{ "mul", EOpMul, 11, 260, 2, 284 },
+	{ "mul", EOpMul, 32, 262, 2, 285 },
+	{ "mul", EOpMul, 34, 264, 2, 286 },
+	{ "mul", EOpMul, 34, 266, 2, 287 },
+	{ "mul", EOpMul, 7, 268, 2, 288 },
+	{ "mul", EOpMul, 34, 270, 2, 289 },
+	{ "mul", EOpMul, 35, 272, 2, 290 },
+	{ "mul", EOpMul, 13, 274, 2, 291 },
+	{ "mul", EOpMul, 5, 276, 2, 292 },
+	{ "mul", EOpMul, 5, 278, 2, 293 },
+	{ "mul", EOpMul, 1, 53, 2, 294 },
+	{ "mul", EOpMul, 3, 280, 2, 295 },
+	{ "mul", EOpMul, 5, 282, 2, 296 },
+	{ "mul", EOpMul, 7, 284, 2, 297 },
+	{ "mul", EOpMul, 28, 286, 2, 298 },
+	{ "mul", EOpMul, 28, 288, 2, 299 },
+	{ "mul", EOpMul, 3, 290, 2, 300 },
+	{ "mul", EOpMul, 9, 292, 2, 301 },
+	{ "mul", EOpMul, 28, 294, 2, 302 },
+	{ "mul", EOpMul, 29, 296, 2, 303 },
+	{ "mul", EOpMul, 11, 298, 2, 304 },
+	{ "mul", EOpMul, 11, 300, 2, 305 },
+	{ "mul", EOpMul, 5, 302, 2, 306 },
+	{ "mul", EOpMul, 31, 304, 2, 307 },
+	{ "mul", EOpMul, 11, 59, 2, 308 },
+	{ "mul", EOpMul, 32, 306, 2, 309 },
+	{ "mul", EOpMul, 35, 308, 2, 310 },
+	{ "mul", EOpMul, 35, 310, 2, 311 },
+	{ "mul", EOpMul, 7, 312, 2, 312 },
+	{ "mul", EOpMul, 34, 314, 2, 313 },
+	{ "mul", EOpMul, 35, 316, 2, 314 },
+	{ "mul", EOpMul, 13, 318, 2, 315 },
+	{ "mul", EOpMul, 7, 320, 2, 316 },
+	{ "mul", EOpMul, 7, 322, 2, 317 },
+	{ "mul", EOpMul, 1, 55, 2, 318 },
+	{ "mul", EOpMul, 3, 324, 2, 319 },
+	{ "mul", EOpMul, 5, 326, 2, 320 },
+	{ "mul", EOpMul, 7, 328, 2, 321 },
+	{ "mul", EOpMul, 29, 330, 2, 322 },
+	{ "mul", EOpMul, 29, 332, 2, 323 },
+	{ "mul", EOpMul, 3, 334, 2, 324 },
+	{ "mul", EOpMul, 9, 336, 2, 325 },
+	{ "mul", EOpMul, 28, 338, 2, 326 },
+	{ "mul", EOpMul, 29, 340, 2, 327 },
+	{ "mul", EOpMul, 32, 342, 2, 328 },
+	{ "mul", EOpMul, 32, 344, 2, 329 },
+	{ "mul", EOpMul, 5, 346, 2, 330 },
+	{ "mul", EOpMul, 31, 348, 2, 331 },
+	{ "mul", EOpMul, 11, 350, 2, 332 },
+	{ "mul", EOpMul, 32, 352, 2, 333 },
+	{ "mul", EOpMul, 13, 354, 2, 334 },
+	{ "mul", EOpMul, 13, 27, 2, 335 },
+	{ "mul", EOpMul, 7, 356, 2, 336 },
+	{ "mul", EOpMul, 34, 358, 2, 337 },
+	{ "mul", EOpMul, 35, 360, 2, 338 },
+	{ "mul", EOpMul, 13, 61, 2, 339 },
+	{ "transpose", EOpTranspose, 9, 362, 1, 340 },
+	{ "transpose", EOpTranspose, 11, 363, 1, 341 },
+	{ "transpose", EOpTranspose, 13, 364, 1, 342 },
+	{ "determinant", EOpDeterminant, 1, 362, 1, 343 },
+	{ "determinant", EOpDeterminant, 1, 363, 1, 344 },
+	{ "determinant", EOpDeterminant, 1, 364, 1, 345 },
+	{ "any", EOpAny, 39, 365, 1, 347 },
+	{ "any", EOpAny, 39, 366, 1, 348 },
+	{ "any", EOpAny, 39, 367, 1, 349 },
+	{ "all", EOpAll, 39, 365, 1, 350 },
+	{ "all", EOpAll, 39, 366, 1, 351 },
+	{ "all", EOpAll, 39, 367, 1, 352 },
+	{ "tex1D", EOpTex1D, 7, 368, 2, 353 },
+	{ "tex1D", EOpTex1D, 7, 370, 2, 354 },
+	{ "tex1D", EOpTex1D, 7, 372, 4, 355 },
+	{ "tex1Dproj", EOpTex1DProj, 7, 376, 2, 356 },
+	{ "tex1Dproj", EOpTex1DProj, 7, 378, 2, 357 },
+	{ "tex1Dbias", EOpTex1DBias, 7, 376, 2, 358 },
+	{ "tex1Dlod", EOpTex1DLod, 7, 376, 2, 359 },
+	{ "tex1Dgrad", EOpTex1DGrad, 7, 372, 4, 360 },
+	{ "tex2D", EOpTex2D, 7, 380, 2, 361 },
+	{ "tex2D", EOpTex2D, 7, 382, 2, 362 },
+	{ "tex2D", EOpTex2D, 7, 384, 4, 363 },
+	{ "tex2Dproj", EOpTex2DProj, 7, 388, 2, 364 },
+	{ "tex2Dproj", EOpTex2DProj, 7, 390, 2, 365 },
+	{ "tex2Dbias", EOpTex2DBias, 7, 388, 2, 366 },
+	{ "tex2Dlod", EOpTex2DLod, 7, 388, 2, 367 },
+	{ "tex2Dgrad", EOpTex2DGrad, 7, 392, 4, 368 },
+	{ "tex3D", EOpTex3D, 7, 396, 2, 369 },
+	{ "tex3D", EOpTex3D, 7, 398, 4, 370 },
+	{ "tex3Dproj", EOpTex3DProj, 7, 402, 2, 371 },
+	{ "tex3Dbias", EOpTex3DBias, 7, 402, 2, 372 },
+	{ "tex3Dlod", EOpTex3DLod, 7, 402, 2, 373 },
+	{ "tex3Dgrad", EOpTex3DGrad, 7, 398, 4, 374 },
+	{ "texCUBE", EOpTexCube, 7, 404, 2, 375 },
+	{ "texCUBE", EOpTexCube, 7, 406, 4, 376 },
+	{ "texCUBEproj", EOpTexCubeProj, 7, 410, 2, 377 },
+	{ "texCUBEbias", EOpTexCubeBias, 7, 410, 2, 378 },
+	{ "texCUBElod", EOpTexCubeLod, 7, 410, 2, 379 },
+	{ "texCUBEgrad", EOpTexCubeGrad, 7, 406, 4, 380 },
+	{ "texRECT", EOpTexRect, 7, 412, 2, 381 },
+	{ "texRECT", EOpTexRect, 7, 414, 2, 382 },
+	{ "texRECTproj", EOpTexRectProj, 7, 416, 2, 383 },
+	{ "texRECTproj", EOpTexRectProj, 7, 418, 2, 384 },
+	{ "texRECTproj", EOpTexRectProj, 7, 420, 2, 385 },
+	{ "shadow2D", EOpShadow2D, 1, 382, 2, 386 },
+	{ "shadow2Dproj", EOpShadow2DProj, 1, 390, 2, 387 },
+	{ "tex2DArray", EOpTex2DArray, 7, 422, 2, 388 },
+	{ "tex2DArraylod", EOpTex2DArrayLod, 7, 424, 2, 389 },
+	{ "tex2DArraybias", EOpTex2DArrayBias, 7, 424, 2, 390 },
+	{ "tex1D", EOpTex1D, 7, 426, 2, 391 },
+	{ "tex1D", EOpTex1D, 7, 428, 4, 392 },
+	{ "tex1Dproj", EOpTex1DProj, 7, 432, 2, 393 },
+	{ "tex1Dbias", EOpTex1DBias, 7, 432, 2, 394 },
+	{ "tex1Dlod", EOpTex1DLod, 7, 432, 2, 395 },
+	{ "tex1Dgrad", EOpTex1DGrad, 7, 428, 4, 396 },
+	{ "tex2D", EOpTex2D, 7, 434, 2, 397 },
+	{ "tex2D", EOpTex2D, 7, 436, 4, 398 },
+	{ "tex2Dproj", EOpTex2DProj, 7, 432, 2, 399 },
+	{ "tex2Dbias", EOpTex2DBias, 7, 432, 2, 400 },
+	{ "tex2Dlod", EOpTex2DLod, 7, 432, 2, 401 },
+	{ "tex2Dgrad", EOpTex2DGrad, 7, 440, 4, 402 },
+	{ "tex3D", EOpTex3D, 7, 444, 2, 403 },
+	{ "tex3D", EOpTex3D, 7, 446, 4, 404 },
+	{ "tex3Dproj", EOpTex3DProj, 7, 432, 2, 405 },
+	{ "tex3Dbias", EOpTex3DBias, 7, 432, 2, 406 },
+	{ "tex3Dlod", EOpTex3DLod, 7, 432, 2, 407 },
+	{ "tex3Dgrad", EOpTex3DGrad, 7, 446, 4, 408 },
+	{ "texCUBE", EOpTexCube, 7, 444, 2, 409 },
+	{ "texCUBE", EOpTexCube, 7, 446, 4, 410 },
+	{ "texCUBEproj", EOpTexCubeProj, 7, 432, 2, 411 },
+	{ "texCUBEbias", EOpTexCubeBias, 7, 432, 2, 412 },
+	{ "texCUBElod", EOpTexCubeLod, 7, 432, 2, 413 },
+	{ "texCUBEgrad", EOpTexCubeGrad, 7, 446, 4, 414 },
+	{ "texRECT", EOpTexRect, 7, 434, 2, 415 },
+	{ "texRECTproj", EOpTexRectProj, 7, 432, 2, 416 },
+	{ "texRECTproj", EOpTexRectProj, 7, 444, 2, 417 },
+	{ "noise", EOpNull, 1, 21, 1, 418 },
+	{ "noise", EOpNull, 1, 22, 1, 419 },
+	{ "noise", EOpNull, 1, 23, 1, 420 },
+	{ "noise", EOpNull, 1, 24, 1, 421 },
+	{ "ddx", EOpDPdx, 1, 450, 1, 422 },
+	{ "ddx", EOpDPdx, 3, 451, 1, 423 },
+	{ "ddx", EOpDPdx, 5, 452, 1, 424 },
+	{ "ddx", EOpDPdx, 7, 453, 1, 425 },
+	{ "ddx", EOpDPdx, 9, 454, 1, 426 },
+	{ "ddx", EOpDPdx, 11, 455, 1, 427 },
+	{ "ddx", EOpDPdx, 13, 456, 1, 428 },
+	{ "ddy", EOpDPdy, 1, 450, 1, 429 },
+	{ "ddy", EOpDPdy, 3, 451, 1, 430 },
+	{ "ddy", EOpDPdy, 5, 452, 1, 431 },
+	{ "ddy", EOpDPdy, 7, 453, 1, 432 },
+	{ "ddy", EOpDPdy, 9, 454, 1, 433 },
+	{ "ddy", EOpDPdy, 11, 455, 1, 434 },
+	{ "ddy", EOpDPdy, 13, 456, 1, 435 },
+	{ "fwidth", EOpFwidth, 1, 450, 1, 436 },
+	{ "fwidth", EOpFwidth, 3, 451, 1, 437 },
+	{ "fwidth", EOpFwidth, 5, 452, 1, 438 },
+	{ "fwidth", EOpFwidth, 7, 453, 1, 439 },
+	{ "fwidth", EOpFwidth, 9, 454, 1, 440 },
+	{ "fwidth", EOpFwidth, 11, 455, 1, 441 },
+	{ "fwidth", EOpFwidth, 13, 456, 1, 442 },
+	{ "D3DCOLORtoUBYTE4", EOpD3DCOLORtoUBYTE4, 52, 24, 1, 443 },
+	{ "clip", EOpFclip, 22, 21, 1, 444 },
+	{ "clip", EOpFclip, 22, 22, 1, 445 },
+	{ "clip", EOpFclip, 22, 23, 1, 446 },
+	{ "clip", EOpFclip, 22, 24, 1, 447 },
+};
+
+#endif // _BUILT_IN_SYMBOLS_INCLUDED_
@@ -0,0 +1,26 @@
+# Writes OUTPUT, a header defining HLSL2GLSL_CACHE_FINGERPRINT as a hash of the library
+# sources in SOURCE_DIR. The translation cache puts it in every key, so that results stored
+# by a different build of the library are never used.
+#
+#   cmake -DSOURCE_DIR=<repo> -DOUTPUT=<header> -P CacheFingerprint.cmake
+
+file(GLOB_RECURSE FINGERPRINT_SOURCES
+  ${SOURCE_DIR}/include/*.h
+  ${SOURCE_DIR}/hlslang/*.h
+  ${SOURCE_DIR}/hlslang/*.cpp
+  ${SOURCE_DIR}/hlslang/*.y
+)
+list(SORT FINGERPRINT_SOURCES)
+
+set(FINGERPRINT_DATA "")
+foreach(file ${FINGERPRINT_SOURCES})
+  # bison output is generated from hlslang.y, which is hashed already
+  if (NOT file MATCHES "hlslang_tab\\.")
+    file(RELATIVE_PATH name ${SOURCE_DIR} ${file})
+    file(SHA1 ${file} hash)
+    set(FINGERPRINT_DATA "${FINGERPRINT_DATA}${name} ${hash}\n")
+  endif ()
+endforeach()
+string(SHA1 FINGERPRINT ${FINGERPRINT_DATA})
+
+file(WRITE ${OUTPUT} "// Generated by CacheFingerprint.cmake, do not edit.\n#define HLSL2GLSL_CACHE_FINGERPRINT \"${FINGERPRINT}\"\n")
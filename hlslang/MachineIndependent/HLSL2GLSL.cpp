@@ -3,9 +3,11 @@
 // found in the LICENSE.txt file.
 
 
+#include <string.h>
+#include <map>
+
 #include "SymbolTable.h"
 #include "ParseHelper.h"
-#include "RemoveTree.h"
 
 #include "../../include/hlsl2glsl.h"
 #include "Initialize.h"
@@ -15,7 +17,8 @@
 #include "../GLSLCodeGen/hlslLinker.h"
 
 #include "../Include/InitializeGlobals.h"
-#include "../Include/InitializeParseContext.h"
+#include "TranslationCache.h"
+#include "IncludeCache.h"
 #include "osinclude.h"
 
 
@@ -40,9 +43,6 @@ static bool InitThread()
 	// initialize per-thread data
 	InitializeGlobalPools();
 	
-	if (!InitializeGlobalParseContext())
-		return false;
-	
 	if (!OS_SetTLSValue(s_ThreadInitialized, (void *)1))
 	{
 		assert(0 && "InitThread(): Unable to set init flag.");
@@ -70,12 +70,6 @@ static bool InitProcess()
 		return false;
 	}
 	
-	if (!InitializeParseContextIndex())
-	{
-		assert(0 && "InitProcess(): Failed to initalize parse context");
-		return false;
-	}
-	
 	InitThread();
 	return true;
 }
@@ -97,9 +91,6 @@ static bool DetachThread()
 	
 	FreeGlobalPools();
 	
-	if (!FreeParseContext())
-		success = false;
-	
 	return success;
 }
 
@@ -118,134 +109,30 @@ TSymbolTable SymbolTables[EShLangCount];
 TPoolAllocator* PerProcessGPA = 0;
 
 
-/// Initializize the symbol table
-/// \param BuiltInStrings
-///      Pointer to built in strings.
-/// \param language
-///      Shading language to initialize symbol table for
-/// \param infoSink
-///      Information sink (for errors/warnings)
-/// \param symbolTables
-///      Array of symbol tables (one for each language)
-/// \param bUseGlobalSymbolTable
-///      Whether to use the global symbol table or the per-language symbol table
-/// \return
-///      True if succesfully initialized, false otherwise
-static bool InitializeSymbolTable( TBuiltInStrings* BuiltInStrings, EShLanguage language, TInfoSink& infoSink, 
-                            TSymbolTable* symbolTables, bool bUseGlobalSymbolTable )
-{
-   TSymbolTable* symbolTable;
-
-   if ( bUseGlobalSymbolTable )
-      symbolTable = symbolTables;
-   else
-      symbolTable = &symbolTables[language];
-
-	//@TODO: for now, we use same global symbol table for all target language versions.
-	// This is wrong and will have to be changed at some point.
-	TParseContext parseContext(*symbolTable, language, ETargetVersionCount, 0, infoSink);
-
-   GlobalParseContext = &parseContext;
-
-   setInitialState();
-
-   assert(symbolTable->isEmpty() || symbolTable->atSharedBuiltInLevel());
-
-   //
-   // Parse the built-ins.  This should only happen once per
-   // language symbol table.
-   //
-   // Push the symbol table to give it an initial scope.  This
-   // push should not have a corresponding pop, so that built-ins
-   // are preserved, and the test for an empty table fails.
-   //
-
-   symbolTable->push();
-
-   for (TBuiltInStrings::iterator i  = BuiltInStrings[parseContext.language].begin();
-       i != BuiltInStrings[parseContext.language].end();
-       ++i)
-   {
-      const char* builtInShaders = (*i).c_str();
-
-      if (PaParseString(const_cast<char*>(builtInShaders), parseContext, NULL) != 0)
-      {
-         infoSink.info.message(EPrefixInternalError, "Unable to parse built-ins");
-         return false;
-      }
-   }
-
-   if (  !bUseGlobalSymbolTable )
-   {
-      IdentifyBuiltIns(parseContext.language, *symbolTable);
-   }
-
-   return true;
-}
-
-
-/// Generate the built in symbol table
-/// \param infoSink
-///      Information sink (for errors/warnings)
-/// \param symbolTables
-///      Array of symbol tables (one for each language)
-/// \param bUseGlobalSymbolTable
-///      Whether to use the global symbol table or the per-language symbol table
-/// \param language
-///      Shading language to build symbol table for
-/// \return
-///      True if succesfully built, false otherwise
-static bool GenerateBuiltInSymbolTable(TInfoSink& infoSink, TSymbolTable* symbolTables, EShLanguage language)
-{
-   TBuiltIns builtIns;
-
-   if ( language != EShLangCount )
-   {      
-      InitializeSymbolTable(builtIns.getBuiltInStrings(), language, infoSink, symbolTables, true);
-   }
-   else
-   {
-      builtIns.initialize();
-      InitializeSymbolTable(builtIns.getBuiltInStrings(), EShLangVertex, infoSink, symbolTables, false);
-      InitializeSymbolTable(builtIns.getBuiltInStrings(), EShLangFragment, infoSink, symbolTables, false);
-   }
-
-   return true;
-}
+// Translation cache, see Hlsl2Glsl_EnableCache
+static TTranslationCache* s_Cache = 0;
+static TIncludeCache* s_IncludeCache = 0;
 
 
 int C_DECL Hlsl2Glsl_Initialize()
 {
-   TInfoSink infoSink;
-
    if (!InitProcess())
       return 0;
 
    if (!PerProcessGPA)
    {
-      TPoolAllocator *builtInPoolAllocator = new TPoolAllocator();
-      builtInPoolAllocator->push();
-      TPoolAllocator* gPoolAllocator = &GlobalPoolAllocator;
-      SetGlobalPoolAllocatorPtr(builtInPoolAllocator);
-
-      TSymbolTable symTables[EShLangCount];
-      GenerateBuiltInSymbolTable(infoSink, symTables, EShLangCount);
-
       PerProcessGPA = new TPoolAllocator();
       PerProcessGPA->push();
+      TPoolAllocator* gPoolAllocator = &GlobalPoolAllocator;
       SetGlobalPoolAllocatorPtr(PerProcessGPA);
 
-      SymbolTables[EShLangVertex].copyTable(symTables[EShLangVertex]);
-      SymbolTables[EShLangFragment].copyTable(symTables[EShLangFragment]);
+      // The built-ins come precompiled, see Initialize.h; there's nothing to parse.
+      LoadBuiltInSymbols(EShLangVertex, SymbolTables[EShLangVertex]);
+      LoadBuiltInSymbols(EShLangFragment, SymbolTables[EShLangFragment]);
 
       SetGlobalPoolAllocatorPtr(gPoolAllocator);
 
-      symTables[EShLangVertex].pop();
-      symTables[EShLangFragment].pop();
-
-      builtInPoolAllocator->popAll();
-      delete builtInPoolAllocator;        
-
+      initializeHLSLSupportLibrary();
    }
 
    return 1;
@@ -256,6 +143,9 @@ void C_DECL Hlsl2Glsl_Shutdown()
 	if (s_ThreadInitialized == OS_INVALID_TLS_INDEX)
 		return;
 	
+	Hlsl2Glsl_DisableCache();
+	Hlsl2Glsl_DisableIncludeCache();
+
 	if (PerProcessGPA)
 	{
 		SymbolTables[EShLangVertex].pop();
@@ -264,12 +154,13 @@ void C_DECL Hlsl2Glsl_Shutdown()
 		PerProcessGPA->popAll();
 		delete PerProcessGPA;
 		PerProcessGPA = NULL;
+
+		finalizeHLSLSupportLibrary();
 	}
 	
 	DetachThread();
 	
 	FreePoolIndex();
-	FreeParseContextIndex();
 	
 	OS_FreeTLSIndex(s_ThreadInitialized);
 	s_ThreadInitialized = OS_INVALID_TLS_INDEX;
@@ -293,42 +184,32 @@ void C_DECL Hlsl2Glsl_DestructCompiler( ShHandle handle )
    delete handle;
 }
 
-int C_DECL Hlsl2Glsl_Parse(
-	const ShHandle handle,
-	const char* shaderString,
+//
+// Build the AST of the compiler's shader for a target version, from its tokens (the
+// includes were done by PaPreprocess already). The AST is kept in the compiler until
+// the next shader, so it can be translated any number of times.
+//
+bool PaBuildAST(
+	HlslCrossCompiler* compiler,
 	ETargetVersion targetVersion,
-	Hlsl2Glsl_ParseCallbacks* callbacks,
 	unsigned options)
 {
-   if (!InitThread())
-      return 0;
+   compiler->DeleteAST();
 
-   if (handle == 0)
-      return 0;
-
-   HlslCrossCompiler* compiler = handle;
-
-   GlobalPoolAllocator.push();
-   compiler->infoSink.info.erase();
-   compiler->infoSink.debug.erase();
-
-   if (!shaderString)
-	   return 1;
+   TPoolAllocator* threadPool = &GlobalPoolAllocator;
+   TPoolAllocator& astPool = compiler->GetASTPool();
+   SetGlobalPoolAllocatorPtr(&astPool);
+   astPool.push();
+   TTypeTable::setCurrent(&compiler->GetASTTypes());
 
+   // built-ins are shared by all parses; this shader's symbols go into levels on top of them
    TSymbolTable symbolTable(SymbolTables[compiler->getLanguage()]);
 
-   GenerateBuiltInSymbolTable(compiler->infoSink, &symbolTable, compiler->getLanguage());
-
    TParseContext parseContext(symbolTable, compiler->getLanguage(), targetVersion, options, compiler->infoSink);
 
-   GlobalParseContext = &parseContext;
-
-   setInitialState();
-
    //
    // Parse the application's shaders.  All the following symbol table
-   // work will be throw-away, so push a new allocation scope that can
-   // be thrown away, then push a scope for the current shader's globals.
+   // work will be throw-away, so push a scope for the current shader's globals.
    //
    bool success = true;
 
@@ -337,7 +218,7 @@ int C_DECL Hlsl2Glsl_Parse(
       parseContext.infoSink.info.message(EPrefixInternalError, "Wrong symbol table level");
 
 
-   int ret = PaParseString(const_cast<char*>(shaderString), parseContext, callbacks);
+   int ret = PaParseTokens(*compiler->GetSource(), parseContext);
    if (ret)
       success = false;
 
@@ -350,8 +231,7 @@ int C_DECL Hlsl2Glsl_Parse(
 		if (options & ETranslateOpIntermediate)
 			ir_output_tree(parseContext.treeRoot, parseContext.infoSink);
 
-		compiler->TransformAST (parseContext.treeRoot);
-		compiler->ProduceGLSL (parseContext.treeRoot, targetVersion, options);
+		compiler->SetAST (parseContext.treeRoot, targetVersion);
    }
    else if (!success)
    {
@@ -367,8 +247,6 @@ int C_DECL Hlsl2Glsl_Parse(
 			ir_output_tree(parseContext.treeRoot, parseContext.infoSink);
    }
 
-	ir_remove_tree(parseContext.treeRoot);
-
    //
    // Ensure symbol table is returned to the built-in level,
    // throwing away all but the built-ins.
@@ -376,12 +254,239 @@ int C_DECL Hlsl2Glsl_Parse(
    while (! symbolTable.atSharedBuiltInLevel())
       symbolTable.pop();
 
-   //
-   // Throw away all the temporary memory used by the compilation process.
-   //
-   GlobalPoolAllocator.pop();
+   TTypeTable::setCurrent(NULL);
+   SetGlobalPoolAllocatorPtr(threadPool);
+
+   // a shader without any code has no AST either
+   if (!success || !parseContext.treeRoot)
+      compiler->DeleteAST();
+
+   return success;
+}
+
+
+static bool BuildAST(HlslCrossCompiler* compiler, ETargetVersion targetVersion, unsigned options)
+{
+   if (!PaBuildAST(compiler, targetVersion, options))
+      return false;
+   compiler->TransformAST();
+   return true;
+}
+
+
+// Replaces the compiler's shader with nothing, like parsing a NULL string.
+static void ResetShader(HlslCrossCompiler* compiler)
+{
+   compiler->SetSource(NULL);
+   compiler->m_HasParseKey = false;
+   compiler->GetASTPool().resetStats();
+
+   compiler->infoSink.info.erase();
+   compiler->infoSink.debug.erase();
+}
+
+
+// Parse a preprocessed shader, which the compiler takes over; the rest of Hlsl2Glsl_Parse.
+static bool ParsePreprocessed(
+	HlslCrossCompiler* compiler,
+	TPreprocessedSource* source,
+	ETargetVersion targetVersion,
+	unsigned options)
+{
+   ResetShader(compiler);
+   compiler->SetSource(source);
+
+   if (s_Cache)
+   {
+      TCacheKeyBuilder key('p');
+      key.add(*source);
+      key.add(int(compiler->getLanguage()));
+      key.add(int(targetVersion));
+      key.add(int(options));
+      compiler->m_ParseKey = key.hash();
+      compiler->m_HasParseKey = true;
+
+      // On a hit, the AST is only built if a translation isn't in the cache either.
+      std::string value;
+      if (s_Cache->find(compiler->m_ParseKey, value))
+      {
+         TCacheReader reader(value);
+         const bool success = reader.readInt() != 0;
+         std::string info, debug;
+         reader.readString(info);
+         reader.readString(debug);
+         if (reader.succeeded())
+         {
+            compiler->infoSink.info << info;
+            compiler->infoSink.debug << debug;
+            if (!success)
+               compiler->SetSource(NULL);
+            return success;
+         }
+      }
+   }
+
+   const bool success = BuildAST(compiler, targetVersion, options);
+   if (!success)
+      compiler->SetSource(NULL);
+
+   if (compiler->m_HasParseKey)
+   {
+      std::string value;
+      CacheWriteInt(value, success ? 1 : 0);
+      CacheWriteString(value, compiler->infoSink.info.c_str());
+      CacheWriteString(value, compiler->infoSink.debug.c_str());
+      s_Cache->insert(compiler->m_ParseKey, value);
+   }
+
+   return success;
+}
+
+
+static int ParseSource(
+	const ShHandle handle,
+	const char* shaderString,
+	size_t length,
+	ETargetVersion targetVersion,
+	const TParseCallbacks* callbacks,
+	unsigned options)
+{
+   if (!InitThread())
+      return 0;
 
-   return success ? 1 : 0;
+   if (handle == 0)
+      return 0;
+
+   HlslCrossCompiler* compiler = handle;
+
+   // this replaces the previous shader
+   ResetShader(compiler);
+
+   if (!shaderString)
+	   return 1;
+
+   // Preprocess first: the tokens are kept, so that the shader can be parsed again for
+   // other target versions, and they are what the parse is looked up by in the cache.
+   TPreprocessedSource* source = new TPreprocessedSource();
+   PaPreprocess(shaderString, length, *source, callbacks, NULL, 0, s_IncludeCache);
+   return ParsePreprocessed(compiler, source, targetVersion, options) ? 1 : 0;
+}
+
+
+int C_DECL Hlsl2Glsl_Parse(
+	const ShHandle handle,
+	const char* shaderString,
+	ETargetVersion targetVersion,
+	Hlsl2Glsl_ParseCallbacks* callbacks,
+	unsigned options)
+{
+	const TParseCallbacks includes = callbacks ? TParseCallbacks(*callbacks) : TParseCallbacks();
+	return ParseSource(handle, shaderString, shaderString ? strlen(shaderString) : 0, targetVersion, callbacks ? &includes : NULL, options);
+}
+
+
+// The lexer can look a few bytes past the end of a token that runs into the end
+// of the text, so a buffer that doesn't end with a newline needs a zero after it.
+static const char* TerminatedBuffer(const char* shaderString, size_t length, std::string& copy)
+{
+	if (shaderString && length > 0 && shaderString[length - 1] != '\n')
+	{
+		copy.assign(shaderString, length);
+		return copy.c_str();
+	}
+	return shaderString;
+}
+
+
+int C_DECL Hlsl2Glsl_ParseBuffer(
+	const ShHandle handle,
+	const char* shaderString,
+	size_t length,
+	ETargetVersion targetVersion,
+	Hlsl2Glsl_ParseCallbacksRef* callbacks,
+	unsigned options)
+{
+	std::string copy;
+	shaderString = TerminatedBuffer(shaderString, length, copy);
+	const TParseCallbacks includes = callbacks ? TParseCallbacks(*callbacks) : TParseCallbacks();
+	return ParseSource(handle, shaderString, length, targetVersion, callbacks ? &includes : NULL, options);
+}
+
+
+static std::string WriteCachedTranslation(HlslCrossCompiler* compiler, bool result)
+{
+	const HlslLinker* linker = compiler->GetLinker();
+	std::string value;
+	std::string prefix, text;
+	linker->getLinkResult(prefix, text);
+	CacheWriteInt(value, result ? 1 : 0);
+	CacheWriteString(value, prefix.c_str());
+	CacheWriteString(value, text.c_str());
+	CacheWriteString(value, compiler->infoSink.info.c_str());
+
+	// the linker never sets uniform initializers
+	const ShUniformInfo* uniforms = linker->getUniformInfo();
+	CacheWriteInt(value, linker->getUniformCount());
+	for (int i = 0; i < linker->getUniformCount(); ++i)
+	{
+		CacheWriteString(value, uniforms[i].name);
+		CacheWriteString(value, uniforms[i].semantic);
+		CacheWriteString(value, uniforms[i].registerSpec);
+		CacheWriteInt(value, uniforms[i].type);
+		CacheWriteInt(value, uniforms[i].arraySize);
+	}
+	return value;
+}
+
+
+static char* ReadCachedString(TCacheReader& reader)
+{
+	std::string s;
+	if (!reader.readString(s))
+		return 0;
+	char* result = new char[s.size() + 1];
+	memcpy(result, s.c_str(), s.size() + 1);
+	return result;
+}
+
+
+static bool ReadCachedTranslation(const std::string& value, HlslCrossCompiler* compiler, int* result)
+{
+	TCacheReader reader(value);
+	*result = reader.readInt();
+	std::string prefix, text, info;
+	reader.readString(prefix);
+	reader.readString(text);
+	reader.readString(info);
+
+	std::vector<ShUniformInfo> uniforms;
+	const int count = reader.readInt();
+	for (int i = 0; i < count && reader.isValid(); ++i)
+	{
+		ShUniformInfo uniform;
+		uniform.name = ReadCachedString(reader);
+		uniform.semantic = ReadCachedString(reader);
+		uniform.registerSpec = ReadCachedString(reader);
+		uniform.type = EShType(reader.readInt());
+		uniform.arraySize = reader.readInt();
+		uniform.init = 0;
+		uniforms.push_back(uniform);
+	}
+
+	if (!reader.succeeded())
+	{
+		for (size_t i = 0; i < uniforms.size(); ++i)
+		{
+			delete[] uniforms[i].name;
+			delete[] uniforms[i].semantic;
+			delete[] uniforms[i].registerSpec;
+		}
+		return false;
+	}
+
+	compiler->GetLinker()->setLinkResult(prefix, text, uniforms);
+	compiler->infoSink.info << info;
+	return true;
 }
 
 
@@ -391,29 +496,176 @@ int C_DECL Hlsl2Glsl_Translate(
 	ETargetVersion targetVersion,
 	unsigned options)
 {
+   if (!InitThread())
+      return 0;
+
    if (handle == 0)
       return 0;
 
    HlslCrossCompiler* compiler = handle;
    compiler->infoSink.info.erase();
 
-   // \todo [2013-05-14 pyry] Maintain different support library per target version.
-   initializeHLSLSupportLibrary(targetVersion);
-
-	if (!compiler->IsASTTransformed() || !compiler->IsGlslProduced())
+	if (!compiler->GetSource())
 	{
 		compiler->infoSink.info.message(EPrefixError, "Shader does not have valid object code.");
 		return 0;
 	}
 
-   bool ret = compiler->GetLinker()->link(compiler, entry, targetVersion, options);
+   const bool useCache = s_Cache && compiler->m_HasParseKey;
+
+   TCacheKey key;
+   if (useCache)
+   {
+      TCacheKeyBuilder keyData('t');
+      keyData.add(compiler->m_ParseKey);
+      keyData.add(entry);
+      keyData.add(int(targetVersion));
+      keyData.add(int(options));
+      for (int i = 0; i < EAttrSemCount; ++i)
+         keyData.add(compiler->GetLinker()->getUserAttribName(EAttribSemantic(i)));
+      key = keyData.hash();
+
+      std::string value;
+      int result;
+      if (s_Cache->find(key, value) && ReadCachedTranslation(value, compiler, &result))
+         return result;
+   }
+
+   // The AST from the parse is used when it fits this target version; otherwise (or
+   // when the parse came from the cache) the shader is parsed again. The log of that
+   // parse is only kept when it fails, as the log of Hlsl2Glsl_Parse was returned already.
+   bool ret = true;
+   if (!compiler->HasAST(targetVersion))
+   {
+      std::string debug = compiler->infoSink.debug.c_str();
+      ret = BuildAST(compiler, targetVersion, options);
+      if (ret)
+         compiler->infoSink.info.erase();
+      compiler->infoSink.debug.erase();
+      compiler->infoSink.debug << debug;
+   }
+
+   if (ret && !compiler->HasAST(targetVersion))
+   {
+      compiler->infoSink.info.message(EPrefixError, "Shader does not have valid object code.");
+      ret = false;
+   }
+
+   if (ret)
+   {
+      compiler->ProduceGLSL(targetVersion, options);
+      ret = compiler->GetLinker()->link(compiler, entry, targetVersion, options);
+   }
 
-   finalizeHLSLSupportLibrary();
+   if (useCache)
+      s_Cache->insert(key, WriteCachedTranslation(compiler, ret));
 
    return ret ? 1 : 0;
 }
 
 
+int C_DECL Hlsl2Glsl_EnableCache( size_t memoryLimit, const char* directory )
+{
+	if (!InitThread())
+		return 0;
+
+	// without a fingerprint of this build, files could be another build's results
+	if (directory && directory[0] && !TTranslationCache::supportsDirectory())
+		return 0;
+
+	delete s_Cache;
+	s_Cache = new TTranslationCache(memoryLimit, directory);
+	return 1;
+}
+
+
+void C_DECL Hlsl2Glsl_DisableCache()
+{
+	delete s_Cache;
+	s_Cache = 0;
+}
+
+
+int C_DECL Hlsl2Glsl_EnableIncludeCache()
+{
+	if (!InitThread())
+		return 0;
+
+	if (!s_IncludeCache)
+		s_IncludeCache = new TIncludeCache();
+	return 1;
+}
+
+void C_DECL Hlsl2Glsl_DisableIncludeCache()
+{
+	delete s_IncludeCache;
+	s_IncludeCache = 0;
+}
+
+void C_DECL Hlsl2Glsl_InvalidateIncludeCache( const char* fname )
+{
+	if (s_IncludeCache)
+		s_IncludeCache->invalidate(fname);
+}
+
+void C_DECL Hlsl2Glsl_GetIncludeCacheStats( Hlsl2Glsl_IncludeCacheStats* stats )
+{
+	if (!stats)
+		return;
+	if (s_IncludeCache)
+		s_IncludeCache->getStats(*stats);
+	else
+	{
+		stats->hits = stats->misses = stats->files = 0;
+		stats->bytes = 0;
+	}
+}
+
+
+int C_DECL Hlsl2Glsl_SetMemoryOptions( ShHandle handle, const Hlsl2Glsl_MemoryOptions* options )
+{
+	if (!handle || !options)
+		return 0;
+	TPoolOptions poolOptions;
+	poolOptions.pageSize = options->pageSize;
+	poolOptions.maxPageSize = options->maxPageSize;
+	poolOptions.keepBytes = options->keepBytes;
+	poolOptions.reuseFreed = options->reuseFreed != 0;
+	handle->GetASTPool().setOptions(poolOptions);
+	return 1;
+}
+
+int C_DECL Hlsl2Glsl_GetMemoryOptions( const ShHandle handle, Hlsl2Glsl_MemoryOptions* options )
+{
+	if (!handle || !options)
+		return 0;
+	const TPoolOptions& poolOptions = handle->GetASTPool().getOptions();
+	options->pageSize = poolOptions.pageSize;
+	options->maxPageSize = poolOptions.maxPageSize;
+	options->keepBytes = poolOptions.keepBytes;
+	options->reuseFreed = poolOptions.reuseFreed ? 1 : 0;
+	return 1;
+}
+
+int C_DECL Hlsl2Glsl_GetMemoryStats( const ShHandle handle, Hlsl2Glsl_MemoryStats* stats )
+{
+	if (!handle || !stats)
+		return 0;
+	const TPoolStats& poolStats = handle->GetASTPool().getStats();
+	stats->bytesRequested = poolStats.bytesRequested;
+	stats->bytesReused = poolStats.bytesReused;
+	stats->bytesReserved = poolStats.bytesReserved;
+	stats->peakBytes = poolStats.peakBytes;
+	stats->freeBytes = poolStats.freeBytes;
+	stats->allocations = poolStats.allocations;
+	stats->reusedAllocations = poolStats.reusedAllocations;
+	stats->largeAllocations = poolStats.largeAllocations;
+	stats->pages = poolStats.pages;
+	stats->osAllocations = poolStats.osAllocations;
+	return 1;
+}
+
+
 const char* C_DECL Hlsl2Glsl_GetShader( const ShHandle handle )
 {
 	if (!handle)
@@ -478,6 +730,399 @@ int C_DECL Hlsl2Glsl_SetUserAttributeNames ( ShHandle handle,
 }
 
 
+
+// -----------------------------------------------------------------------------
+// Batch translation
+//
+// Jobs are split evenly between the workers up front. Each worker takes jobs from
+// the front of its own range; once that is empty it steals the back half of
+// another worker's range.
+
+struct TBatchQueue
+{
+	OS_Mutex mutex;
+	int begin, end; // jobs not taken yet
+};
+
+struct TBatchContext
+{
+	Hlsl2Glsl_BatchJob* jobs;
+	TBatchQueue* queues;
+	int workerCount;
+};
+
+struct TBatchWorker
+{
+	TBatchContext* context;
+	int index;
+	int succeeded;
+};
+
+
+// Returns the index of the next job for this worker, or -1 when there is nothing left.
+static int TakeBatchJob(TBatchContext& ctx, int worker)
+{
+	TBatchQueue& own = ctx.queues[worker];
+	OS_LockMutex(&own.mutex);
+	if (own.begin < own.end)
+	{
+		const int job = own.begin++;
+		OS_UnlockMutex(&own.mutex);
+		return job;
+	}
+	OS_UnlockMutex(&own.mutex);
+
+	for (int i = 1; i < ctx.workerCount; ++i)
+	{
+		TBatchQueue& victim = ctx.queues[(worker + i) % ctx.workerCount];
+		OS_LockMutex(&victim.mutex);
+		const int left = victim.end - victim.begin;
+		if (left > 0)
+		{
+			const int stolenBegin = victim.end - (left + 1) / 2;
+			const int stolenEnd = victim.end;
+			victim.end = stolenBegin;
+			OS_UnlockMutex(&victim.mutex);
+
+			OS_LockMutex(&own.mutex);
+			own.begin = stolenBegin + 1;
+			own.end = stolenEnd;
+			OS_UnlockMutex(&own.mutex);
+			return stolenBegin;
+		}
+		OS_UnlockMutex(&victim.mutex);
+	}
+	return -1;
+}
+
+
+static void RunBatchWorker(void* data)
+{
+	TBatchWorker& worker = *reinterpret_cast<TBatchWorker*>(data);
+	TBatchContext& ctx = *worker.context;
+
+	// worker 0 is the calling thread, the others are started just for this batch
+	if (!InitThread())
+		return;
+
+	// compilers are reused for all the jobs this worker runs
+	HlslCrossCompiler* compilers[EShLangCount] = { NULL };
+
+	for (int index = TakeBatchJob(ctx, worker.index); index >= 0; index = TakeBatchJob(ctx, worker.index))
+	{
+		Hlsl2Glsl_BatchJob& job = ctx.jobs[index];
+		job.result = 0;
+		job.shader.clear();
+		job.infoLog.clear();
+
+		if (job.language < 0 || job.language >= EShLangCount)
+		{
+			job.infoLog = "ERROR: Invalid shader language.\n";
+			continue;
+		}
+
+		HlslCrossCompiler*& compiler = compilers[job.language];
+		if (compiler)
+			compiler->Reset();
+		else
+			compiler = new HlslCrossCompiler(job.language);
+
+		if (Hlsl2Glsl_Parse(compiler, job.source, job.targetVersion, job.callbacks, job.options) &&
+			Hlsl2Glsl_Translate(compiler, job.entry, job.targetVersion, job.options))
+		{
+			job.result = 1;
+			job.shader = Hlsl2Glsl_GetShader(compiler);
+			++worker.succeeded;
+		}
+		job.infoLog = Hlsl2Glsl_GetInfoLog(compiler);
+	}
+
+	for (int i = 0; i < EShLangCount; ++i)
+		delete compilers[i];
+
+	if (worker.index != 0)
+		DetachThread();
+}
+
+
+int C_DECL Hlsl2Glsl_TranslateBatch(
+	Hlsl2Glsl_BatchJob* jobs,
+	int jobCount,
+	int threadCount)
+{
+	if (!InitThread())
+		return 0;
+
+	if (jobs == 0 || jobCount <= 0)
+		return 0;
+
+	if (threadCount <= 0)
+		threadCount = OS_GetProcessorCount();
+	if (threadCount > jobCount)
+		threadCount = jobCount;
+
+	TBatchContext ctx;
+	ctx.jobs = jobs;
+	ctx.queues = new TBatchQueue[threadCount];
+	ctx.workerCount = threadCount;
+
+	std::vector<TBatchWorker> workers(threadCount);
+	for (int i = 0; i < threadCount; ++i)
+	{
+		OS_InitMutex(&ctx.queues[i].mutex);
+		ctx.queues[i].begin = int((long long)jobCount * i / threadCount);
+		ctx.queues[i].end = int((long long)jobCount * (i + 1) / threadCount);
+		workers[i].context = &ctx;
+		workers[i].index = i;
+		workers[i].succeeded = 0;
+	}
+
+	// if a thread can't be started, its jobs get stolen by the others
+	std::vector<OS_Thread> threads(threadCount);
+	std::vector<bool> started(threadCount, false);
+	for (int i = 1; i < threadCount; ++i)
+		started[i] = OS_CreateThread(&threads[i], RunBatchWorker, &workers[i]);
+
+	RunBatchWorker(&workers[0]);
+
+	for (int i = 1; i < threadCount; ++i)
+	{
+		if (started[i])
+			OS_JoinThread(threads[i]);
+	}
+
+	int succeeded = 0;
+	for (int i = 0; i < threadCount; ++i)
+	{
+		succeeded += workers[i].succeeded;
+		OS_DestroyMutex(&ctx.queues[i].mutex);
+	}
+	delete[] ctx.queues;
+
+	return succeeded;
+}
+
+
+// -----------------------------------------------------------------------------
+// Variants
+//
+// All variants are preprocessed, with include files read once and handed out from
+// memory after that (without copying). They and the shader are lexed once (in the
+// include cache, or one just for this call; the shader is dropped from the include
+// cache when done). Variants are told apart by a hash of their tokens (like parses in
+// the cache), and only the first one with each set of tokens is parsed and translated.
+
+struct TIncludeFile
+{
+	bool opened;
+	std::string text;  // unless read by the zero-copy callback
+	const char* ref;
+	size_t length;
+	bool isSystem;
+	std::string name;
+	std::string parentName;
+};
+
+struct TIncludeMemo
+{
+	TParseCallbacks callbacks;
+	std::map<std::string, TIncludeFile> files; // by include type, parent file name and file name
+	std::vector<const TIncludeFile*> order;    // of the first time they were included
+};
+
+
+static bool C_DECL MemoIncludeOpen(bool isSystem, const char* fname, const char* parentfname, const char* parent, const char** text, size_t* length, void* data)
+{
+	TIncludeMemo& memo = *reinterpret_cast<TIncludeMemo*>(data);
+
+	std::string key(isSystem ? "<" : "\"");
+	if (parentfname)
+		key += parentfname;
+	key += '\0';
+	key += fname;
+
+	std::map<std::string, TIncludeFile>::iterator it = memo.files.find(key);
+	if (it == memo.files.end())
+	{
+		// no open callback reads empty files, as in Hlsl2Glsl_Parse
+		it = memo.files.insert(std::make_pair(key, TIncludeFile())).first;
+		TIncludeFile& file = it->second;
+		file.ref = NULL;
+		file.length = 0;
+		file.isSystem = isSystem;
+		file.name = fname;
+		if (parentfname)
+			file.parentName = parentfname;
+		memo.order.push_back(&file);
+		const TParseCallbacks& callbacks = memo.callbacks;
+		if (callbacks.openRef)
+			file.opened = callbacks.openRef(isSystem, fname, parentfname, parent, &file.ref, &file.length, callbacks.data);
+		else
+		{
+			file.opened = !callbacks.open || callbacks.open(isSystem, fname, parentfname, parent, file.text, callbacks.data);
+			file.ref = file.text.c_str();
+			file.length = file.text.size();
+		}
+	}
+	*text = it->second.ref;
+	*length = it->second.length;
+	return it->second.opened;
+}
+
+
+static void CloseMemoFiles(TIncludeMemo& memo)
+{
+	const TParseCallbacks& callbacks = memo.callbacks;
+	if (!callbacks.close)
+		return;
+	for (std::map<std::string, TIncludeFile>::iterator it = memo.files.begin(); it != memo.files.end(); ++it)
+	{
+		if (it->second.opened)
+			callbacks.close(it->second.ref, callbacks.data);
+	}
+}
+
+
+int C_DECL Hlsl2Glsl_TranslateVariants(
+	const ShHandle handle,
+	const char* shaderString,
+	const char* entry,
+	ETargetVersion targetVersion,
+	Hlsl2Glsl_ParseCallbacks* callbacks,
+	unsigned options,
+	Hlsl2Glsl_Variant* variants,
+	int variantCount)
+{
+	if (!InitThread())
+		return 0;
+
+	if (handle == 0 || variants == 0 || variantCount <= 0)
+		return 0;
+
+	HlslCrossCompiler* compiler = handle;
+
+	TIncludeMemo memo;
+	if (callbacks)
+		memo.callbacks = TParseCallbacks(*callbacks);
+	TParseCallbacks memoCallbacks;
+	memoCallbacks.openRef = MemoIncludeOpen;
+	memoCallbacks.data = &memo;
+	const size_t length = shaderString ? strlen(shaderString) : 0;
+
+	TIncludeCache* localIncludeCache = s_IncludeCache ? NULL : new TIncludeCache();
+	TIncludeCache* includeCache = s_IncludeCache ? s_IncludeCache : localIncludeCache;
+
+	std::map<TCacheKey, int> distinct; // first variant with each set of tokens
+	int succeeded = 0;
+	for (int i = 0; i < variantCount; ++i)
+	{
+		Hlsl2Glsl_Variant& variant = variants[i];
+		variant.result = 0;
+		variant.sharedWith = i;
+		variant.shader.clear();
+		variant.infoLog.clear();
+
+		TPreprocessedSource* source = new TPreprocessedSource();
+		PaPreprocess(shaderString, length, *source, callbacks ? &memoCallbacks : NULL, variant.defines, variant.defineCount, includeCache, true);
+
+		TCacheKeyBuilder keyData('v');
+		keyData.add(*source);
+		const TCacheKey key = keyData.hash();
+		std::map<TCacheKey, int>::iterator it = distinct.find(key);
+		if (it != distinct.end())
+		{
+			delete source;
+			const Hlsl2Glsl_Variant& first = variants[it->second];
+			variant.result = first.result;
+			variant.sharedWith = it->second;
+			variant.shader = first.shader;
+			variant.infoLog = first.infoLog;
+			succeeded += variant.result;
+			continue;
+		}
+		distinct[key] = i;
+
+		if (ParsePreprocessed(compiler, source, targetVersion, options) &&
+			Hlsl2Glsl_Translate(compiler, entry, targetVersion, options))
+		{
+			variant.result = 1;
+			variant.shader = Hlsl2Glsl_GetShader(compiler);
+			++succeeded;
+		}
+		variant.infoLog = Hlsl2Glsl_GetInfoLog(compiler);
+	}
+
+	CloseMemoFiles(memo);
+	if (shaderString)
+		includeCache->remove("", shaderString, (unsigned int)length);
+	delete localIncludeCache;
+
+	return succeeded;
+}
+
+
+//
+// Preprocessing only doesn't need the parser, so none of the thread's pool or
+// symbol tables are touched. Include files go through the same memo as variants,
+// which keeps the order they were opened in.
+
+int C_DECL Hlsl2Glsl_Preprocess(
+	const char* shaderString,
+	size_t length,
+	Hlsl2Glsl_ParseCallbacks* callbacks,
+	const Hlsl2Glsl_Define* defines,
+	int defineCount,
+	Hlsl2Glsl_PreprocessResult* result)
+{
+	if (result == 0)
+		return 0;
+
+	result->text.clear();
+	result->includes.clear();
+	result->infoLog.clear();
+	result->skippedIncludes = 0;
+
+	if (!shaderString)
+		return 1;
+
+	std::string copy;
+	shaderString = TerminatedBuffer(shaderString, length, copy);
+
+	TIncludeMemo memo;
+	if (callbacks)
+		memo.callbacks = TParseCallbacks(*callbacks);
+	TParseCallbacks memoCallbacks;
+	memoCallbacks.openRef = MemoIncludeOpen;
+	memoCallbacks.data = &memo;
+
+	TPreprocessedSource source;
+	PaPreprocess(shaderString, length, source, callbacks ? &memoCallbacks : NULL, defines, defineCount, s_IncludeCache);
+
+	TInfoSinkBase info;
+	const bool success = PaPreprocessedText(source, result->text, info);
+	result->infoLog = info.c_str();
+	result->skippedIncludes = source.skippedIncludes;
+
+	for (size_t i = 0; i < memo.order.size(); ++i)
+	{
+		const TIncludeFile& file = *memo.order[i];
+		if (!file.opened)
+			continue;
+		Hlsl2Glsl_IncludedFile included;
+		included.name = file.name;
+		included.parentName = file.parentName;
+		included.isSystem = file.isSystem;
+		const TCacheKey hash = CacheHash(file.ref, file.length);
+		included.hash[0] = hash.hash[0];
+		included.hash[1] = hash.hash[1];
+		result->includes.push_back(included);
+	}
+	CloseMemoFiles(memo);
+
+	return success ? 1 : 0;
+}
+
+
 static bool kVersionUsesPrecision[ETargetVersionCount] = {
 	true,	// ES 1.00
 	false,	// 1.10
@@ -0,0 +1,150 @@
+// Copyright (c) The HLSL2GLSLFork Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE.txt file.
+
+
+#include <vector>
+
+#include "IncludeCache.h"
+#include "../../include/hlsl2glsl.h"
+
+#include "preprocessor/mojoshader.h"
+#define __MOJOSHADER_INTERNAL__ 1
+#include "preprocessor/mojoshader_internal.h"
+
+
+struct TIncludeCache::TEntry
+{
+	std::vector<hlmojo_CachedToken> tokens;
+	int refs; // the cache's while in the map, and one per open handle; freed at 0
+};
+
+
+static int AddToken(const hlmojo_CachedToken* token, void* data)
+{
+	reinterpret_cast<std::vector<hlmojo_CachedToken>*>(data)->push_back(*token);
+	return 1;
+}
+
+
+TIncludeCache::TIncludeCache()
+:	hits(0)
+,	misses(0)
+,	bytes(0)
+{
+	OS_InitMutex(&mutex);
+}
+
+TIncludeCache::~TIncludeCache()
+{
+	invalidate(NULL);
+	OS_DestroyMutex(&mutex);
+}
+
+
+const hlmojo_CachedToken* TIncludeCache::open(const char* fname, const char* text, unsigned int length, unsigned int* count, void** handle)
+{
+	const std::pair<std::string, TCacheKey> key(fname ? fname : "", CacheHash(text, length));
+
+	// Only the entry is used once the mutex is unlocked: another thread can
+	// invalidate it and erase it from the map, but not free it while we hold a ref.
+	TEntry* entry;
+	OS_LockMutex(&mutex);
+	TEntryMap::iterator it = entries.find(key);
+	if (it != entries.end())
+	{
+		++hits;
+		entry = it->second;
+		++entry->refs;
+		OS_UnlockMutex(&mutex);
+	}
+	else
+	{
+		OS_UnlockMutex(&mutex);
+
+		// Lex without holding the lock. Should another thread add the same file
+		// meanwhile, the tokens are the same; whichever gets there first is kept.
+		TEntry* lexed = new TEntry();
+		lexed->refs = 2;
+		hlmojo_preprocessor_tokenize(text, length, AddToken, &lexed->tokens);
+
+		OS_LockMutex(&mutex);
+		++misses;
+		std::pair<TEntryMap::iterator, bool> added = entries.insert(std::make_pair(key, lexed));
+		if (added.second)
+			bytes += lexed->tokens.size() * sizeof(hlmojo_CachedToken);
+		else
+		{
+			delete lexed;
+			++added.first->second->refs;
+		}
+		entry = added.first->second;
+		OS_UnlockMutex(&mutex);
+	}
+
+	*handle = entry;
+	*count = (unsigned int)entry->tokens.size();
+	return &entry->tokens[0];
+}
+
+
+void TIncludeCache::close(void* handle)
+{
+	OS_LockMutex(&mutex);
+	release(reinterpret_cast<TEntry*>(handle));
+	OS_UnlockMutex(&mutex);
+}
+
+
+void TIncludeCache::release(TEntry* entry)
+{
+	if (--entry->refs == 0)
+		delete entry;
+}
+
+
+void TIncludeCache::invalidate(const char* fname)
+{
+	OS_LockMutex(&mutex);
+	for (TEntryMap::iterator it = entries.begin(); it != entries.end(); )
+	{
+		if (fname && it->first.first != fname)
+		{
+			++it;
+			continue;
+		}
+		// only the cache's ref; open handles keep the tokens until closed
+		bytes -= it->second->tokens.size() * sizeof(hlmojo_CachedToken);
+		release(it->second);
+		entries.erase(it++);
+	}
+	OS_UnlockMutex(&mutex);
+}
+
+
+// Drops the tokens of one text of a file.
+void TIncludeCache::remove(const char* fname, const char* text, unsigned int length)
+{
+	const std::pair<std::string, TCacheKey> key(fname ? fname : "", CacheHash(text, length));
+
+	OS_LockMutex(&mutex);
+	TEntryMap::iterator it = entries.find(key);
+	if (it != entries.end())
+	{
+		bytes -= it->second->tokens.size() * sizeof(hlmojo_CachedToken);
+		release(it->second);
+		entries.erase(it);
+	}
+	OS_UnlockMutex(&mutex);
+}
+
+
+void TIncludeCache::getStats(Hlsl2Glsl_IncludeCacheStats& stats)
+{
+	OS_LockMutex(&mutex);
+	stats.hits = hits;
+	stats.misses = misses;
+	stats.files = (unsigned int)entries.size();
+	stats.bytes = bytes;
+	OS_UnlockMutex(&mutex);
+}
@@ -0,0 +1,53 @@
+// Copyright (c) The HLSL2GLSLFork Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE.txt file.
+
+
+#ifndef _INCLUDE_CACHE_INCLUDED_
+#define _INCLUDE_CACHE_INCLUDED_
+
+#include <map>
+#include <string>
+
+#include "osinclude.h"
+#include "TranslationCache.h"
+
+struct hlmojo_CachedToken;
+struct Hlsl2Glsl_IncludeCacheStats;
+
+//
+// Tokens of include files, lexed once and then handed to the preprocessor
+// instead of lexing the files again (see hlmojo_TokenCache). Files are looked
+// up by the name they are included by and a hash of their text, so a file that
+// changed is lexed again; the tokens of its old text stay until invalidated.
+//
+// Safe to use from any number of threads at once. Tokens that are in use
+// stay alive until the preprocessor is done with them, even if invalidated.
+//
+class TIncludeCache
+{
+public:
+	TIncludeCache();
+	~TIncludeCache();
+
+	const hlmojo_CachedToken* open(const char* fname, const char* text, unsigned int length, unsigned int* count, void** handle);
+	void close(void* handle);
+
+	void invalidate(const char* fname);   // NULL for all files
+	void remove(const char* fname, const char* text, unsigned int length);
+	void getStats(Hlsl2Glsl_IncludeCacheStats&);
+
+private:
+	struct TEntry;
+	typedef std::map<std::pair<std::string, TCacheKey>, TEntry*> TEntryMap;
+
+	void release(TEntry*); // call with the mutex locked
+
+	OS_Mutex mutex;
+	TEntryMap entries;
+	unsigned int hits;
+	unsigned int misses;
+	size_t bytes;
+};
+
+#endif // _INCLUDE_CACHE_INCLUDED_
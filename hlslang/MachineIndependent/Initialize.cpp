@@ -13,8 +13,11 @@
 #include "Initialize.h"
 
 #include "SymbolTable.h"
+#include "ParseHelper.h"
 #include <sstream>
 
+#include "BuiltInSymbols.h"
+
 static void appendMatrixType(std::stringstream& ss, unsigned rows, unsigned cols)
 {
     ss << "float";
@@ -693,3 +696,67 @@ void IdentifyBuiltIns(EShLanguage language, TSymbolTable& symbolTable)
    default: assert(false && "Language not supported");
    }
 }
+
+
+bool ParseBuiltInSymbols(TBuiltInStrings* builtInStrings, EShLanguage language, TInfoSink& infoSink, TSymbolTable& symbolTable)
+{
+   //@TODO: for now, we use same global symbol table for all target language versions.
+   // This is wrong and will have to be changed at some point.
+   TParseContext parseContext(symbolTable, language, ETargetVersionCount, 0, infoSink);
+
+   assert(symbolTable.isEmpty());
+
+   //
+   // Push the symbol table to give it an initial scope.  This
+   // push should not have a corresponding pop, so that built-ins
+   // are preserved, and the test for an empty table fails.
+   //
+   symbolTable.push();
+
+   for (TBuiltInStrings::iterator i  = builtInStrings[language].begin();
+       i != builtInStrings[language].end();
+       ++i)
+   {
+      const char* builtInShaders = (*i).c_str();
+
+      if (PaParseString(const_cast<char*>(builtInShaders), parseContext, NULL) != 0)
+      {
+         infoSink.info.message(EPrefixInternalError, "Unable to parse built-ins");
+         return false;
+      }
+   }
+
+   IdentifyBuiltIns(language, symbolTable);
+
+   return true;
+}
+
+
+static TType MakeBuiltInType(const TBuiltInType& t)
+{
+   return TType(t.type, t.precision, t.qualifier, t.cols, t.rows, t.matrix);
+}
+
+void LoadBuiltInSymbols(EShLanguage language, TSymbolTable& symbolTable)
+{
+   // the precompiled tables are the same for all languages
+   assert(language == EShLangVertex || language == EShLangFragment);
+   assert(symbolTable.isEmpty());
+
+   symbolTable.push();
+
+   const int count = sizeof(kBuiltInFunctions) / sizeof(kBuiltInFunctions[0]);
+   for (int i = 0; i < count; ++i)
+   {
+      const TBuiltInFunction& f = kBuiltInFunctions[i];
+      TType returnType = MakeBuiltInType(kBuiltInTypes[f.returnType]);
+      TFunction* function = new TFunction(NewPoolTString(f.name), returnType, f.op);
+      for (int p = f.firstParameter; p < f.firstParameter + f.parameterCount; ++p)
+      {
+         const TBuiltInParameter& param = kBuiltInParameters[p];
+         TParameter parameter = { NewPoolTString(param.name), 0, new TType(MakeBuiltInType(kBuiltInTypes[param.type])) };
+         function->addParameter(parameter);
+      }
+      symbolTable.insertBuiltIn(*function, f.uniqueId);
+   }
+}
@@ -29,5 +29,47 @@ private:
 
 void IdentifyBuiltIns(EShLanguage, TSymbolTable&);
 
+//
+// The built-in functions are declared by the prototype strings above, but
+// parsing those on every Hlsl2Glsl_Initialize is slow.  So the resulting
+// symbol table level is also kept precompiled, as the tables below (generated
+// into BuiltInSymbols.h by the hlsl2glslbuiltins tool), and that is what
+// gets loaded.  Both forms produce exactly the same symbols, with the same
+// unique IDs.  After changing the prototypes or IdentifyBuiltIns, regenerate
+// with "hlsl2glslbuiltins --write BuiltInSymbols.h"; the hlsl2glslbuiltins
+// test fails until then.
+//
+struct TBuiltInType
+{
+   TBasicType type;
+   TPrecision precision;
+   TQualifier qualifier;
+   unsigned char cols;
+   unsigned char rows;
+   bool matrix;
+};
+
+struct TBuiltInParameter
+{
+   const char* name;
+   unsigned short type;          // index into the type table
+};
+
+struct TBuiltInFunction
+{
+   const char* name;
+   TOperator op;
+   unsigned short returnType;    // index into the type table
+   unsigned short firstParameter; // index into the parameter table
+   unsigned short parameterCount;
+   int uniqueId;
+};
+
+// Parse the prototype strings into a new built-in level of the symbol table.
+bool ParseBuiltInSymbols(TBuiltInStrings* builtInStrings, EShLanguage language, TInfoSink& infoSink, TSymbolTable& symbolTable);
+
+// Load the precompiled built-ins into a new built-in level of the symbol table.
+void LoadBuiltInSymbols(EShLanguage language, TSymbolTable& symbolTable);
+
 #endif // _INITIALIZE_INCLUDED_
 
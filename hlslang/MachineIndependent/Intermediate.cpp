@@ -8,10 +8,10 @@
 //
 
 #include "localintermediate.h"
-#include "RemoveTree.h"
 #include "ParseHelper.h"
 #include <float.h>
 #include <limits.h>
+#include <string.h>
 
 static TPrecision GetHigherPrecision (TPrecision left, TPrecision right) {
 	return left > right ? left : right;
@@ -26,12 +26,12 @@ static TPrecision GetHigherPrecision (TPrecision left, TPrecision right) {
 // Add a terminal node for an identifier in an expression.
 TIntermSymbol* ir_add_symbol(const TVariable* var, TSourceLoc line)
 {
-	TIntermSymbol* node = ir_add_symbol_internal(var->getUniqueId(), var->getName(), var->getInfo(), var->getType(), line);
+	TIntermSymbol* node = ir_add_symbol_internal(var->getUniqueId(), &var->getName(), var->getInfo(), var->getType(), line);
 	node->setGlobal(var->isGlobal());
 	return node;
 }
 
-TIntermSymbol* ir_add_symbol_internal(int id, const TString& name, const TTypeInfo *info, const TType& type, TSourceLoc line)
+TIntermSymbol* ir_add_symbol_internal(int id, const TString* name, const TTypeInfo *info, const TType& type, TSourceLoc line)
 {
 	TIntermSymbol* node = new TIntermSymbol(id, name, info, type);
 	node->setLine(line);
@@ -705,7 +705,7 @@ TIntermTyped* ir_add_comma(TIntermTyped* left, TIntermTyped* right, TSourceLoc l
 		TIntermTyped *commaAggregate = ir_grow_aggregate(left, right, line);
 		commaAggregate->getAsAggregate()->setOperator(EOpComma);    
 		commaAggregate->setType(right->getType());
-		commaAggregate->getTypePointer()->changeQualifier(EvqTemporary);
+		commaAggregate->changeQualifier(EvqTemporary);
 		return commaAggregate;
 	}
 }
@@ -801,6 +801,30 @@ TIntermConstant* ir_add_constant(const TType& t, TSourceLoc line)
 }
 
 
+void TIntermConstant::resize(unsigned n)
+{
+	// more than kInlineValues live in a pool block sized for the count they grew to
+	if (n > kInlineValues && n > count)
+	{
+		Scalar* grown = static_cast<Scalar*>(GlobalPoolAllocator.allocate(n * sizeof(Scalar)));
+		memcpy(grown, values, count * sizeof(Scalar));
+		values = grown;
+	}
+	if (n > count)
+		memset(values + count, 0, (n - count) * sizeof(Scalar));
+	count = n;
+}
+
+
+void TIntermConstant::copyValuesFrom(const TIntermConstant& c)
+{
+	count = 0;
+	resize(c.count);
+	memcpy(values, c.values, c.count * sizeof(Scalar));
+	valueType = c.valueType;
+}
+
+
 TIntermTyped* ir_add_swizzle(TVectorFields& fields, TSourceLoc line)
 {
 	TIntermAggregate* node = new TIntermAggregate(EOpSequence);
@@ -1164,15 +1188,14 @@ bool TIntermBinary::promote(TParseContext& ctx)
    if ((left->isArray() || right->isArray()) && (left->getType() != right->getType()))
       return false;
 
+   // The result gets promoted to the highest precision.
+   TPrecision higherPrecision = GetHigherPrecision(left->getPrecision(), right->getPrecision());
+
    //
    // Base assumption:  just make the type the same as the left
    // operand.  Then only deviations from this need be coded.
    //
-   setType(TType(type, left->getPrecision(), EvqTemporary, left->getColsCount(), left->getRowsCount(), left->isMatrix()));
-
-   // The result gets promoted to the highest precision.
-   TPrecision higherPrecision = GetHigherPrecision(left->getPrecision(), right->getPrecision());
-   getTypePointer()->setPrecision(higherPrecision);
+   setType(TType(type, higherPrecision, EvqTemporary, left->getColsCount(), left->getRowsCount(), left->isMatrix()));
 
 
    //
@@ -1196,8 +1219,11 @@ bool TIntermBinary::promote(TParseContext& ctx)
          // Set array information.
          //
       case EOpAssign:
-         getType().setArraySize(left->getType().getArraySize());
-         getType().setArrayInformationType(left->getType().getArrayInformationType());
+         {
+            TType t(getType());
+            t.setArraySize(left->getType().getArraySize());
+            setType(t);
+         }
          break;
 
       default:
@@ -1614,7 +1640,7 @@ TIntermTyped* ir_promote_constant(TBasicType promoteTo, TIntermConstant* right,
 	const TType& t = right->getType();
 	TIntermConstant* left = ir_add_constant(TType(promoteTo, t.getPrecision(), t.getQualifier(), t.getColsCount(), t.getRowsCount(), t.isMatrix(), t.isArray()), right->getLine());
 	for (unsigned i = 0; i != size; ++i) {
-		TIntermConstant::Value& value = right->getValue(i);
+		const TIntermConstant::Value value = right->getValue(i);
 		
 		switch (promoteTo)
 		{
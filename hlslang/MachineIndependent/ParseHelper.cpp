@@ -4,7 +4,6 @@
 
 
 #include "ParseHelper.h"
-#include "../Include/InitializeParseContext.h"
 #include "osinclude.h"
 #include <stdarg.h>
 
@@ -482,7 +481,7 @@ bool TParseContext::lValueErrorCheck(const TSourceLoc& line, const char* op, TIn
 		case EvqAttribute:      message = "can't modify an attribute";   break;
 		case EvqUniform:
 			// mark this uniform as mutable
-			node->getTypePointer()->changeQualifier(EvqMutableUniform);
+			node->changeQualifier(EvqMutableUniform);
 			break;
 		default:
 			
@@ -836,7 +835,7 @@ bool TParseContext::parameterSamplerErrorCheck(const TSourceLoc& line, TQualifie
    return false;
 }
 
-bool TParseContext::containsSampler(TType& type)
+bool TParseContext::containsSampler(const TType& type)
 {
    if (IsSampler(type.getBasicType()))
       return true;
@@ -1026,16 +1025,18 @@ bool TParseContext::arrayErrorCheck(const TSourceLoc& line, TString& identifier,
          return true;
       }
 
-      TType* t = variable->getArrayInformationType();
-      while (t != 0)
+      TVector<TIntermTyped*>* references = variable->getArrayReferences();
+      for (size_t i = 0; references && i < references->size(); ++i)
       {
-         if (t->getMaxArraySize() > type.arraySize)
+         TIntermTyped* node = (*references)[i];
+         if (node->getType().getMaxArraySize() > type.arraySize)
          {
             error(line, "higher index value already used for the array", identifier.c_str(), "");
             return true;
          }
-         t->setArraySize(type.arraySize);
-         t = t->getArrayInformationType();
+         TType t(node->getType());
+         t.setArraySize(type.arraySize);
+         node->setType(t);
       }
 
       if (type.arraySize)
@@ -1048,7 +1049,7 @@ bool TParseContext::arrayErrorCheck(const TSourceLoc& line, TString& identifier,
    return false;
 }
 
-bool TParseContext::arraySetMaxSize(TIntermSymbol *node, TType* type, int size, bool updateFlag, TSourceLoc line)
+bool TParseContext::arraySetMaxSize(TIntermSymbol *node, int size, bool updateFlag, TSourceLoc line)
 {
    bool builtIn = false;
    TSymbol* symbol = symbolTable.find(node->getSymbol(), &builtIn);
@@ -1059,23 +1060,21 @@ bool TParseContext::arraySetMaxSize(TIntermSymbol *node, TType* type, int size,
    }
    TVariable* variable = static_cast<TVariable*>(symbol);
 
-   type->setArrayInformationType(variable->getArrayInformationType());
-   variable->updateArrayInformationType(type);
+   variable->addArrayReference(node);
 
    // we dont want to update the maxArraySize when this flag is not set, we just want to include this 
-   // node type in the chain of node types so that its updated when a higher maxArraySize comes in.
+   // node in the references to the array so that its updated when a higher maxArraySize comes in.
    if (!updateFlag)
       return false;
 
    size++;
    variable->getType().setMaxArraySize(size);
-   type->setMaxArraySize(size);
-   TType* tt = type;
-
-   while (tt->getArrayInformationType() != 0)
+   TVector<TIntermTyped*>& references = *variable->getArrayReferences();
+   for (size_t i = 0; i < references.size(); ++i)
    {
-      tt = tt->getArrayInformationType();
-      tt->setMaxArraySize(size);
+      TType t(references[i]->getType());
+      t.setMaxArraySize(size);
+      references[i]->setType(t);
    }
 
    return false;
@@ -1292,7 +1291,7 @@ bool TParseContext::executeInitializer(TSourceLoc line, TString& identifier, con
 		if (isConst)
 		{
 			initializerQualifier = EvqConst;
-			initializer->getTypePointer()->changeQualifier(initializerQualifier);
+			initializer->changeQualifier(initializerQualifier);
 		}
 		 */
 	}
@@ -1875,96 +1874,3 @@ TIntermAggregate* TParseContext::mergeAggregates( TIntermAggregate *left, TInter
    return node;
 }
 
-OS_TLSIndex GlobalParseContextIndex = OS_INVALID_TLS_INDEX;
-
-bool InitializeParseContextIndex()
-{
-   if (GlobalParseContextIndex != OS_INVALID_TLS_INDEX)
-   {
-      assert(0 && "InitializeParseContextIndex(): Parse Context already initalised");
-      return false;
-   }
-
-   //
-   // Allocate a TLS index.
-   //
-   GlobalParseContextIndex = OS_AllocTLSIndex();
-
-   if (GlobalParseContextIndex == OS_INVALID_TLS_INDEX)
-   {
-      assert(0 && "InitializeParseContextIndex(): Parse Context already initalised");
-      return false;
-   }
-
-   return true;
-}
-
-bool InitializeGlobalParseContext()
-{
-   if (GlobalParseContextIndex == OS_INVALID_TLS_INDEX)
-   {
-      assert(0 && "InitializeGlobalParseContext(): Parse Context index not initalised");
-      return false;
-   }
-
-   TThreadParseContext *lpParseContext = static_cast<TThreadParseContext *>(OS_GetTLSValue(GlobalParseContextIndex));
-   if (lpParseContext != 0)
-   {
-      assert(0 && "InitializeParseContextIndex(): Parse Context already initalised");
-      return false;
-   }
-
-   TThreadParseContext *lpThreadData = new TThreadParseContext();
-   if (lpThreadData == 0)
-   {
-      assert(0 && "InitializeGlobalParseContext(): Unable to create thread parse context");
-      return false;
-   }
-
-   lpThreadData->lpGlobalParseContext = 0;
-   OS_SetTLSValue(GlobalParseContextIndex, lpThreadData);
-
-   return true;
-}
-
-TParseContextPointer& GetGlobalParseContext()
-{
-   //
-   // Minimal error checking for speed
-   //
-
-   TThreadParseContext *lpParseContext = static_cast<TThreadParseContext *>(OS_GetTLSValue(GlobalParseContextIndex));
-
-   return lpParseContext->lpGlobalParseContext;
-}
-
-bool FreeParseContext()
-{
-   if (GlobalParseContextIndex == OS_INVALID_TLS_INDEX)
-   {
-      assert(0 && "FreeParseContext(): Parse Context index not initalised");
-      return false;
-   }
-
-   TThreadParseContext *lpParseContext = static_cast<TThreadParseContext *>(OS_GetTLSValue(GlobalParseContextIndex));
-   if (lpParseContext)
-      delete lpParseContext;
-
-   return true;
-}
-
-bool FreeParseContextIndex()
-{
-   OS_TLSIndex tlsiIndex = GlobalParseContextIndex;
-
-   if (GlobalParseContextIndex == OS_INVALID_TLS_INDEX)
-   {
-      assert(0 && "FreeParseContextIndex(): Parse Context index not initalised");
-      return false;
-   }
-
-   GlobalParseContextIndex = OS_INVALID_TLS_INDEX;
-
-   return OS_FreeTLSIndex(tlsiIndex);
-}
-
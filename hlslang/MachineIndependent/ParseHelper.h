@@ -27,6 +27,7 @@ struct TParseContext
 	, lexAfterType(false)
 	, loopNestingLevel(0)
 	, inTypeParen(false)
+	, scanner(NULL)
 	{
 	}
 	
@@ -62,7 +63,7 @@ struct TParseContext
 	bool samplerErrorCheck(const TSourceLoc& line, const TPublicType& pType, const char* reason);
 	bool structQualifierErrorCheck(const TSourceLoc& line, const TPublicType& pType);
 	bool parameterSamplerErrorCheck(const TSourceLoc& line, TQualifier qualifier, const TType& type);
-	bool containsSampler(TType& type);
+	bool containsSampler(const TType& type);
 	bool nonInitConstErrorCheck(const TSourceLoc& line, TString& identifier, TPublicType& type);
 	bool nonInitErrorCheck(const TSourceLoc& line, TString& identifier, const TTypeInfo *info, TPublicType& type);
 	bool nonInitErrorCheck(const TSourceLoc& line, TString& identifier, TPublicType& type);
@@ -79,7 +80,7 @@ struct TParseContext
     TIntermTyped* constructBuiltInAllowUpwardVectorPromote(const TType*, TOperator, TIntermNode*, TSourceLoc, bool subset);
 	TIntermTyped* addAssign(TOperator op, TIntermTyped* left, TIntermTyped* right, TSourceLoc);
 	TIntermAggregate* mergeAggregates( TIntermAggregate *left, TIntermAggregate *right);
-	bool arraySetMaxSize(TIntermSymbol*, TType*, int, bool, TSourceLoc);
+	bool arraySetMaxSize(TIntermSymbol*, int, bool, TSourceLoc);
 	TOperator getConstructorOp( const TType&);
 	TIntermNode* promoteFunctionArguments( TIntermNode *node, const TFunction* func);
 	
@@ -88,7 +89,7 @@ public:
 	TInfoSink& infoSink;
 	
 	EShLanguage language;
-	ETargetVersion targetVersion;
+	ETargetVersion targetVersion; // the AST may only depend on whether this is before GLSL 1.20, see HlslCrossCompiler::HasAST
 	unsigned options; // TTranslateOptions bitmask
 	
 	TIntermNode* treeRoot;       // root of parse tree being created
@@ -100,22 +101,63 @@ public:
 	const TType* currentFunctionType;  // the return type of the function that's currently being parsed
 	bool functionReturnsValue;   // true if a non-void function has a return
 	bool AfterEOF;
+	struct TScanner* scanner;    // lexer state, only valid while PaParseString runs
 };
 
-int PaParseString(char* source, TParseContext&, Hlsl2Glsl_ParseCallbacks* = NULL);
-void PaReservedWord();
-int PaIdentOrType(TString& id, TParseContext&, TSymbol*&);
-int PaParseComment(TSourceLoc &lineno, TParseContext&);
-void setInitialState();
+//
+// Include callbacks of either flavor in hlsl2glsl.h, as the preprocessor calls them.
+//
+struct TParseCallbacks
+{
+	TParseCallbacks() : open(0), openRef(0), close(0), data(0) { }
+	explicit TParseCallbacks(const Hlsl2Glsl_ParseCallbacks& c) :
+		open(c.includeOpenCallback), openRef(0), close(c.includeCloseCallback), data(c.data) { }
+	explicit TParseCallbacks(const Hlsl2Glsl_ParseCallbacksRef& c) :
+		open(0), openRef(c.includeOpenCallback), close(c.includeCloseCallback), data(c.data) { }
 
-typedef TParseContext* TParseContextPointer;
-extern TParseContextPointer& GetGlobalParseContext();
-#define GlobalParseContext GetGlobalParseContext()
+	Hlsl2Glsl_IncludeOpenFunc open;
+	Hlsl2Glsl_IncludeOpenRefFunc openRef; // used instead of open if set
+	Hlsl2Glsl_IncludeCloseFunc close;
+	void* data;
+};
+
+int PaParseString(char* source, TParseContext&, const TParseCallbacks* = NULL);
+
+//
+// A shader after preprocessing: the preprocessor's tokens, with their text and
+// locations, so it can be hashed (see TranslationCache.h) and parsed later on.
+//
+struct TPreprocessedToken
+{
+	int token;               // preprocessor Token
+	unsigned int offset;     // of the token text in TPreprocessedSource::text
+	unsigned int length;
+	const char* file;        // points into TPreprocessedSource::files
+	unsigned int line;
+};
 
-typedef struct TThreadParseContextRec
+struct TPreprocessedSource
 {
-   TParseContext *lpGlobalParseContext;
-} TThreadParseContext;
+	TPreprocessedSource() : outOfMemory(false), skippedIncludes(0) { }
+
+	std::string text;
+	std::vector<TPreprocessedToken> tokens;
+	std::set<std::string> files;
+	bool outOfMemory;        // preprocessing stopped after the last token
+	unsigned skippedIncludes; // of guarded files that were included before
+};
+
+class TIncludeCache;
+void PaPreprocess(const char* source, size_t length, TPreprocessedSource&, const TParseCallbacks* = NULL,
+                  const Hlsl2Glsl_Define* defines = NULL, int defineCount = 0,
+                  TIncludeCache* = NULL, bool cacheSource = false);
+int PaParseTokens(const TPreprocessedSource&, TParseContext&);
+bool PaPreprocessedText(const TPreprocessedSource&, std::string& text, TInfoSinkBase&);
+
+// Parses the tokens of a compiler's shader into its AST (not transformed yet, see
+// HlslCrossCompiler::TransformAST). In HLSL2GLSL.cpp, with the built-in symbol tables.
+class HlslCrossCompiler;
+bool PaBuildAST(HlslCrossCompiler*, ETargetVersion, unsigned options);
 
 #endif // _PARSER_HELPER_INCLUDED_
 
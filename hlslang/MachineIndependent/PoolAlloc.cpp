@@ -8,31 +8,24 @@
 
 #include "../Include/InitializeGlobals.h"
 #include "osinclude.h"
+#include <string.h>
 
-static OS_TLSIndex s_TLSPoolAlloc;
+#ifdef POOL_THREAD_LOCAL
 
+POOL_THREAD_LOCAL TPoolAllocator* CurrentPoolAllocator = 0;
 
-void InitializeGlobalPools()
-{
-	TPoolAllocator* alloc = static_cast<TPoolAllocator*>(OS_GetTLSValue(s_TLSPoolAlloc));
-	if (alloc)
-		return;
-	
-	alloc = new TPoolAllocator();
-	OS_SetTLSValue(s_TLSPoolAlloc, alloc);
-	alloc->push();
-}
+static TPoolAllocator* GetPoolTLS() { return CurrentPoolAllocator; }
+static void SetPoolTLS(TPoolAllocator* alloc) { CurrentPoolAllocator = alloc; }
 
-void FreeGlobalPools()
-{
-	TPoolAllocator* alloc = static_cast<TPoolAllocator*>(OS_GetTLSValue(s_TLSPoolAlloc));
-	if (!alloc)
-		return;
+bool InitializePoolIndex() { return true; }
+void FreePoolIndex() { }
 
-	alloc->popAll();
-	delete alloc;
-	OS_SetTLSValue(s_TLSPoolAlloc, NULL);
-}
+#else
+
+static OS_TLSIndex s_TLSPoolAlloc;
+
+static TPoolAllocator* GetPoolTLS() { return static_cast<TPoolAllocator*>(OS_GetTLSValue(s_TLSPoolAlloc)); }
+static void SetPoolTLS(TPoolAllocator* alloc) { OS_SetTLSValue(s_TLSPoolAlloc, alloc); }
 
 bool InitializePoolIndex()
 {
@@ -48,13 +41,37 @@ void FreePoolIndex()
 
 TPoolAllocator& GetGlobalPoolAllocator()
 {
-	TPoolAllocator* alloc = static_cast<TPoolAllocator*>(OS_GetTLSValue(s_TLSPoolAlloc));
-	return *alloc;
+	return *GetPoolTLS();
+}
+
+#endif
+
+
+void InitializeGlobalPools()
+{
+	TPoolAllocator* alloc = GetPoolTLS();
+	if (alloc)
+		return;
+	
+	alloc = new TPoolAllocator();
+	SetPoolTLS(alloc);
+	alloc->push();
+}
+
+void FreeGlobalPools()
+{
+	TPoolAllocator* alloc = GetPoolTLS();
+	if (!alloc)
+		return;
+
+	alloc->popAll();
+	delete alloc;
+	SetPoolTLS(NULL);
 }
 
 void SetGlobalPoolAllocatorPtr(TPoolAllocator* alloc)
 {
-	OS_SetTLSValue(s_TLSPoolAlloc, alloc);
+	SetPoolTLS(alloc);
 }
 
 
@@ -62,32 +79,22 @@ void SetGlobalPoolAllocatorPtr(TPoolAllocator* alloc)
 
 struct TPoolAllocator::AllocHeader
 {
-	AllocHeader(AllocHeader* np, size_t pcount) : nextPage(np), pageCount(pcount) { }
+	AllocHeader(AllocHeader* np, size_t s) : nextPage(np), size(s) { }
 	AllocHeader* nextPage;
-	size_t pageCount;
+	size_t size;            // bytes of the page, header included
 };
 
 
 TPoolAllocator::TPoolAllocator() :
-pageSize(8*1024),
 alignment(16),
+currentPageSize(0),
+currentPageOffset(0),
 freeList(0),
 inUseList(0),
-numCalls(0),
-totalBytes(0)
+hasReusable(false)
 {
-   //
-   // Don't allow page sizes we know are smaller than all common
-   // OS page sizes.
-   //
-   if (pageSize < 4*1024)
-      pageSize = 4*1024;
-
-   //
-   // A large currentPageOffset indicates a new page needs to
-   // be obtained to allocate memory.
-   //
-   currentPageOffset = pageSize;
+   memset(&stats, 0, sizeof(stats));
+   memset(reusable, 0, sizeof(reusable));
 
    //
    // Adjust alignment to be at least pointer aligned and
@@ -111,6 +118,8 @@ totalBytes(0)
    {
       headerSkip = (sizeof(AllocHeader) + alignmentMask) & ~alignmentMask;
    }
+
+   setOptions(TPoolOptions());
 }
 
 TPoolAllocator::~TPoolAllocator()
@@ -120,12 +129,38 @@ TPoolAllocator::~TPoolAllocator()
 	// Always delete the free list memory - it can't be being
 	// (correctly) referenced, whether the pool allocator was
 	// global or not.
-	while (freeList)
-	{
-		AllocHeader* next = freeList->nextPage;
-		delete [] reinterpret_cast<char*>(freeList);
-		freeList = next;
-	}
+	freePages();
+}
+
+void TPoolAllocator::setOptions(const TPoolOptions& o)
+{
+   options = o;
+
+   //
+   // Don't allow page sizes we know are smaller than all common
+   // OS page sizes. Pages are a multiple of the alignment, so a
+   // buffer always takes its size rounded up to the alignment.
+   //
+   if (options.pageSize < 4*1024)
+      options.pageSize = 4*1024;
+   options.pageSize = (options.pageSize + alignmentMask) & ~alignmentMask;
+   if (options.maxPageSize < options.pageSize)
+      options.maxPageSize = options.pageSize;
+   options.maxPageSize = (options.maxPageSize + alignmentMask) & ~alignmentMask;
+   nextPageSize = options.pageSize;
+
+   freePages();
+   clearReusable();
+}
+
+void TPoolAllocator::resetStats()
+{
+   TPoolStats s;
+   memset(&s, 0, sizeof(s));
+   s.bytesReserved = s.peakBytes = stats.bytesReserved;
+   s.freeBytes = stats.freeBytes;
+   s.pages = stats.pages;
+   stats = s;
 }
 
 
@@ -138,7 +173,7 @@ void TPoolAllocator::push()
    //
    // Indicate there is no current page to allocate from.
    //
-   currentPageOffset = pageSize;
+   currentPageOffset = currentPageSize;
 }
 
 //
@@ -146,13 +181,17 @@ void TPoolAllocator::push()
 // that have occurred since the last push(), or since the
 // last pop(), or since the object's creation.
 //
-// The deallocated pages are saved for future allocations.
+// The deallocated pages are saved for future allocations,
+// up to TPoolOptions::keepBytes.
 //
 void TPoolAllocator::pop()
 {
    if (stack.size() < 1)
       return;
 
+   // freed buffers can be in any of the pages going away
+   clearReusable();
+
    AllocHeader* page = stack.back().page;
    currentPageOffset = stack.back().offset;
 
@@ -162,15 +201,12 @@ void TPoolAllocator::pop()
       inUseList->~AllocHeader();
 
       AllocHeader* nextInUse = inUseList->nextPage;
-      if (inUseList->pageCount > 1)
-         delete [] reinterpret_cast<char*>(inUseList);
-      else
-      {
-         inUseList->nextPage = freeList;
-         freeList = inUseList;
-      }
+      stats.bytesReserved -= inUseList->size;
+      --stats.pages;
+      releasePage(inUseList);
       inUseList = nextInUse;
    }
+   currentPageSize = inUseList ? inUseList->size : 0;
 
    stack.pop_back();
 }
@@ -185,21 +221,124 @@ void TPoolAllocator::popAll()
       pop();
 }
 
+void TPoolAllocator::addBytesInUse(size_t bytes)
+{
+   stats.bytesReserved += bytes;
+   ++stats.pages;
+   if (stats.bytesReserved > stats.peakBytes)
+      stats.peakBytes = stats.bytesReserved;
+}
+
+// A page of at least size bytes: a kept one if there is one, else one from the OS.
+TPoolAllocator::AllocHeader* TPoolAllocator::newPage(size_t size, bool large)
+{
+   // a page for small allocations can be any kept page; a block for a large one has to fit it
+   for (AllocHeader** link = &freeList; *link; link = &(*link)->nextPage)
+   {
+      AllocHeader* page = *link;
+      if (page->size >= size)
+      {
+         *link = page->nextPage;
+         stats.freeBytes -= page->size;
+         return page;
+      }
+      if (!large)
+         break;
+   }
+
+   if (!large)
+   {
+      size = nextPageSize;
+      if (nextPageSize < options.maxPageSize)
+         nextPageSize = nextPageSize * 2 < options.maxPageSize ? nextPageSize * 2 : options.maxPageSize;
+   }
+   AllocHeader* memory = reinterpret_cast<AllocHeader*>(::new char[size]);
+   if (memory)
+   {
+      memory->size = size;
+      ++stats.osAllocations;
+   }
+   return memory;
+}
+
+void TPoolAllocator::releasePage(AllocHeader* page)
+{
+   if (stats.freeBytes + page->size > options.keepBytes)
+   {
+      delete [] reinterpret_cast<char*>(page);
+      return;
+   }
+   page->nextPage = freeList;
+   freeList = page;
+   stats.freeBytes += page->size;
+}
+
+void TPoolAllocator::freePages()
+{
+   while (freeList)
+   {
+      AllocHeader* next = freeList->nextPage;
+      delete [] reinterpret_cast<char*>(freeList);
+      freeList = next;
+   }
+   stats.freeBytes = 0;
+}
+
+void TPoolAllocator::addReusable(void* memory, size_t numBytes)
+{
+   // A container must not outlive the partition its buffer was allocated in;
+   // that buffer would be in a page that was popped.
+   assert(inUseListHas(memory));
+
+   void*& list = reusable[(numBytes + alignmentMask) / alignment];
+   *reinterpret_cast<void**>(memory) = list;
+   list = memory;
+   hasReusable = true;
+}
+
+void TPoolAllocator::clearReusable()
+{
+   if (hasReusable)
+      memset(reusable, 0, sizeof(reusable));
+   hasReusable = false;
+}
+
+bool TPoolAllocator::inUseListHas(const void* memory) const
+{
+   for (AllocHeader* page = inUseList; page; page = page->nextPage)
+   {
+      const char* begin = reinterpret_cast<const char*>(page);
+      if (memory >= begin && memory < begin + page->size)
+         return true;
+   }
+   return false;
+}
+
 void* TPoolAllocator::allocate(size_t numBytes)
 {
    size_t allocationSize = numBytes;
 
-   //
-   // Just keep some interesting statistics.
-   //
-   ++numCalls;
-   totalBytes += numBytes;
+   ++stats.allocations;
+   stats.bytesRequested += numBytes;
 
    //
    // Do the allocation, most likely case first, for efficiency.
    // This step could be moved to be inline sometime.
    //
-   if (currentPageOffset + allocationSize <= pageSize)
+   if (hasReusable && allocationSize <= kMaxReusedSize)
+   {
+      void*& list = reusable[(allocationSize + alignmentMask) / alignment];
+      if (list)
+      {
+         void* memory = list;
+         list = *reinterpret_cast<void**>(memory);
+         ++stats.reusedAllocations;
+         stats.bytesReused += numBytes;
+         return memory;
+      }
+   }
+
+   if (currentPageOffset + allocationSize <= currentPageSize)
    {
       //
       // Safe to allocate from currentPageOffset.
@@ -211,22 +350,23 @@ void* TPoolAllocator::allocate(size_t numBytes)
       return memory;
    }
 
-   if (allocationSize + headerSkip > pageSize)
+   if (allocationSize + headerSkip > options.pageSize)
    {
       //
       // Do a multi-page allocation.  Don't mix these with the others.
-      // The OS is efficient and allocating and free-ing multiple pages.
       //
-      size_t numBytesToAlloc = allocationSize + headerSkip;
-      AllocHeader* memory = reinterpret_cast<AllocHeader*>(::new char[numBytesToAlloc]);
+      AllocHeader* memory = newPage(allocationSize + headerSkip, true);
       if (memory == 0)
          return 0;
 
       // Use placement-new to initialize header
-      new(memory) AllocHeader(inUseList, (numBytesToAlloc + pageSize - 1) / pageSize);
+      new(memory) AllocHeader(inUseList, memory->size);
       inUseList = memory;
+      addBytesInUse(memory->size);
+      ++stats.largeAllocations;
 
-      currentPageOffset = pageSize;  // make next allocation come from a new page
+      // make next allocation come from a new page
+      currentPageSize = currentPageOffset = memory->size;
 
       return reinterpret_cast<void*>(reinterpret_cast<UINT_PTR>(memory) + headerSkip);
    }
@@ -234,24 +374,17 @@ void* TPoolAllocator::allocate(size_t numBytes)
    //
    // Need a simple page to allocate from.
    //
-   AllocHeader* memory;
-   if (freeList)
-   {
-      memory = freeList;
-      freeList = freeList->nextPage;
-   }
-   else
-   {
-      memory = reinterpret_cast<AllocHeader*>(::new char[pageSize]);
-      if (memory == 0)
-         return 0;
-   }
+   AllocHeader* memory = newPage(options.pageSize, false);
+   if (memory == 0)
+      return 0;
 
    // Use placement-new to initialize header
-   new(memory) AllocHeader(inUseList, 1);
+   new(memory) AllocHeader(inUseList, memory->size);
    inUseList = memory;
+   addBytesInUse(memory->size);
 
    unsigned char* ret = reinterpret_cast<unsigned char *>(inUseList) + headerSkip;
+   currentPageSize = memory->size;
    currentPageOffset = (headerSkip + allocationSize + alignmentMask) & ~alignmentMask;
 
    return ret;
@@ -1,6 +0,0 @@
-// Copyright (c) The HLSL2GLSLFork Project Authors. All rights reserved.
-// Use of this source code is governed by a BSD-style license that can be
-// found in the LICENSE.txt file.
-
-
-void ir_remove_tree(TIntermNode*);
@@ -0,0 +1,1089 @@
+// Copyright (c) The HLSL2GLSLFork Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE.txt file.
+
+// Scanner that turns the preprocessor's token stream into bison tokens.
+//
+// This used to be a flex scanner (hlslang.l), which kept all of its state in
+// globals. The rules are the same, but all state now lives in a TScanner owned
+// by the PaParseString call, so any number of shaders can be parsed at once on
+// different threads.
+
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "ParseHelper.h"
+#include "IncludeCache.h"
+#include "hlslang_tab.h"
+
+#include "preprocessor/mojoshader.h"
+#define __MOJOSHADER_INTERNAL__ 1
+#include "preprocessor/mojoshader_internal.h"
+
+extern int yyparse(TParseContext&);
+
+const TSourceLoc gNullSourceLoc = { NULL, 0 };
+
+
+struct TScanner
+{
+	TParseContext* parseContext;
+	hlmojo_Preprocessor* cpp;
+	const TPreprocessedSource* source; // tokens to parse instead of running cpp
+	size_t next;
+	TSourceLoc lexlineno;     // location of the preprocessor token being scanned
+	const char* lexfile;      // file name of lexlineno, as the preprocessor gave it
+	int token;                // kind of the preprocessor token being scanned
+	const char* start;        // and its text: nothing of it is scanned yet while cur == start
+	const char* cur;          // rest of the preprocessor token being scanned
+	const char* end;
+	bool eof;
+	bool fields;              // after a '.', an identifier is a field selection
+	std::string text;         // text of the last scanned token, for error messages
+};
+
+
+// --------------------------------------------------------------------------
+// Keywords
+
+
+enum EKeywordKind
+{
+	EKwPlain,
+	EKwType,      // type names; the next identifier can't be a user type
+	EKwTrue,
+	EKwFalse,
+	EKwReserved,
+	EKwIgnored,
+};
+
+struct TKeyword
+{
+	const char* name;
+	int token;
+	EKeywordKind kind;
+};
+
+// sorted by name, looked up with a binary search
+static const TKeyword kKeywords[] = {
+	{ "asm",               0,                 EKwReserved },
+	{ "bool",              BOOL_TYPE,         EKwType },
+	{ "bool1",             BOOL_TYPE,         EKwType },
+	{ "bool2",             BVEC2,             EKwType },
+	{ "bool3",             BVEC3,             EKwType },
+	{ "bool4",             BVEC4,             EKwType },
+	{ "break",             BREAK,             EKwPlain },
+	{ "cast",              0,                 EKwReserved },
+	{ "class",             0,                 EKwReserved },
+	{ "const",             CONST_QUAL,        EKwPlain },
+	{ "continue",          CONTINUE,          EKwPlain },
+	{ "default",           0,                 EKwReserved },
+	{ "discard",           DISCARD,           EKwPlain },
+	{ "do",                DO,                EKwPlain },
+	{ "double",            0,                 EKwReserved },
+	{ "else",              ELSE,              EKwPlain },
+	{ "enum",              0,                 EKwReserved },
+	{ "extern",            0,                 EKwReserved },
+	{ "external",          0,                 EKwReserved },
+	{ "false",             BOOLCONSTANT,      EKwFalse },
+	{ "fixed",             FIXED_TYPE,        EKwType },
+	{ "fixed1",            FIXED_TYPE,        EKwType },
+	{ "fixed2",            FVEC2,             EKwType },
+	{ "fixed2x2",          FMATRIX2x2,        EKwType },
+	{ "fixed2x3",          FMATRIX2x3,        EKwType },
+	{ "fixed2x4",          FMATRIX2x4,        EKwType },
+	{ "fixed3",            FVEC3,             EKwType },
+	{ "fixed3x2",          FMATRIX3x2,        EKwType },
+	{ "fixed3x3",          FMATRIX3x3,        EKwType },
+	{ "fixed3x4",          FMATRIX3x4,        EKwType },
+	{ "fixed4",            FVEC4,             EKwType },
+	{ "fixed4x2",          FMATRIX4x2,        EKwType },
+	{ "fixed4x3",          FMATRIX4x3,        EKwType },
+	{ "fixed4x4",          FMATRIX4x4,        EKwType },
+	{ "float",             FLOAT_TYPE,        EKwType },
+	{ "float1",            FLOAT_TYPE,        EKwType },
+	{ "float2",            VEC2,              EKwType },
+	{ "float2x2",          MATRIX2x2,         EKwType },
+	{ "float2x3",          MATRIX2x3,         EKwType },
+	{ "float2x4",          MATRIX2x4,         EKwType },
+	{ "float3",            VEC3,              EKwType },
+	{ "float3x2",          MATRIX3x2,         EKwType },
+	{ "float3x3",          MATRIX3x3,         EKwType },
+	{ "float3x4",          MATRIX3x4,         EKwType },
+	{ "float4",            VEC4,              EKwType },
+	{ "float4x2",          MATRIX4x2,         EKwType },
+	{ "float4x3",          MATRIX4x3,         EKwType },
+	{ "float4x4",          MATRIX4x4,         EKwType },
+	{ "for",               FOR,               EKwPlain },
+	{ "goto",              0,                 EKwReserved },
+	{ "half",              HALF_TYPE,         EKwType },
+	{ "half1",             HALF_TYPE,         EKwType },
+	{ "half2",             HVEC2,             EKwType },
+	{ "half2x2",           HMATRIX2x2,        EKwType },
+	{ "half2x3",           HMATRIX2x3,        EKwType },
+	{ "half2x4",           HMATRIX2x4,        EKwType },
+	{ "half3",             HVEC3,             EKwType },
+	{ "half3x2",           HMATRIX3x2,        EKwType },
+	{ "half3x3",           HMATRIX3x3,        EKwType },
+	{ "half3x4",           HMATRIX3x4,        EKwType },
+	{ "half4",             HVEC4,             EKwType },
+	{ "half4x2",           HMATRIX4x2,        EKwType },
+	{ "half4x3",           HMATRIX4x3,        EKwType },
+	{ "half4x4",           HMATRIX4x4,        EKwType },
+	{ "if",                IF,                EKwPlain },
+	{ "in",                IN_QUAL,           EKwPlain },
+	{ "inline",            0,                 EKwIgnored },
+	{ "inout",             INOUT_QUAL,        EKwPlain },
+	{ "int",               INT_TYPE,          EKwType },
+	{ "int1",              INT_TYPE,          EKwType },
+	{ "int2",              IVEC2,             EKwType },
+	{ "int3",              IVEC3,             EKwType },
+	{ "int4",              IVEC4,             EKwType },
+	{ "interface",         0,                 EKwReserved },
+	{ "long",              0,                 EKwReserved },
+	{ "matrix",            MATRIX,            EKwType },
+	{ "namespace",         0,                 EKwReserved },
+	{ "noinline",          0,                 EKwIgnored },
+	{ "out",               OUT_QUAL,          EKwPlain },
+	{ "packed",            0,                 EKwReserved },
+	{ "public",            0,                 EKwReserved },
+	{ "register",          REGISTER,          EKwType },
+	{ "return",            RETURN,            EKwPlain },
+	{ "sampler",           SAMPLERGENERIC,    EKwType },
+	{ "sampler1D",         SAMPLER1D,         EKwType },
+	{ "sampler1DShadow",   SAMPLER1DSHADOW,   EKwType },
+	{ "sampler2D",         SAMPLER2D,         EKwType },
+	{ "sampler2DArray",    SAMPLER2DARRAY,    EKwType },
+	{ "sampler2DShadow",   SAMPLER2DSHADOW,   EKwType },
+	{ "sampler2D_float",   SAMPLER2D_FLOAT,   EKwType },
+	{ "sampler2D_half",    SAMPLER2D_HALF,    EKwType },
+	{ "sampler3D",         SAMPLER3D,         EKwType },
+	{ "sampler3DRect",     0,                 EKwReserved },
+	{ "samplerCUBE",       SAMPLERCUBE,       EKwType },
+	{ "samplerCUBE_float", SAMPLERCUBE_FLOAT, EKwType },
+	{ "samplerCUBE_half",  SAMPLERCUBE_HALF,  EKwType },
+	{ "samplerRECT",       SAMPLERRECT,       EKwType },
+	{ "samplerRECTShadow", SAMPLERRECTSHADOW, EKwType },
+	{ "sampler_state",     SAMPLERSTATE,      EKwType },
+	{ "short",             0,                 EKwReserved },
+	{ "sizeof",            0,                 EKwReserved },
+	{ "static",            STATIC_QUAL,       EKwPlain },
+	{ "string",            STRING_TYPE,       EKwType },
+	{ "struct",            STRUCT,            EKwPlain },
+	{ "switch",            0,                 EKwReserved },
+	{ "template",          0,                 EKwReserved },
+	{ "texture",           TEXTURE,           EKwType },
+	{ "texture2D",         TEXTURE,           EKwType },
+	{ "texture3D",         TEXTURE,           EKwType },
+	{ "textureCUBE",       TEXTURE,           EKwType },
+	{ "textureRECT",       TEXTURE,           EKwType },
+	{ "this",              0,                 EKwReserved },
+	{ "true",              BOOLCONSTANT,      EKwTrue },
+	{ "typedef",           0,                 EKwReserved },
+	{ "uint",              INT_TYPE,          EKwType },
+	{ "uint1",             INT_TYPE,          EKwType },
+	{ "uint2",             IVEC2,             EKwType },
+	{ "uint3",             IVEC3,             EKwType },
+	{ "uint4",             IVEC4,             EKwType },
+	{ "uniform",           UNIFORM,           EKwPlain },
+	{ "union",             0,                 EKwReserved },
+	{ "unsigned",          0,                 EKwReserved },
+	{ "using",             0,                 EKwReserved },
+	{ "vector",            VECTOR,            EKwType },
+	{ "void",              VOID_TYPE,         EKwType },
+	{ "volatile",          0,                 EKwReserved },
+	{ "while",             WHILE,             EKwPlain },
+};
+
+static const TKeyword* FindKeyword(const char* name)
+{
+	int lo = 0;
+	int hi = int(sizeof(kKeywords) / sizeof(kKeywords[0])) - 1;
+	while (lo <= hi)
+	{
+		const int mid = (lo + hi) / 2;
+		const int cmp = strcmp(name, kKeywords[mid].name);
+		if (cmp == 0)
+			return &kKeywords[mid];
+		if (cmp < 0)
+			hi = mid - 1;
+		else
+			lo = mid + 1;
+	}
+	return NULL;
+}
+
+
+// Operators and punctuation; longer ones first, so the first match is the longest.
+struct TOperatorToken
+{
+	const char* text;
+	int token;
+};
+
+static const TOperatorToken kOperators[] = {
+	{ "<<=", LEFT_ASSIGN },
+	{ ">>=", RIGHT_ASSIGN },
+	{ "+=", ADD_ASSIGN },
+	{ "-=", SUB_ASSIGN },
+	{ "*=", MUL_ASSIGN },
+	{ "/=", DIV_ASSIGN },
+	{ "%=", MOD_ASSIGN },
+	{ "&=", AND_ASSIGN },
+	{ "^=", XOR_ASSIGN },
+	{ "|=", OR_ASSIGN },
+	{ "++", INC_OP },
+	{ "--", DEC_OP },
+	{ "&&", AND_OP },
+	{ "||", OR_OP },
+	{ "^^", XOR_OP },
+	{ "<=", LE_OP },
+	{ ">=", GE_OP },
+	{ "==", EQ_OP },
+	{ "!=", NE_OP },
+	{ "<<", LEFT_OP },
+	{ ">>", RIGHT_OP },
+	{ ";", SEMICOLON },
+	{ "{", LEFT_BRACE },
+	{ "}", RIGHT_BRACE },
+	{ ",", COMMA },
+	{ ":", COLON },
+	{ "=", EQUAL },
+	{ "(", LEFT_PAREN },
+	{ ")", RIGHT_PAREN },
+	{ "[", LEFT_BRACKET },
+	{ "]", RIGHT_BRACKET },
+	{ ".", DOT },
+	{ "!", BANG },
+	{ "-", DASH },
+	{ "~", TILDE },
+	{ "+", PLUS },
+	{ "*", STAR },
+	{ "/", SLASH },
+	{ "%", PERCENT },
+	{ "<", LEFT_ANGLE },
+	{ ">", RIGHT_ANGLE },
+	{ "|", VERTICAL_BAR },
+	{ "^", CARET },
+	{ "&", AMPERSAND },
+	{ "?", QUESTION },
+};
+
+// The token for a whole preprocessor token that is an operator, 0 if it isn't
+// one of ours. Same as looking its text up in kOperators.
+static int DirectOperator(int ppToken)
+{
+	switch (ppToken)
+	{
+	case TOKEN_LSHIFTASSIGN: return LEFT_ASSIGN;
+	case TOKEN_RSHIFTASSIGN: return RIGHT_ASSIGN;
+	case TOKEN_ADDASSIGN: return ADD_ASSIGN;
+	case TOKEN_SUBASSIGN: return SUB_ASSIGN;
+	case TOKEN_MULTASSIGN: return MUL_ASSIGN;
+	case TOKEN_DIVASSIGN: return DIV_ASSIGN;
+	case TOKEN_MODASSIGN: return MOD_ASSIGN;
+	case TOKEN_ANDASSIGN: return AND_ASSIGN;
+	case TOKEN_XORASSIGN: return XOR_ASSIGN;
+	case TOKEN_ORASSIGN: return OR_ASSIGN;
+	case TOKEN_INCREMENT: return INC_OP;
+	case TOKEN_DECREMENT: return DEC_OP;
+	case TOKEN_ANDAND: return AND_OP;
+	case TOKEN_OROR: return OR_OP;
+	case TOKEN_LEQ: return LE_OP;
+	case TOKEN_GEQ: return GE_OP;
+	case TOKEN_EQL: return EQ_OP;
+	case TOKEN_NEQ: return NE_OP;
+	case TOKEN_LSHIFT: return LEFT_OP;
+	case TOKEN_RSHIFT: return RIGHT_OP;
+	case ';': return SEMICOLON;
+	case '{': return LEFT_BRACE;
+	case '}': return RIGHT_BRACE;
+	case ',': return COMMA;
+	case ':': return COLON;
+	case '=': return EQUAL;
+	case '(': return LEFT_PAREN;
+	case ')': return RIGHT_PAREN;
+	case '[': return LEFT_BRACKET;
+	case ']': return RIGHT_BRACKET;
+	case '.': return DOT;
+	case '!': return BANG;
+	case '-': return DASH;
+	case '~': return TILDE;
+	case '+': return PLUS;
+	case '*': return STAR;
+	case '/': return SLASH;
+	case '%': return PERCENT;
+	case '<': return LEFT_ANGLE;
+	case '>': return RIGHT_ANGLE;
+	case '|': return VERTICAL_BAR;
+	case '^': return CARET;
+	case '&': return AMPERSAND;
+	case '?': return QUESTION;
+	default: return 0;
+	}
+}
+
+
+// --------------------------------------------------------------------------
+// Input
+
+
+//
+// Fetch the next token from the preprocessor into the scanner. Returns false
+// at the end of input, or on a preprocessing error (which ends the parse, too).
+//
+static bool cpp_get_token (TScanner& scanner)
+{
+	TParseContext& parseContext = *scanner.parseContext;
+
+	const char *tokstr = NULL;
+	unsigned int len = 0;
+	Token token = TOKEN_UNKNOWN;
+	const char* file = NULL;
+	unsigned int line = 0;
+	if (scanner.source)
+	{
+		// replaying the tokens of an earlier PaPreprocess
+		const TPreprocessedSource& source = *scanner.source;
+		if (scanner.next == source.tokens.size())
+		{
+			if (source.outOfMemory)
+			{
+				parseContext.error (gNullSourceLoc, "out of memory", "", "");
+				parseContext.recover();
+			}
+			return false;
+		}
+		const TPreprocessedToken& t = source.tokens[scanner.next++];
+		tokstr = source.text.data() + t.offset;
+		len = t.length;
+		token = Token(t.token);
+		file = t.file;
+		line = t.line;
+	}
+	else
+	{
+		hlmojo_Preprocessor* pp = scanner.cpp;
+		tokstr = hlmojo_preprocessor_nexttoken (pp, &len, &token);
+		if (tokstr == NULL)
+			return false;
+
+		if (hlmojo_preprocessor_outofmemory(pp))
+		{
+			parseContext.error (gNullSourceLoc, "out of memory", "", "");
+			parseContext.recover();
+			return false;
+		}
+
+		file = hlmojo_preprocessor_sourcepos (pp, &line);
+	}
+
+	// File names are interned by the preprocessor (and by PaPreprocess), so the
+	// pool copy of the name is only made again when the file changes.
+	if (file == scanner.lexfile)
+		scanner.lexlineno.line = line;
+	else
+	{
+		TSourceLoc loc = { file, int(line) };
+		SetLineNumber (loc, scanner.lexlineno);
+		scanner.lexfile = file;
+	}
+
+	if (token == TOKEN_PREPROCESSING_ERROR)
+	{
+		parseContext.error (scanner.lexlineno, tokstr, "", "");
+		parseContext.recover();
+		return false;
+	}
+
+	scanner.token = token;
+	scanner.start = scanner.cur = tokstr;
+	scanner.end = tokstr + len;
+	return len > 0;
+}
+
+// Make sure there are characters left to scan; false at the end of input.
+static bool FillScanner(TScanner& scanner)
+{
+	while (scanner.cur == scanner.end)
+	{
+		if (scanner.eof)
+			return false;
+		if (!cpp_get_token(scanner))
+		{
+			scanner.eof = true;
+			return false;
+		}
+	}
+	return true;
+}
+
+// Character n places ahead in the current preprocessor token, 0 past its end.
+static inline int Peek(const TScanner& scanner, int n)
+{
+	return scanner.cur + n < scanner.end ? (unsigned char)scanner.cur[n] : 0;
+}
+
+static inline void Consume(TScanner& scanner, int n)
+{
+	scanner.text.assign(scanner.cur, n);
+	scanner.cur += n;
+}
+
+static inline bool IsLetter(int c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+static inline bool IsDigit(int c) { return c >= '0' && c <= '9'; }
+static inline bool IsHexDigit(int c) { return IsDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+static inline bool IsOctDigit(int c) { return c >= '0' && c <= '7'; }
+static inline bool IsFloatSuffix(int c) { return c == 'h' || c == 'H' || c == 'f' || c == 'F'; }
+static inline bool IsIntSuffix(int c) { return c == 'u' || c == 'U' || c == 'l' || c == 'L'; }
+static inline bool IsSpace(int c) { return c == ' ' || c == '\t' || c == '\v' || c == '\n' || c == '\f' || c == '\r'; }
+
+static int IdentifierLength(const TScanner& scanner)
+{
+	int n = 1;
+	while (IsLetter(Peek(scanner, n)) || IsDigit(Peek(scanner, n)))
+		++n;
+	return n;
+}
+
+static int DigitsLength(const TScanner& scanner, int n)
+{
+	const int start = n;
+	while (IsDigit(Peek(scanner, n)))
+		++n;
+	return n - start;
+}
+
+// Length of an exponent ([Ee][+-]?[0-9]+) starting at n, 0 if there is none.
+static int ExponentLength(const TScanner& scanner, int n)
+{
+	const int c = Peek(scanner, n);
+	if (c != 'e' && c != 'E')
+		return 0;
+	int i = n + 1;
+	if (Peek(scanner, i) == '+' || Peek(scanner, i) == '-')
+		++i;
+	const int digits = DigitsLength(scanner, i);
+	return digits ? i + digits - n : 0;
+}
+
+
+// --------------------------------------------------------------------------
+// Scanning
+
+
+static void PaReservedWord(TParseContext& parseContext)
+{
+	parseContext.error(parseContext.scanner->lexlineno, "Reserved word.", parseContext.scanner->text.c_str(), "", "");
+	parseContext.recover();
+}
+
+static int PaIdentOrType(const TString* atom, TParseContext& parseContextLocal, TSymbol*& symbol)
+{
+    symbol = parseContextLocal.symbolTable.findAtom(atom);
+    if (parseContextLocal.lexAfterType == false && symbol && symbol->isVariable()) {
+        TVariable* variable = static_cast<TVariable*>(symbol);
+        if (variable->isUserType()) {
+            parseContextLocal.lexAfterType = true;
+            return TYPE_NAME;
+        }
+    }
+
+    return IDENTIFIER;
+}
+
+static int UnknownChar(TScanner& scanner)
+{
+	Consume(scanner, 1);
+	scanner.parseContext->infoSink.info << "FLEX: Unknown char " << scanner.text.c_str() << "\n";
+	return 0;
+}
+
+// Numeric literals; picks the longest match, like the flex rules did.
+static int ScanNumber(TScanner& scanner, YYSTYPE* pyylval)
+{
+	TParseContext& parseContext = *scanner.parseContext;
+	const int c = Peek(scanner, 0);
+	const int digits = DigitsLength(scanner, 0);
+
+	// float: 1e5 1.0 .5 1f (all with optional h/f suffix)
+	int floatLen = 0;
+	if (digits && Peek(scanner, digits) == '.')
+	{
+		const int n = digits + 1 + DigitsLength(scanner, digits + 1);
+		floatLen = n + ExponentLength(scanner, n);
+	}
+	else if (c == '.')
+	{
+		const int n = 1 + DigitsLength(scanner, 1);
+		floatLen = n + ExponentLength(scanner, n);
+	}
+	else if (ExponentLength(scanner, digits))
+		floatLen = digits + ExponentLength(scanner, digits);
+	else if (IsFloatSuffix(Peek(scanner, digits)))
+		floatLen = digits;
+	if (floatLen && IsFloatSuffix(Peek(scanner, floatLen)))
+		++floatLen;
+
+	// integer: 0x1F, 017, 123 (all with optional u/l suffix); 019 is an error
+	int intLen = 0;
+	bool badOctal = false;
+	if (c == '0' && (Peek(scanner, 1) == 'x' || Peek(scanner, 1) == 'X') && IsHexDigit(Peek(scanner, 2)))
+	{
+		intLen = 3;
+		while (IsHexDigit(Peek(scanner, intLen)))
+			++intLen;
+	}
+	else if (c == '0' && digits > 1)
+	{
+		int octal = 1;
+		while (IsOctDigit(Peek(scanner, octal)))
+			++octal;
+		intLen = digits;
+		badOctal = octal != digits;
+	}
+	else if (digits)
+		intLen = digits;
+	if (intLen && IsIntSuffix(Peek(scanner, intLen)))
+		++intLen;
+
+	pyylval->lex.line = scanner.lexlineno;
+	if (floatLen >= intLen)
+	{
+		Consume(scanner, floatLen);
+		pyylval->lex.f = static_cast<float>(atof(scanner.text.c_str()));
+		return FLOATCONSTANT;
+	}
+
+	Consume(scanner, intLen);
+	if (badOctal)
+	{
+		parseContext.error(scanner.lexlineno, "Invalid Octal number.", scanner.text.c_str(), "", "");
+		parseContext.recover();
+		return 0;
+	}
+	pyylval->lex.i = strtol(scanner.text.c_str(), 0, 0);
+	return INTCONSTANT;
+}
+
+// Skip a /* */ comment that started at the current position.
+static bool SkipComment(TScanner& scanner)
+{
+	scanner.cur += 2;
+	bool star = false;
+	while (FillScanner(scanner))
+	{
+		const char c = *scanner.cur++;
+		if (c == '/' && star)
+			return true;
+		star = (c == '*');
+	}
+	scanner.parseContext->error(scanner.lexlineno, "End of shader found before end of comment.", "", "", "");
+	scanner.parseContext->recover();
+	return false;
+}
+
+// An identifier, keyword or field selection of len characters; -1 for ignored keywords.
+static int IdentifierToken(TScanner& scanner, YYSTYPE* pyylval, int len)
+{
+	TParseContext& parseContext = *scanner.parseContext;
+	Consume(scanner, len);
+	if (scanner.fields)
+	{
+		scanner.fields = false;
+		pyylval->lex.line = scanner.lexlineno;
+		pyylval->lex.string = NewPoolTString(scanner.text.c_str());
+		return FIELD_SELECTION;
+	}
+
+	const TKeyword* kw = FindKeyword(scanner.text.c_str());
+	if (!kw)
+	{
+		// identifiers are interned, so symbols and the AST share one string per name
+		const TString* atom = parseContext.symbolTable.intern(scanner.text.c_str(), scanner.text.size());
+		pyylval->lex.line = scanner.lexlineno;
+		pyylval->lex.string = const_cast<TString*>(atom);
+		return PaIdentOrType(atom, parseContext, pyylval->lex.symbol);
+	}
+	switch (kw->kind)
+	{
+	case EKwIgnored:
+		return -1;
+	case EKwReserved:
+		PaReservedWord(parseContext);
+		return 0;
+	case EKwType:
+		parseContext.lexAfterType = true;
+		break;
+	case EKwTrue:
+		pyylval->lex.b = true;
+		break;
+	case EKwFalse:
+		pyylval->lex.b = false;
+		break;
+	default:
+		break;
+	}
+	pyylval->lex.line = scanner.lexlineno;
+	return kw->token;
+}
+
+// An operator or punctuation token of len characters.
+static int OperatorToken(TScanner& scanner, YYSTYPE* pyylval, int token, int len)
+{
+	TParseContext& parseContext = *scanner.parseContext;
+	Consume(scanner, len);
+	if (token == DOT)
+	{
+		scanner.fields = true;
+		return DOT;
+	}
+
+	pyylval->lex.line = scanner.lexlineno;
+	switch (token)
+	{
+	case SEMICOLON:
+	case LEFT_BRACE:
+	case EQUAL:
+		parseContext.lexAfterType = false;
+		break;
+	case COMMA:
+		if (parseContext.inTypeParen)
+			parseContext.lexAfterType = false;
+		break;
+	case LEFT_PAREN:
+		parseContext.lexAfterType = false;
+		parseContext.inTypeParen = true;
+		break;
+	case RIGHT_PAREN:
+		parseContext.inTypeParen = false;
+		break;
+	}
+	return token;
+}
+
+int yylex(YYSTYPE* pyylval, TParseContext& parseContext)
+{
+	TScanner& scanner = *parseContext.scanner;
+
+	for (;;)
+	{
+		if (!FillScanner(scanner))
+		{
+			parseContext.AfterEOF = true;
+			return 0;
+		}
+
+		// Identifiers, operators and whitespace come from the preprocessor as whole
+		// tokens of the same kind as ours, so they don't need scanning again.
+		// Anything else is scanned character by character, as is the rest of a
+		// token that the scan below has started on.
+		if (scanner.cur == scanner.start)
+		{
+			const int len = int(scanner.end - scanner.cur);
+			if (scanner.token == TOKEN_IDENTIFIER)
+			{
+				const int token = IdentifierToken(scanner, pyylval, len);
+				if (token < 0)
+					continue;
+				return token;
+			}
+			if (!scanner.fields)
+			{
+				if (scanner.token == ' ' || scanner.token == '\n')
+				{
+					scanner.cur = scanner.end;
+					continue;
+				}
+				const int token = DirectOperator(scanner.token);
+				if (token)
+					return OperatorToken(scanner, pyylval, token, len);
+			}
+		}
+
+		const int c = Peek(scanner, 0);
+
+		if (scanner.fields)
+		{
+			if (IsLetter(c))
+				return IdentifierToken(scanner, pyylval, IdentifierLength(scanner));
+			if (IsSpace(c) && c != '\n')
+			{
+				++scanner.cur;
+				continue;
+			}
+			return UnknownChar(scanner);
+		}
+
+		if (IsSpace(c))
+		{
+			++scanner.cur;
+			continue;
+		}
+
+		if (IsLetter(c))
+		{
+			const int token = IdentifierToken(scanner, pyylval, IdentifierLength(scanner));
+			if (token < 0)
+				continue;
+			return token;
+		}
+
+		if (IsDigit(c) || (c == '.' && IsDigit(Peek(scanner, 1))))
+			return ScanNumber(scanner, pyylval);
+
+		if (c == '"')
+		{
+			const char* close = (const char*)memchr(scanner.cur + 1, '"', scanner.end - scanner.cur - 1);
+			if (close)
+			{
+				Consume(scanner, int(close - scanner.cur) + 1);
+				pyylval->lex.line = scanner.lexlineno;
+				return STRINGCONSTANT;
+			}
+			return UnknownChar(scanner);
+		}
+
+		if (c == '/' && Peek(scanner, 1) == '*')
+		{
+			if (!SkipComment(scanner))
+				return 0;
+			continue;
+		}
+
+		for (size_t i = 0; i < sizeof(kOperators) / sizeof(kOperators[0]); ++i)
+		{
+			const char* op = kOperators[i].text;
+			if (op[0] != c || (op[1] && (op[1] != Peek(scanner, 1) || (op[2] && op[2] != Peek(scanner, 2)))))
+				continue;
+
+			return OperatorToken(scanner, pyylval, kOperators[i].token, int(strlen(op)));
+		}
+
+		return UnknownChar(scanner);
+	}
+}
+
+void yyerror(TParseContext& parseContext, const char *s)
+{
+	TScanner& scanner = *parseContext.scanner;
+	parseContext.error(scanner.lexlineno, "syntax error", parseContext.AfterEOF ? "" : scanner.text.c_str(), s, "");
+	parseContext.recover();
+}
+
+
+// --------------------------------------------------------------------------
+// Parsing
+
+
+// The include callbacks of one preprocessor run. The preprocessor lexes include
+// files where they are; files are only copied when the callback returns them in a
+// string, or when they don't end with a newline (the lexer can look a few bytes past
+// the end of a token that runs into the end of the text).
+struct TIncludeCallbacks
+{
+	struct TCopy
+	{
+		const char* text; // what the close callback gets
+		std::string* copy;
+	};
+
+	const TParseCallbacks* callbacks;
+	std::map<const char*, TCopy> copies; // by the pointer the preprocessor got
+};
+
+static int IncludeOpenCallback(MOJOSHADER_hlslang_includeType inctype,
+                               const char *fname, const char *parentfname, const char *parent,
+                               const char **outdataPtr, unsigned int *outbytesPtr,
+                               MOJOSHADER_hlslang_malloc m, MOJOSHADER_hlslang_free f, void *d)
+{
+	TIncludeCallbacks* includes = reinterpret_cast<TIncludeCallbacks*>(d);
+	const TParseCallbacks* callbacks = includes->callbacks;
+	const bool isSystem = inctype == MOJOSHADER_hlslang_INCLUDETYPE_SYSTEM;
+
+	TIncludeCallbacks::TCopy file;
+	if (callbacks->openRef)
+	{
+		const char* text = NULL;
+		size_t length = 0;
+		if (!callbacks->openRef(isSystem, fname, parentfname, parent, &text, &length, callbacks->data))
+			return 0;
+		if (text && (length == 0 || text[length - 1] == '\n'))
+		{
+			*outdataPtr = text;
+			*outbytesPtr = (unsigned int)length;
+			return 1;
+		}
+		file.text = text;
+		file.copy = text ? new std::string(text, length) : new std::string();
+	}
+	else
+	{
+		file.copy = new std::string();
+		if (callbacks->open &&
+			!callbacks->open(isSystem, fname, parentfname, parent, *file.copy, callbacks->data))
+		{
+			delete file.copy;
+			return 0;
+		}
+		file.text = file.copy->c_str();
+	}
+
+	*outdataPtr = file.copy->c_str();
+	*outbytesPtr = (unsigned int)file.copy->size();
+	includes->copies[*outdataPtr] = file;
+	return 1;
+}
+
+static void IncludeCloseCallback(const char *data,
+                                 MOJOSHADER_hlslang_malloc m, MOJOSHADER_hlslang_free f, void *d)
+{
+	TIncludeCallbacks* includes = reinterpret_cast<TIncludeCallbacks*>(d);
+	const TParseCallbacks* callbacks = includes->callbacks;
+
+	std::map<const char*, TIncludeCallbacks::TCopy>::iterator it = includes->copies.find(data);
+	if (it == includes->copies.end())
+	{
+		if (callbacks->close)
+			callbacks->close(data, callbacks->data);
+		return;
+	}
+	if (callbacks->close)
+		callbacks->close(it->second.text, callbacks->data);
+	delete it->second.copy;
+	includes->copies.erase(it);
+}
+
+static const hlmojo_CachedToken* IncludeCacheOpen(const char* fname, const char* source, unsigned int sourceLen,
+                                                  unsigned int* count, void** handle, void* data)
+{
+	return reinterpret_cast<TIncludeCache*>(data)->open(fname, source, sourceLen, count, handle);
+}
+
+static void IncludeCacheClose(void* handle, void* data)
+{
+	reinterpret_cast<TIncludeCache*>(data)->close(handle);
+}
+
+static hlmojo_Preprocessor* StartPreprocessor(const char* source, size_t sourceLen, TIncludeCallbacks& includes,
+	const Hlsl2Glsl_Define* defines = NULL, int defineCount = 0, TIncludeCache* includeCache = NULL, bool cacheSource = false)
+{
+	MOJOSHADER_hlslang_includeOpen openCallback = NULL;
+	MOJOSHADER_hlslang_includeClose closeCallback = NULL;
+	void* data = NULL;
+	if (includes.callbacks)
+	{
+		openCallback = IncludeOpenCallback;
+		closeCallback = IncludeCloseCallback;
+		data = &includes;
+	}
+
+	std::vector<MOJOSHADER_hlslang_preprocessorDefine> ppDefines(defineCount > 0 ? defineCount : 0);
+	for (size_t i = 0; i < ppDefines.size(); ++i)
+	{
+		ppDefines[i].identifier = defines[i].name;
+		ppDefines[i].definition = defines[i].value ? defines[i].value : "1";
+	}
+
+	hlmojo_TokenCache tokenCache;
+	tokenCache.open = IncludeCacheOpen;
+	tokenCache.close = IncludeCacheClose;
+	tokenCache.data = includeCache;
+	tokenCache.main_source = cacheSource;
+
+	return hlmojo_preprocessor_start("", source, (unsigned int)sourceLen,
+		openCallback,
+		closeCallback,
+		ppDefines.empty() ? NULL : &ppDefines[0],
+		(unsigned int)ppDefines.size(),
+		includeCache ? &tokenCache : NULL,
+		MOJOSHADER_hlslang_internal_malloc,
+		MOJOSHADER_hlslang_internal_free,
+		data);
+}
+
+static int ParseScanner(TScanner& scanner, TParseContext& parseContextLocal)
+{
+	scanner.parseContext = &parseContextLocal;
+	scanner.lexlineno.file = NULL;
+	scanner.lexlineno.line = 1;
+	scanner.lexfile = NULL;
+	scanner.token = TOKEN_UNKNOWN;
+	scanner.start = scanner.cur = scanner.end = NULL;
+	scanner.eof = false;
+	scanner.fields = false;
+
+	parseContextLocal.scanner = &scanner;
+	parseContextLocal.AfterEOF = false;
+
+	yyparse(parseContextLocal);
+
+	int result = 0;
+	if (parseContextLocal.recoveredFromError || parseContextLocal.numErrors > 0)
+		result = 1;
+
+	parseContextLocal.scanner = NULL;
+	return result;
+}
+
+//
+// Parse a string using yyparse.
+//
+// Returns 0 for success, as per yyparse().
+//
+int PaParseString(char* source, TParseContext& parseContextLocal, const TParseCallbacks* callbacks)
+{
+	if (!source) {
+		parseContextLocal.error(gNullSourceLoc, "Null shader source string", "", "");
+		parseContextLocal.recover();
+		return 1;
+	}
+
+	TIncludeCallbacks includes;
+	includes.callbacks = callbacks;
+
+	TScanner scanner;
+	scanner.cpp = StartPreprocessor(source, strlen(source), includes);
+	scanner.source = NULL;
+	scanner.next = 0;
+
+	int result = ParseScanner(scanner, parseContextLocal);
+
+	hlmojo_preprocessor_end (scanner.cpp);
+
+	return result;
+}
+
+//
+// Run the preprocessor over a whole string, keeping its tokens. Preprocessing
+// stops where the parser would stop fetching tokens: at the end of the input,
+// or at an error, which is kept as a token to be reported when parsing.
+//
+void PaPreprocess(const char* source, size_t length, TPreprocessedSource& out, const TParseCallbacks* callbacks,
+                  const Hlsl2Glsl_Define* defines, int defineCount, TIncludeCache* includeCache, bool cacheSource)
+{
+	if (!source)
+		return;
+
+	TIncludeCallbacks includes;
+	includes.callbacks = callbacks;
+
+	hlmojo_Preprocessor* pp = StartPreprocessor(source, length, includes, defines, defineCount, includeCache, cacheSource);
+	for (;;)
+	{
+		unsigned int len = 0;
+		Token token = TOKEN_UNKNOWN;
+		const char* tokstr = hlmojo_preprocessor_nexttoken (pp, &len, &token);
+		if (tokstr == NULL)
+			break;
+		if (hlmojo_preprocessor_outofmemory(pp))
+		{
+			out.outOfMemory = true;
+			break;
+		}
+
+		TPreprocessedToken t;
+		t.token = token;
+		t.offset = (unsigned int)out.text.size();
+		t.length = len;
+		unsigned int line = 0;
+		const char* fname = hlmojo_preprocessor_sourcepos (pp, &line);
+		t.file = fname ? out.files.insert(fname).first->c_str() : NULL;
+		t.line = line;
+		out.text.append (tokstr, len);
+		out.tokens.push_back (t);
+
+		if (token == TOKEN_PREPROCESSING_ERROR || len == 0)
+			break;
+	}
+	out.skippedIncludes = hlmojo_preprocessor_skipped_includes (pp);
+	hlmojo_preprocessor_end (pp);
+}
+
+// Report a preprocessing error the way parsing the tokens would.
+static void PreprocessingError(TInfoSinkBase& info, TSourceLoc loc, const std::string& reason)
+{
+	info.location(loc);
+	info.prefix(EPrefixError);
+	info << "'' : " << reason << " \n";
+}
+
+//
+// Write the tokens of a PaPreprocess call back out as source text, one line for
+// each line they came from, and a #line wherever the file changes or lines don't
+// follow on, so that parsing the text gives the same locations. Returns false on
+// a preprocessing error, which goes to the info sink as parsing would report it;
+// the text then stops there.
+//
+bool PaPreprocessedText(const TPreprocessedSource& source, std::string& text, TInfoSinkBase& info)
+{
+	// longer runs of blank lines become a #line
+	const unsigned int kMaxBlankLines = 8;
+
+	text.reserve(text.size() + source.text.size() + source.tokens.size() + 1);
+	const char* file = "";  // the shader itself has no name
+	unsigned int line = 1;
+	bool lineStart = true;
+	bool success = true;
+	for (size_t i = 0; i < source.tokens.size(); ++i)
+	{
+		const TPreprocessedToken& t = source.tokens[i];
+		if (t.token == TOKEN_PREPROCESSING_ERROR)
+		{
+			TSourceLoc loc = { t.file, int(t.line) };
+			PreprocessingError(info, loc, std::string(source.text, t.offset, t.length));
+			success = false;
+			break;
+		}
+		if (t.length == 0)
+			break;
+
+		const char* tokenFile = t.file ? t.file : "";
+		if ((tokenFile != file && strcmp(tokenFile, file) != 0) || t.line < line || t.line > line + kMaxBlankLines)
+		{
+			std::stringstream directive;
+			if (!lineStart)
+				directive << '\n';
+			directive << "#line " << t.line << " \"" << tokenFile << "\"\n";
+			text += directive.str();
+			file = tokenFile;
+			line = t.line;
+			lineStart = true;
+		}
+		else if (t.line > line)
+		{
+			text.append(t.line - line, '\n');
+			line = t.line;
+			lineStart = true;
+		}
+
+		if (!lineStart)
+			text += ' ';
+		text.append(source.text, t.offset, t.length);
+		lineStart = false;
+	}
+	if (!lineStart)
+		text += '\n';
+
+	if (source.outOfMemory)
+	{
+		PreprocessingError(info, gNullSourceLoc, "out of memory");
+		success = false;
+	}
+	return success;
+}
+
+//
+// Parse the tokens of a PaPreprocess call. Returns 0 for success, like PaParseString.
+//
+int PaParseTokens(const TPreprocessedSource& source, TParseContext& parseContextLocal)
+{
+	TScanner scanner;
+	scanner.cpp = NULL;
+	scanner.source = &source;
+	scanner.next = 0;
+
+	return ParseScanner(scanner, parseContextLocal);
+}
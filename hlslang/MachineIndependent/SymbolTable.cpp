@@ -5,18 +5,124 @@
 
 #include "SymbolTable.h"
 #include <algorithm>
+#include <string.h>
 
 TString* TParameter::NullSemantic = 0;
 
-bool TSymbolTableLevel::insert(TSymbol& symbol) 
+unsigned int TAtomTable::hash(const char* name, size_t length)
+{
+	// FNV-1a
+	unsigned int h = 2166136261u;
+	for (size_t i = 0; i < length; ++i)
+		h = (h ^ static_cast<unsigned char>(name[i])) * 16777619u;
+	return h;
+}
+
+const TString* TAtomTable::find(const char* name, size_t length, unsigned int h) const
+{
+	if (parent)
+	{
+		const TString* atom = parent->find(name, length, h);
+		if (atom)
+			return atom;
+	}
+	if (slots.empty())
+		return 0;
+
+	const size_t mask = slots.size() - 1;
+	for (size_t i = h & mask; slots[i].atom; i = (i + 1) & mask)
+	{
+		const TString* atom = slots[i].atom;
+		if (slots[i].hash == h && atom->size() == length && memcmp(atom->c_str(), name, length) == 0)
+			return atom;
+	}
+	return 0;
+}
+
+const TString* TAtomTable::intern(const char* name, size_t length)
+{
+	const unsigned int h = hash(name, length);
+	const TString* atom = find(name, length, h);
+	if (atom)
+		return atom;
+
+	// keep it at most half full
+	if ((count + 1) * 2 > slots.size())
+		grow();
+	TString* newAtom = NewPoolTString("");
+	newAtom->assign(name, length);
+	const size_t mask = slots.size() - 1;
+	size_t i = h & mask;
+	while (slots[i].atom)
+		i = (i + 1) & mask;
+	slots[i].hash = h;
+	slots[i].atom = newAtom;
+	++count;
+	return newAtom;
+}
+
+void TAtomTable::grow()
+{
+	std::vector<TSlot> old;
+	old.swap(slots);
+	const TSlot empty = { 0, 0 };
+	slots.resize(old.empty() ? 64 : old.size() * 2, empty);
+	const size_t mask = slots.size() - 1;
+	for (size_t o = 0; o < old.size(); ++o)
+	{
+		if (!old[o].atom)
+			continue;
+		size_t i = old[o].hash & mask;
+		while (slots[i].atom)
+			i = (i + 1) & mask;
+		slots[i] = old[o];
+	}
+}
+
+
+bool TSymbolTableLevel::insert(TSymbol& symbol, TAtomTable& atoms) 
 {
 	//
 	// returning true means symbol was added to the table
 	//
 	tInsertResult result;
-	result = level.insert(tLevelPair(symbol.getMangledName(), &symbol));
-	
-	return result.second;
+	// not a copy of the name, which could be a built-in atom in another pool
+	const TString& name = symbol.getMangledName();
+	result = level.insert(tLevelPair(TString(name.c_str(), name.size()), &symbol));
+	if (!result.second)
+		return false;
+
+	addToIndex(atoms.intern(symbol.getMangledName()), &symbol);
+	if (symbol.isFunction())
+		functions[atoms.intern(symbol.getName())].push_back(static_cast<TFunction*>(&symbol));
+
+	return true;
+}
+
+void TSymbolTableLevel::addToIndex(const TString* atom, TSymbol* symbol)
+{
+	// keep it at most half full
+	if ((indexCount + 1) * 2 > index.size())
+	{
+		TVector<TIndexSlot> old;
+		old.swap(index);
+		const TIndexSlot empty = { 0, 0 };
+		index.resize(old.empty() ? 16 : old.size() * 2, empty);
+		indexCount = 0;
+		for (size_t o = 0; o < old.size(); ++o)
+		{
+			if (old[o].atom)
+				addToIndex(old[o].atom, old[o].symbol);
+		}
+	}
+
+	const size_t mask = index.size() - 1;
+	size_t i = HashAtom(atom) & mask;
+	while (index[i].atom)
+		i = (i + 1) & mask;
+	index[i].atom = atom;
+	index[i].symbol = symbol;
+	++indexCount;
 }
 
 // Recursively generate mangled names.
@@ -91,6 +197,134 @@ int TType::getStructSize() const
 }
 
 
+#ifdef POOL_THREAD_LOCAL
+static POOL_THREAD_LOCAL TTypeTable* CurrentTypeTable = 0;
+TTypeTable* TTypeTable::getCurrent() { return CurrentTypeTable; }
+void TTypeTable::setCurrent(TTypeTable* table) { CurrentTypeTable = table; }
+#else
+// without thread local variables, nodes keep their own copies of their types
+TTypeTable* TTypeTable::getCurrent() { return 0; }
+void TTypeTable::setCurrent(TTypeTable*) { }
+#endif
+
+static inline unsigned int HashMix(unsigned int h, unsigned int v)
+{
+	// FNV-1a over the four bytes of v
+	for (int i = 0; i < 4; ++i, v >>= 8)
+		h = (h ^ (v & 0xFF)) * 16777619u;
+	return h;
+}
+
+static unsigned int HashString(unsigned int h, const TString* s)
+{
+	if (!s)
+		return HashMix(h, 0);
+	for (size_t i = 0; i < s->size(); ++i)
+		h = (h ^ static_cast<unsigned char>((*s)[i])) * 16777619u;
+	return HashMix(h, static_cast<unsigned int>(s->size()) + 1);
+}
+
+static bool SameString(const TString* a, const TString* b)
+{
+	if (a == b)
+		return true;
+	return a && b && *a == *b;
+}
+
+unsigned int TTypeTable::hash(const TType& t)
+{
+	unsigned int h = 2166136261u;
+	h = HashMix(h, t.type | (t.precision << 8) | (t.qualifier << 16));
+	h = HashMix(h, t.matrows | (t.matcols << 8) | (t.matrix << 16) | (t.array << 17));
+	h = HashMix(h, t.arraySize);
+	h = HashMix(h, t.maxArraySize);
+	h = HashMix(h, static_cast<unsigned int>(reinterpret_cast<size_t>(t.structure) >> 3));
+	h = HashString(h, t.fieldName);
+	h = HashString(h, t.typeName);
+	h = HashString(h, t.semantic);
+	return h;
+}
+
+// Everything that can tell two types apart, unlike operator== which only
+// compares what overload resolution and type checking look at.
+bool TTypeTable::identical(const TType& a, const TType& b)
+{
+	return a.type == b.type &&
+		a.precision == b.precision &&
+		a.qualifier == b.qualifier &&
+		a.matrows == b.matrows &&
+		a.matcols == b.matcols &&
+		a.matrix == b.matrix &&
+		a.array == b.array &&
+		a.arraySize == b.arraySize &&
+		a.maxArraySize == b.maxArraySize &&
+		a.structure == b.structure &&
+		SameString(a.fieldName, b.fieldName) &&
+		SameString(a.typeName, b.typeName) &&
+		SameString(a.semantic, b.semantic);
+}
+
+const TType* TTypeTable::intern(const TType& t)
+{
+	// Nodes have lines of their own; keeping the declaration line in node types
+	// would give every declaration its own copy of the same type. Struct types
+	// keep theirs, it's where the struct is declared and the same for all of them.
+	if (t.type != EbtStruct && (t.line.line != 0 || t.line.file != 0))
+	{
+		TType lineless(t);
+		lineless.line = gNullSourceLoc;
+		return intern(lineless);
+	}
+
+	const unsigned int h = hash(t);
+	if (!slots.empty())
+	{
+		const size_t mask = slots.size() - 1;
+		for (size_t i = h & mask; slots[i].type; i = (i + 1) & mask)
+		{
+			if (slots[i].hash == h && identical(*slots[i].type, t))
+				return slots[i].type;
+		}
+	}
+
+	// keep it at most half full
+	if ((count + 1) * 2 > slots.size())
+	{
+		std::vector<TSlot> old;
+		old.swap(slots);
+		const TSlot empty = { 0, 0 };
+		slots.resize(old.empty() ? 64 : old.size() * 2, empty);
+		const size_t mask = slots.size() - 1;
+		for (size_t o = 0; o < old.size(); ++o)
+		{
+			if (!old[o].type)
+				continue;
+			size_t i = old[o].hash & mask;
+			while (slots[i].type)
+				i = (i + 1) & mask;
+			slots[i] = old[o];
+		}
+	}
+
+	TType* type = new TType(t);
+
+	const size_t mask = slots.size() - 1;
+	size_t i = h & mask;
+	while (slots[i].type)
+		i = (i + 1) & mask;
+	slots[i].hash = h;
+	slots[i].type = type;
+	++count;
+	return type;
+}
+
+void TTypeTable::clear()
+{
+	std::vector<TSlot>().swap(slots);
+	count = 0;
+}
+
+
 // Determine the parameter compatibility between this type and the parameter type
 TType::ECompatibility TType::determineCompatibility ( const TType *pType ) const
 {
@@ -251,8 +485,8 @@ TVariable::TVariable(const TVariable& copyOf, TStructureMap& remapper) : TSymbol
 	type.copyType(copyOf.type, remapper);
 	userType = copyOf.userType;
 	// for builtIn symbol table level, unionArray and arrayInformation pointers should be NULL
-	assert(copyOf.arrayInformationType == 0); 
-	arrayInformationType = 0;
+	assert(copyOf.arrayReferences == 0); 
+	arrayReferences = 0;
 }
 
 TVariable* TVariable::clone(TStructureMap& remapper) 
@@ -285,65 +519,64 @@ TFunction* TFunction::clone(TStructureMap& remapper)
 }
 
 
-TSymbolTableLevel* TSymbolTableLevel::clone(TStructureMap& remapper)
+TSymbolTableLevel* TSymbolTableLevel::clone(TStructureMap& remapper, TAtomTable& atoms)
 {
 	TSymbolTableLevel *symTableLevel = new TSymbolTableLevel();
 	tLevel::iterator iter;
 	for (iter = level.begin(); iter != level.end(); ++iter)
 	{
-		symTableLevel->insert(*iter->second->clone(remapper));
+		symTableLevel->insert(*iter->second->clone(remapper), atoms);
 	}
 	
 	return symTableLevel;
 }
 
 // This is the sort function for parameter matching in findCompatible method below
-bool parameterSizeSortFunction(TParameter left, TParameter right) {
+static bool parameterSizeSortFunction(const TType* left, const TType* right) {
 	// non-numeric types come first
-	if (!IsNumeric(left.type->getBasicType()))
+	if (!IsNumeric(left->getBasicType()))
 		return true;
-	else if (IsNumeric(left.type->getBasicType()) && !IsNumeric(right.type->getBasicType()))
+	else if (IsNumeric(left->getBasicType()) && !IsNumeric(right->getBasicType()))
 		return false;
 	// then sort according to numeric type's dimension in descending order
-	else return (left.type->getColsCount() >= right.type->getColsCount() && left.type->getRowsCount() >= right.type->getRowsCount());
+	else return (left->getColsCount() >= right->getColsCount() && left->getRowsCount() >= right->getRowsCount());
 }
 
 // This function uses the matching rules as described in the Cg language doc (the closest
 // thing we have to HLSL function matching description) to find a matching compatible function.  
-TSymbol* TSymbolTableLevel::findCompatible (const TFunction *call, bool &ambiguous) const
+TSymbol* TSymbolTableLevel::findCompatible (const TFunction *call, const TString* nameAtom, bool &ambiguous) const
 {
 	ambiguous = false;
 	
-	const TString &name = call->getName();   
-	std::vector<TFunction*> funcList;
-	
 	// 1 and 2. Add all functions with matching names and argument count to the set to consider
-	tLevel::const_iterator it = level.begin();
-	while (it != level.end())
+	tFunctionIndex::const_iterator overloads = functions.find(nameAtom);
+	if (overloads == functions.end())
+		return NULL;
+
+	std::vector<TFunction*> funcList;
+	for (tFunctionList::const_iterator it = overloads->second.begin(); it != overloads->second.end(); ++it)
 	{
-		if (it->second->getName() == name && it->second->isFunction())
-		{
-			TFunction* func = (TFunction*)it->second;
-			if (call->getParamCount() == func->getParamCount())
-				funcList.push_back (func);
-		}
-		++it;
+		if (call->getParamCount() == (*it)->getParamCount())
+			funcList.push_back (*it);
 	}
+	if (funcList.empty())
+		return NULL;
 		
 	// HLSL follows different matching rules than Cg, e.g. step(float, float2) is matched as step(float2, float) by HLSL
 	// while Cg matches step(float, float). Sort parameters by dimensions in descending order instead of left-to-right
 	// to keep parameters promoting up.
-	TVector<TParameter> sortedParameters;
+	std::vector<const TType*> sortedParameters;
 	for ( int nParam = 0; nParam < call->getParamCount() ; nParam++ )
 	{
-		sortedParameters.push_back((*call)[nParam]);
+		sortedParameters.push_back((*call)[nParam].type);
 	}
 	std::sort(sortedParameters.begin(), sortedParameters.end(), parameterSizeSortFunction);
 	
 	// For each actual parameter expression, in the sequence:
+	std::vector<TType::ECompatibility> compatibility;
 	for ( int nParam = 0; nParam < sortedParameters.size() ; nParam++ )
 	{
-		const TType* type0 = sortedParameters[nParam].type;
+		const TType* type0 = sortedParameters[nParam];
 		
 		// From the Cg function matching rules, perform the following matching on each parameter
 		//
@@ -365,56 +598,28 @@ TSymbol* TSymbolTableLevel::findCompatible (const TFunction *call, bool &ambiguo
 		// 7. *** Not part of Cg rules, but used to allow HLSL upward promotion on function calls ***
 		//    If there is an upward vector promotion for the type of the actual parameter to the unqualified type
 		//    of the formal parameter of any function, remove all functions for which this is not true.
-		const TType::ECompatibility eCompatType[] =
+		//
+		// ECompatibility values are in the order of these rules, so this keeps the functions with the
+		// lowest compatibility there is, other than NOT_COMPATIBLE. If none are compatible, none are removed.
+		compatibility.resize(funcList.size());
+		TType::ECompatibility best = TType::NOT_COMPATIBLE;
+		for (size_t f = 0; f < funcList.size(); ++f)
 		{
-			TType::MATCH_EXACTLY,
-			TType::PROMOTION_EXISTS,
-			TType::IMPLICIT_CAST_EXISTS,
-			TType::IMPLICIT_CAST_WITH_PROMOTION_EXISTS,
-			TType::UPWARD_VECTOR_PROMOTION_EXISTS
-		};
-		
-		// Iterate over each matching type (declared above)
-		for ( int nIter = 0; nIter < sizeof(eCompatType) / sizeof (TType::ECompatibility); nIter++ )
+			compatibility[f] = type0->determineCompatibility((*funcList[f])[nParam].type);
+			if (compatibility[f] != TType::NOT_COMPATIBLE && (best == TType::NOT_COMPATIBLE || compatibility[f] < best))
+				best = compatibility[f];
+		}
+
+		if (best != TType::NOT_COMPATIBLE)
 		{
-			bool bMatchesCompatibility = false;
-			
-			// Grab the compatibility type for the test
-			TType::ECompatibility eCompatibility = eCompatType[nIter];
-			
-			std::vector<TFunction*>::iterator funcIter = funcList.begin();
-			while (funcIter != funcList.end())
-			{
-				const TFunction* curFunc = *(funcIter);
-				const TType* type1 = (*curFunc)[nParam].type;
-				
-				// Check to see if the compatibility matches the compatibility type for this test
-				if ( type0->determineCompatibility ( type1 ) == eCompatibility )
-				{
-					bMatchesCompatibility = true;
-					break;               
-				}
-				
-				funcIter++;
-			}
-			
-			if ( bMatchesCompatibility )
+			// Remove all that don't match this compatibility test
+			size_t kept = 0;
+			for (size_t f = 0; f < funcList.size(); ++f)
 			{
-				// Remove all that don't match this compatibility test
-				funcIter = funcList.begin();
-				while ( funcIter != funcList.end() )
-				{
-					TFunction* curFunc = *(funcIter);
-					const TType* type1 = (*curFunc)[nParam].type;
-					
-					if ( type0->determineCompatibility ( type1 ) != eCompatibility )
-					{
-						funcIter = funcList.erase ( funcIter );               
-					}
-					else
-						funcIter++;
-				}
+				if (compatibility[f] == best)
+					funcList[kept++] = funcList[f];
 			}
+			funcList.resize(kept);
 		}
 	}
 	
@@ -433,12 +638,66 @@ TSymbol* TSymbolTableLevel::findCompatible (const TFunction *call, bool &ambiguo
 	return NULL;
 }
 
+
+// The call's name and the parts of its argument types that findCompatible looks at.
+static void BuildResolutionKey(const TFunction* call, std::string& key)
+{
+	key.assign(call->getName().c_str(), call->getName().size());
+	key += '(';
+	for (int i = 0; i < call->getParamCount(); ++i)
+	{
+		const TType& type = *(*call)[i].type;
+		key += static_cast<char>(type.getBasicType());
+		key += static_cast<char>(type.getColsCount());
+		key += static_cast<char>(type.getRowsCount());
+		key += static_cast<char>((type.isMatrix() ? 1 : 0) | (type.isArray() ? 2 : 0));
+		if (type.isArray())
+		{
+			int arraySize = type.getArraySize();
+			key.append(reinterpret_cast<const char*>(&arraySize), sizeof(arraySize));
+		}
+	}
+}
+
+TSymbol* TSymbolTable::findCompatible(const TFunction* call, bool *builtIn, bool &ambiguous)
+{
+	std::string key;
+	BuildResolutionKey(call, key);
+	tResolutionMap::iterator found = resolved.find(key);
+	if (found != resolved.end())
+	{
+		if (builtIn)
+			*builtIn = found->second.builtIn;
+		ambiguous = found->second.ambiguous;
+		return found->second.symbol;
+	}
+
+	const TString* nameAtom = atoms.find(call->getName());
+	int level = currentLevel();
+	TSymbol *symbol = 0;
+	ambiguous = false;
+
+	do 
+	{
+		symbol = nameAtom ? table[level]->findCompatible(call, nameAtom, ambiguous) : 0;
+		--level;
+	} while ( symbol == 0 && level >= 0 && !ambiguous);
+		
+	level++;
+	if (builtIn)
+		*builtIn = level == 0;
+
+	TResolution resolution = { symbol, level == 0, ambiguous };
+	resolved.insert(tResolutionMap::value_type(key, resolution));
+	return symbol;
+}
+
 void TSymbolTable::copyTable(const TSymbolTable& copyOf)
 {
 	TStructureMap remapper;
 	uniqueId = copyOf.uniqueId;
 	for (unsigned int i = 0; i < copyOf.table.size(); ++i)
 	{
-		table.push_back(copyOf.table[i]->clone(remapper));
+		table.push_back(copyOf.table[i]->clone(remapper, atoms));
 	}
 }
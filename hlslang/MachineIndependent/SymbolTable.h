@@ -75,12 +75,12 @@ protected:
 //
 class TVariable : public TSymbol {
 public:
-	TVariable(const TString *name, const TType& t, bool uT = false ) : TSymbol(name), type(t), userType(uT), arrayInformationType(0), constValue(0)
+	TVariable(const TString *name, const TType& t, bool uT = false ) : TSymbol(name), type(t), userType(uT), arrayReferences(0), constValue(0)
 	{
 		changeQualifier(type.getQualifier());
 	}
 	
-	TVariable(const TString *name, const TTypeInfo* info, const TType& t, bool uT = false ) : TSymbol(name, info), type(t), userType(uT), arrayInformationType(0), constValue(0)
+	TVariable(const TString *name, const TTypeInfo* info, const TType& t, bool uT = false ) : TSymbol(name, info), type(t), userType(uT), arrayReferences(0), constValue(0)
 	{
 		changeQualifier(type.getQualifier());
 	}
@@ -92,8 +92,13 @@ public:
 	const TType& getType() const { return type; }
 	bool isUserType() const { return userType; }
 	void changeQualifier(TQualifier qualifier) { type.changeQualifier(qualifier); }
-	void updateArrayInformationType(TType *t) { arrayInformationType = t; }
-	TType* getArrayInformationType() { return arrayInformationType; }
+	void addArrayReference(TIntermTyped* node)
+	{
+		if (!arrayReferences)
+			arrayReferences = new(GlobalPoolAllocator.allocate(sizeof(TVector<TIntermTyped*>))) TVector<TIntermTyped*>();
+		arrayReferences->push_back(node);
+	}
+	TVector<TIntermTyped*>* getArrayReferences() { return arrayReferences; }
 	
 	virtual void dump(TInfoSink &infoSink) const;
 
@@ -105,7 +110,7 @@ public:
 protected:
 	TType type;
 	bool userType;
-	TType *arrayInformationType;  // this is used for updating maxArraySize in all the references to a given symbol
+	TVector<TIntermTyped*>* arrayReferences;  // this is used for updating maxArraySize in all the references to a given symbol
 };
 
 //
@@ -137,18 +142,20 @@ public:
 	returnType(TType(EbtVoid, EbpUndefined)),
 	op(o),
 	defined(false) { }
+	// The name can be an atom of the shared built-ins, which is in the process wide pool;
+	// copying it would copy its allocator too, so the mangled name is made in the current pool.
 	TFunction(const TString *name, TType& retType, TOperator tOp = EOpNull) : 
 	TSymbol(name), 
 	returnType(retType),
-	mangledName(*name + '('),
+	mangledName(name->c_str(), name->size()),
 	op(tOp),
-	defined(false) { }
+	defined(false) { mangledName += '('; }
 	TFunction(const TString *name, const TTypeInfo* info, TType& retType, TOperator tOp = EOpNull) : 
 	TSymbol(name, info), 
 	returnType(retType),
-	mangledName(*name + '('),
+	mangledName(name->c_str(), name->size()),
 	op(tOp),
-	defined(false) { }
+	defined(false) { mangledName += '('; }
 	virtual ~TFunction();
 	virtual bool isFunction() const { return true; }    
     
@@ -183,37 +190,105 @@ protected:
 };
 
 
+//
+// Atoms: each distinct identifier or mangled name is kept once, as a pool string, and
+// symbol table levels look symbols up by comparing those pointers. The scanner interns
+// identifiers as it reads them, so a name is hashed once no matter how many levels it is
+// looked up in. A table made for a parse also sees the atoms of the built-ins it shares;
+// those are never added to once a parse can see them.
+//
+class TAtomTable
+{
+public:
+	TAtomTable() : parent(0), count(0) { }
+	explicit TAtomTable(const TAtomTable* p) : parent(p), count(0) { }
+
+	// The atom of a name, or 0 if it was never interned.
+	const TString* find(const char* name, size_t length) const { return find(name, length, hash(name, length)); }
+	const TString* find(const TString& name) const { return find(name.c_str(), name.size()); }
+
+	// The atom of a name, made in the current pool if it's a new one.
+	const TString* intern(const char* name, size_t length);
+	const TString* intern(const TString& name) { return intern(name.c_str(), name.size()); }
+
+	void clear() { slots.clear(); count = 0; }
+
+private:
+	struct TSlot
+	{
+		unsigned int hash;
+		const TString* atom;
+	};
+
+	static unsigned int hash(const char* name, size_t length);
+	const TString* find(const char* name, size_t length, unsigned int h) const;
+	void grow();
+
+	const TAtomTable* parent;
+	std::vector<TSlot> slots;   // open addressing, a power of two in size
+	size_t count;
+};
+
+
 class TSymbolTableLevel 
 {
+protected:
+	typedef std::map<TString, TSymbol*, std::less<TString>, pool_allocator<std::pair<const TString, TSymbol*> > > tLevel;
+
 public:
 	POOL_ALLOCATOR_NEW_DELETE(GlobalPoolAllocator)
-	TSymbolTableLevel() { }
+	TSymbolTableLevel() : indexCount(0) { }
 	~TSymbolTableLevel();
+
+	// symbols in mangled name order
+	typedef tLevel::const_iterator const_iterator;
+	const_iterator begin() const { return level.begin(); }
+	const_iterator end() const { return level.end(); }
     
-	bool insert(TSymbol& symbol);
+	bool insert(TSymbol& symbol, TAtomTable& atoms);
 	
-	TSymbol* find(const TString& name) const
+	// Symbols by the atom of their mangled name.
+	TSymbol* find(const TString* atom) const
 	{
-		tLevel::const_iterator it = level.find(name);
-		if (it == level.end())
+		if (index.empty())
 			return 0;
-		else
-			return (*it).second;
+		const size_t mask = index.size() - 1;
+		for (size_t i = HashAtom(atom) & mask; index[i].atom; i = (i + 1) & mask)
+		{
+			if (index[i].atom == atom)
+				return index[i].symbol;
+		}
+		return 0;
 	}
 	
-	// vector might be best switched to a special allocator
-	TSymbol* findCompatible( const TFunction *call, bool &ambiguous) const;
+	TSymbol* findCompatible(const TFunction *call, const TString* nameAtom, bool &ambiguous) const;
+	bool hasFunctions() const { return !functions.empty(); }
 	
 	void relateToOperator(const char* name, TOperator op);
 	void dump(TInfoSink &infoSink) const;
-	TSymbolTableLevel* clone(TStructureMap& remapper);
+	TSymbolTableLevel* clone(TStructureMap& remapper, TAtomTable& atoms);
     
 protected:
-	typedef std::map<TString, TSymbol*, std::less<TString>, pool_allocator<std::pair<const TString, TSymbol*> > > tLevel;
 	typedef const tLevel::value_type tLevelPair;
 	typedef std::pair<tLevel::iterator, bool> tInsertResult;
+
+	static size_t HashAtom(const TString* atom) { return (reinterpret_cast<size_t>(atom) >> 3) * 2654435761u; }
+	void addToIndex(const TString* atom, TSymbol* symbol);
+
+	struct TIndexSlot
+	{
+		const TString* atom;
+		TSymbol* symbol;
+	};
 	
+	// all overloads of each function name, for findCompatible
+	typedef TVector<TFunction*> tFunctionList;
+	typedef std::map<const TString*, tFunctionList, std::less<const TString*>, pool_allocator<std::pair<const TString* const, tFunctionList> > > tFunctionIndex;
+
 	tLevel level;
+	TVector<TIndexSlot> index;   // open addressing on atoms, a power of two in size
+	size_t indexCount;
+	tFunctionIndex functions;
 };
 
 
@@ -228,7 +303,12 @@ public:
 		//
 	}
 
-	TSymbolTable(TSymbolTable& symTable)
+	//
+	// Share the built-ins of another table. They are level 0 here, and are never
+	// modified: all symbols of a shader go into levels pushed on top of it, so
+	// any number of tables (on any threads) can share the same built-ins.
+	//
+	TSymbolTable(const TSymbolTable& symTable) : atoms(&symTable.atoms)
 	{
 		table.push_back(symTable.table[0]);
 		uniqueId = symTable.uniqueId;
@@ -247,9 +327,9 @@ public:
 	// globals are at level 1.
 	//
 	bool isEmpty() const { return table.size() == 0; }
-	bool atBuiltInLevel() const { return atSharedBuiltInLevel() || atDynamicBuiltInLevel(); }
+	bool atBuiltInLevel() const { return atSharedBuiltInLevel(); }
 	bool atSharedBuiltInLevel() const { return table.size() == 1; }	
-	bool atGlobalLevel() const { return table.size() <= 3; }
+	bool atGlobalLevel() const { return table.size() <= 2; }
 	void push() 
 	{ 
 		table.push_back(new TSymbolTableLevel);
@@ -257,24 +337,47 @@ public:
 
 	void pop() 
 	{ 
+		if (table[currentLevel()]->hasFunctions())
+			resolved.clear();
 		delete table[currentLevel()]; 
 		table.pop_back(); 
+		if (table.empty())
+			atoms.clear();
 	}
 
 	bool insert(TSymbol& symbol)
 	{
+		if (symbol.isFunction())
+			resolved.clear();
 		symbol.setGlobal(atGlobalLevel());
 		symbol.setUniqueId(++uniqueId);
-		return table[currentLevel()]->insert(symbol);
+		return table[currentLevel()]->insert(symbol, atoms);
 	}
 
+	// Insert a precompiled built-in, with the unique ID it had when it was parsed.
+	bool insertBuiltIn(TSymbol& symbol, int id)
+	{
+		assert(atSharedBuiltInLevel());
+		symbol.setGlobal(true);
+		symbol.setUniqueId(id);
+		if (id > uniqueId)
+			uniqueId = id;
+		return table[0]->insert(symbol, atoms);
+	}
+
+	// Identifiers from the scanner are atoms already; see findAtom.
 	TSymbol* find(const TString& name, bool* builtIn = 0, bool *sameScope = 0) 
+	{
+		return findAtom(atoms.find(name), builtIn, sameScope);
+	}
+
+	TSymbol* findAtom(const TString* atom, bool* builtIn = 0, bool *sameScope = 0) 
 	{
 		int level = currentLevel();
 		TSymbol* symbol;
 		do 
 		{
-			symbol = table[level]->find(name);
+			symbol = atom ? table[level]->find(atom) : 0;
 			--level;
 		} while (symbol == 0 && level >= 0);
 		
@@ -286,35 +389,34 @@ public:
 		return symbol;
 	}
 
-	TSymbol* findCompatible(const TFunction* call, bool *builtIn, bool &ambiguous) 
-	{
-		int level = currentLevel();
-		TSymbol *symbol = 0;
-		ambiguous = false;
-
-		do 
-		{
-			symbol = table[level]->findCompatible(call, ambiguous);
-			--level;
-		} while ( symbol == 0 && level >= 0 && !ambiguous);
-			
-		level++;
-		if (builtIn)
-			*builtIn = level == 0;
-		return symbol;
-	}
+	TSymbol* findCompatible(const TFunction* call, bool *builtIn, bool &ambiguous);
 
-	TSymbolTableLevel* getGlobalLevel() { assert(table.size() >= 3); return table[2]; }
+	TSymbolTableLevel* getGlobalLevel() { assert(table.size() >= 2); return table[1]; }
+	const TSymbolTableLevel* getBuiltInLevel() const { assert(table.size() >= 1); return table[0]; }
+	int getLastUniqueId() const { return uniqueId; }
 	void relateToOperator(const char* name, TOperator op) { table[0]->relateToOperator(name, op); }
 	void dump(TInfoSink &infoSink) const;
 	void copyTable(const TSymbolTable& copyOf);
 
+	const TString* intern(const char* name, size_t length) { return atoms.intern(name, length); }
+
 protected:    
 	int currentLevel() const { return static_cast<int>(table.size()) - 1; }
-	bool atDynamicBuiltInLevel() const { return table.size() == 2; }
 
 	std::vector<TSymbolTableLevel*> table;
 	int uniqueId;     // for unique identification in code generation
+	TAtomTable atoms;
+
+	// Results of findCompatible, keyed by the call's name and argument types.
+	// Any function inserted or popped can change them, so that clears it all.
+	struct TResolution
+	{
+		TSymbol* symbol;
+		bool builtIn;
+		bool ambiguous;
+	};
+	typedef std::map<std::string, TResolution> tResolutionMap;
+	tResolutionMap resolved;
 };
 
 #endif // _SYMBOL_TABLE_INCLUDED_
@@ -0,0 +1,360 @@
+// Copyright (c) The HLSL2GLSLFork Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE.txt file.
+
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <string.h>
+
+#include "TranslationCache.h"
+#include "ParseHelper.h"
+
+
+// Bump when anything changes the output for the same input, so that
+// old entries in cache directories aren't used anymore.
+static const char kCacheVersion[] = "hlsl2glsl cache 1";
+
+// The CMake build generates a hash of all library sources (CacheFingerprint.cmake), so a
+// rebuilt library never uses results of another build. Other builds can't tell their results
+// from those of another build, so they only keep them in memory (see supportsDirectory).
+#ifdef HLSL2GLSL_HAS_CACHE_FINGERPRINT
+#include "CacheFingerprint.h"
+#endif
+
+
+// --------------------------------------------------------------------------
+// Keys
+
+
+// MurmurHash3 x64 128 (public domain), of the whole key data at once.
+static inline unsigned long long Rotl64(unsigned long long x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline unsigned long long Mix64(unsigned long long k)
+{
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdULL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ULL;
+	k ^= k >> 33;
+	return k;
+}
+
+static inline unsigned long long ReadBlock64(const unsigned char* p)
+{
+	unsigned long long k = 0;
+	for (int i = 7; i >= 0; --i)
+		k = (k << 8) | p[i];
+	return k;
+}
+
+static TCacheKey Murmur3(const unsigned char* data, size_t len)
+{
+	const unsigned long long c1 = 0x87c37b91114253d5ULL;
+	const unsigned long long c2 = 0x4cf5ad432745937fULL;
+	unsigned long long h1 = 0, h2 = 0;
+
+	const size_t blocks = len / 16;
+	for (size_t i = 0; i < blocks; ++i)
+	{
+		unsigned long long k1 = ReadBlock64(data + i * 16);
+		unsigned long long k2 = ReadBlock64(data + i * 16 + 8);
+
+		k1 *= c1; k1 = Rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+		h1 = Rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+		k2 *= c2; k2 = Rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+		h2 = Rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+	}
+
+	const unsigned char* tail = data + blocks * 16;
+	unsigned long long k1 = 0, k2 = 0;
+	const size_t rest = len & 15;
+	for (size_t i = rest; i > 8; --i)
+		k2 = (k2 << 8) | tail[i - 1];
+	for (size_t i = (rest < 8 ? rest : 8); i > 0; --i)
+		k1 = (k1 << 8) | tail[i - 1];
+	if (rest > 8)
+	{
+		k2 *= c2; k2 = Rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+	}
+	if (rest > 0)
+	{
+		k1 *= c1; k1 = Rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+	}
+
+	h1 ^= len; h2 ^= len;
+	h1 += h2; h2 += h1;
+	h1 = Mix64(h1); h2 = Mix64(h2);
+	h1 += h2; h2 += h1;
+
+	TCacheKey key;
+	key.hash[0] = h1;
+	key.hash[1] = h2;
+	return key;
+}
+
+
+TCacheKey CacheHash(const void* data, size_t size)
+{
+	return Murmur3(reinterpret_cast<const unsigned char*>(data), size);
+}
+
+
+TCacheKeyBuilder::TCacheKeyBuilder(char kind)
+{
+	add(kCacheVersion);
+#ifdef HLSL2GLSL_CACHE_FINGERPRINT
+	add(HLSL2GLSL_CACHE_FINGERPRINT);
+#endif
+	data.push_back(kind);
+}
+
+void TCacheKeyBuilder::add(int i)
+{
+	CacheWriteInt(data, i);
+}
+
+void TCacheKeyBuilder::add(const char* s)
+{
+	CacheWriteString(data, s);
+}
+
+void TCacheKeyBuilder::add(const TCacheKey& key)
+{
+	for (int i = 0; i < 2; ++i)
+		for (int b = 0; b < 64; b += 8)
+			data.push_back(char(key.hash[i] >> b));
+}
+
+void TCacheKeyBuilder::add(const TPreprocessedSource& source)
+{
+	// Locations are part of the key, as they end up in the log and the GLSL.
+	const char* file = NULL;
+	add(int(source.tokens.size()));
+	for (size_t i = 0; i < source.tokens.size(); ++i)
+	{
+		const TPreprocessedToken& t = source.tokens[i];
+		if (i == 0 || t.file != file)
+		{
+			data.push_back('f');
+			add(t.file);
+			file = t.file;
+		}
+		add(t.token);
+		add(int(t.line));
+		add(int(t.length));
+		data.append(source.text, t.offset, t.length);
+	}
+	add(source.outOfMemory ? 1 : 0);
+}
+
+TCacheKey TCacheKeyBuilder::hash() const
+{
+	return Murmur3(reinterpret_cast<const unsigned char*>(data.data()), data.size());
+}
+
+
+// --------------------------------------------------------------------------
+// Values
+
+
+void CacheWriteInt(std::string& out, int i)
+{
+	const unsigned int u = (unsigned int)i;
+	for (int b = 0; b < 32; b += 8)
+		out.push_back(char(u >> b));
+}
+
+void CacheWriteString(std::string& out, const char* s)
+{
+	if (!s)
+	{
+		CacheWriteInt(out, -1);
+		return;
+	}
+	const size_t len = strlen(s);
+	CacheWriteInt(out, int(len));
+	out.append(s, len);
+}
+
+int TCacheReader::readInt()
+{
+	if (data.size() - pos < 4)
+	{
+		ok = false;
+		return 0;
+	}
+	unsigned int u = 0;
+	for (int b = 0; b < 4; ++b)
+		u |= (unsigned int)(unsigned char)data[pos++] << (b * 8);
+	return int(u);
+}
+
+bool TCacheReader::readString(std::string& s)
+{
+	s.clear();
+	const int len = readInt();
+	if (len < 0)
+		return false;
+	if (data.size() - pos < size_t(len))
+	{
+		ok = false;
+		return false;
+	}
+	s.assign(data, pos, len);
+	pos += len;
+	return true;
+}
+
+
+// --------------------------------------------------------------------------
+// Storage
+
+
+// Cache files start with this and the key, then the value size and the value.
+static const char kFileMagic[8] = { 'H', 'L', 'S', 'L', 'G', 'L', 'S', 'L' };
+static const size_t kFileHeaderSize = sizeof(kFileMagic) + 16 + 4;
+
+static void WriteFileHeader(std::string& out, const TCacheKey& key, size_t valueSize)
+{
+	out.assign(kFileMagic, sizeof(kFileMagic));
+	for (int i = 0; i < 2; ++i)
+		for (int b = 0; b < 64; b += 8)
+			out.push_back(char(key.hash[i] >> b));
+	CacheWriteInt(out, int(valueSize));
+}
+
+
+TTranslationCache::TTranslationCache(size_t limit, const char* dir)
+:	memoryUsed(0)
+,	memoryLimit(limit)
+{
+	OS_InitMutex(&mutex);
+	if (dir && dir[0] && supportsDirectory())
+	{
+		directory = dir;
+		const char last = directory[directory.size() - 1];
+		if (last != '/' && last != '\\')
+			directory += '/';
+	}
+}
+
+TTranslationCache::~TTranslationCache()
+{
+	OS_DestroyMutex(&mutex);
+}
+
+bool TTranslationCache::supportsDirectory()
+{
+#ifdef HLSL2GLSL_CACHE_FINGERPRINT
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+bool TTranslationCache::find(const TCacheKey& key, std::string& value)
+{
+	OS_LockMutex(&mutex);
+	std::map<TCacheKey, TEntryList::iterator>::iterator it = index.find(key);
+	if (it != index.end())
+	{
+		entries.splice(entries.begin(), entries, it->second);
+		value = it->second->second;
+		OS_UnlockMutex(&mutex);
+		return true;
+	}
+	OS_UnlockMutex(&mutex);
+
+	if (directory.empty() || !readFile(key, value))
+		return false;
+
+	OS_LockMutex(&mutex);
+	insertInMemory(key, value);
+	OS_UnlockMutex(&mutex);
+	return true;
+}
+
+
+void TTranslationCache::insert(const TCacheKey& key, const std::string& value)
+{
+	OS_LockMutex(&mutex);
+	insertInMemory(key, value);
+	OS_UnlockMutex(&mutex);
+
+	if (!directory.empty())
+		writeFile(key, value);
+}
+
+
+// Call with the mutex locked.
+void TTranslationCache::insertInMemory(const TCacheKey& key, const std::string& value)
+{
+	const size_t size = value.size() + sizeof(TCacheKey);
+	if (size > memoryLimit || index.find(key) != index.end())
+		return;
+
+	entries.push_front(std::make_pair(key, value));
+	index[key] = entries.begin();
+	memoryUsed += size;
+
+	while (memoryUsed > memoryLimit)
+	{
+		memoryUsed -= entries.back().second.size() + sizeof(TCacheKey);
+		index.erase(entries.back().first);
+		entries.pop_back();
+	}
+}
+
+
+std::string TTranslationCache::getPath(const TCacheKey& key) const
+{
+	char name[40];
+	sprintf(name, "%016llx%016llx", key.hash[0], key.hash[1]);
+	return directory + name;
+}
+
+
+bool TTranslationCache::readFile(const TCacheKey& key, std::string& value) const
+{
+	FILE* f = fopen(getPath(key).c_str(), "rb");
+	if (!f)
+		return false;
+
+	std::string data;
+	char buf[4096];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		data.append(buf, n);
+	fclose(f);
+
+	// A file that is being written by someone else, or was cut short, is just a miss.
+	if (data.size() < kFileHeaderSize)
+		return false;
+	std::string header;
+	WriteFileHeader(header, key, data.size() - kFileHeaderSize);
+	if (data.compare(0, kFileHeaderSize, header) != 0)
+		return false;
+
+	value.assign(data, kFileHeaderSize, std::string::npos);
+	return true;
+}
+
+
+void TTranslationCache::writeFile(const TCacheKey& key, const std::string& value) const
+{
+	// This only happens after a miss, so the file is missing or unreadable. Should someone
+	// else write it at the same time, they write the same bytes, as the key says what's in it.
+	FILE* f = fopen(getPath(key).c_str(), "wb");
+	if (!f)
+		return;
+	std::string data;
+	WriteFileHeader(data, key, value.size());
+	data += value;
+	fwrite(data.data(), 1, data.size(), f);
+	fclose(f);
+}
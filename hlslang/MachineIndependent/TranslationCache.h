@@ -0,0 +1,116 @@
+// Copyright (c) The HLSL2GLSLFork Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE.txt file.
+
+
+#ifndef _TRANSLATION_CACHE_INCLUDED_
+#define _TRANSLATION_CACHE_INCLUDED_
+
+#include <list>
+#include <map>
+#include <string>
+
+#include "osinclude.h"
+
+struct TPreprocessedSource;
+
+//
+// Translation results, addressed by their content: a hash of everything that
+// goes into them. See Hlsl2Glsl_EnableCache.
+//
+// There are two kinds of entries. A parse entry is keyed by the preprocessed
+// tokens (so it doesn't matter how the source was split into include files),
+// the target version and the options, and tells whether the shader parses and
+// what was logged. A translation entry is keyed by the parse key, the entry
+// point, target version, options and user attribute names, and holds the GLSL,
+// the uniform reflection and the log. When both are found, the shader is never
+// parsed at all.
+//
+struct TCacheKey
+{
+	unsigned long long hash[2];
+
+	bool operator<(const TCacheKey& k) const { return hash[0] != k.hash[0] ? hash[0] < k.hash[0] : hash[1] < k.hash[1]; }
+	bool operator==(const TCacheKey& k) const { return hash[0] == k.hash[0] && hash[1] == k.hash[1]; }
+};
+
+// Hash of any bytes, the same way as keys are hashed.
+TCacheKey CacheHash(const void* data, size_t size);
+
+// Collects the data that goes into a key, then hashes it.
+class TCacheKeyBuilder
+{
+public:
+	TCacheKeyBuilder(char kind);
+
+	void add(int);
+	void add(const char*);   // NULL is different from ""
+	void add(const TCacheKey&);
+	void add(const TPreprocessedSource&);
+
+	TCacheKey hash() const;
+
+private:
+	std::string data;
+};
+
+
+// Cached values are byte strings; these write and read their fields.
+void CacheWriteInt(std::string& out, int);
+void CacheWriteString(std::string& out, const char*);
+
+class TCacheReader
+{
+public:
+	TCacheReader(const std::string& d) : data(d), pos(0), ok(true) { }
+
+	int readInt();
+	bool readString(std::string&);   // false for a NULL string
+	bool isValid() const { return ok; }
+	bool succeeded() const { return ok && pos == data.size(); } // read all of it
+
+private:
+	const std::string& data;
+	size_t pos;
+	bool ok;
+};
+
+
+//
+// Least recently used entries are dropped from memory once they take up more
+// than memoryLimit bytes. With a directory, each entry is also written to a
+// file named after its key; entries not in memory are looked up there, so the
+// directory can be shared between runs and processes.
+//
+// Safe to use from any number of threads at once.
+//
+class TTranslationCache
+{
+public:
+	TTranslationCache(size_t memoryLimit, const char* directory);
+	~TTranslationCache();
+
+	// Whether entries can be kept in a directory: only in builds with a hash of the
+	// library sources for the keys, so that other builds' files are never used.
+	static bool supportsDirectory();
+
+	bool find(const TCacheKey&, std::string& value);
+	void insert(const TCacheKey&, const std::string& value);
+
+private:
+	typedef std::list<std::pair<TCacheKey, std::string> > TEntryList;
+
+	void insertInMemory(const TCacheKey&, const std::string& value);
+	std::string getPath(const TCacheKey&) const;
+	bool readFile(const TCacheKey&, std::string& value) const;
+	void writeFile(const TCacheKey&, const std::string& value) const;
+
+	OS_Mutex mutex;
+	TEntryList entries;  // most recently used first
+	std::map<TCacheKey, TEntryList::iterator> index;
+	size_t memoryUsed;
+	size_t memoryLimit;
+	std::string directory;
+};
+
+#endif // _TRANSLATION_CACHE_INCLUDED_
@@ -51,6 +51,14 @@ extern void yyerror(TParseContext&, const char*);
 	(RES).setBasic(T, qual, (PAR).line); \
 	(RES).precision = PREC
 
+// Type of a call argument. Node types are shared, so its mangled name is built
+// once, in the shared type, and the copy takes it over.
+static TType* NewArgumentType(TIntermTyped* arg)
+{
+	arg->getType().getMangledName();
+	return new TType(arg->getType());
+}
+
 
 %}
 %union {
@@ -256,10 +264,10 @@ postfix_expression
 				if ($1->isArray()) {
 					if ($1->getType().getArraySize() == 0) {
 						if ($1->getType().getMaxArraySize() <= $3->getAsConstant()->toInt()) {
-							if (parseContext.arraySetMaxSize($1->getAsSymbolNode(), $1->getTypePointer(), $3->getAsConstant()->toInt(), true, $2.line))
+							if (parseContext.arraySetMaxSize($1->getAsSymbolNode(), $3->getAsConstant()->toInt(), true, $2.line))
 								parseContext.recover(); 
 						} else {
-							if (parseContext.arraySetMaxSize($1->getAsSymbolNode(), $1->getTypePointer(), 0, false, $2.line))
+							if (parseContext.arraySetMaxSize($1->getAsSymbolNode(), 0, false, $2.line))
 								parseContext.recover(); 
 						}
 					} else if ( $3->getAsConstant()->toInt() >= $1->getType().getArraySize()) {
@@ -283,12 +291,12 @@ postfix_expression
 			$$ = constant;
         } else if ($1->isArray()) {
             if ($1->getType().getStruct())
-                $$->setType(TType($1->getType().getStruct(), $1->getType().getTypeName(), EbpUndefined, $1->getLine()));
+                $$->setType(TType($1->getType().getStruct(), $1->getType().getTypeName(), EbpUndefined, $1->getType().getLine()));
             else
                 $$->setType(TType($1->getBasicType(), $1->getPrecision(), EvqTemporary, $1->getColsCount(),$1->getRowsCount(),  $1->isMatrix()));
                 
             if ($1->getType().getQualifier() == EvqConst)
-                $$->getTypePointer()->changeQualifier(EvqConst);
+                $$->changeQualifier(EvqConst);
         } else if ($1->isMatrix() && $1->getType().getQualifier() == EvqConst)         
             $$->setType(TType($1->getBasicType(), $1->getPrecision(), EvqConst, 1, $1->getColsCount()));
         else if ($1->isMatrix())            
@@ -330,7 +338,6 @@ postfix_expression
                 parseContext.recover();
             }
 
-            TString vectorString = *$3.string;
             TIntermTyped* index = ir_add_swizzle(fields, $3.line);                
             $$ = ir_add_index(EOpMatrixSwizzle, $1, index, $2.line);
             $$->setType(TType($1->getBasicType(), $1->getPrecision(), EvqTemporary, 1, fields.num));
@@ -377,9 +384,8 @@ postfix_expression
 			else
 			{
 				// Create the appropriate constructor based on the number of ".x"'s there are in the selection field
-				TString vectorString = *$3.string;
 				TQualifier qualifier = $1->getType().getQualifier() == EvqConst ? EvqConst : EvqTemporary;
-				TType type($1->getBasicType(), $1->getPrecision(), qualifier, 1, (int) vectorString.size());
+				TType type($1->getBasicType(), $1->getPrecision(), qualifier, 1, (int) $3.string->size());
 				$$ = parseContext.constructBuiltIn(&type, parseContext.getConstructorOp(type),
 												   $$, $1->getLine(), false);
 			}
@@ -590,7 +596,7 @@ function_call_header_with_parameters
 		if (!$2) {
           YYERROR;
 		}
-		TParameter param = { 0, 0, new TType($2->getType()) };
+		TParameter param = { 0, 0, NewArgumentType($2) };
         $1->addParameter(param);
         $$.function = $1;
         $$.intermNode = $2;
@@ -599,7 +605,7 @@ function_call_header_with_parameters
 		if (!$3) {
           YYERROR;
 		}
-        TParameter param = { 0, 0, new TType($3->getType()) };
+        TParameter param = { 0, 0, NewArgumentType($3) };
         $1.function->addParameter(param);
         $$.function = $1.function;
         $$.intermNode = ir_grow_aggregate($1.intermNode, $3, $2.line);
@@ -717,7 +723,7 @@ unary_expression
         TString tempString = "";
         TType type($2);
         TFunction *function = new TFunction(&tempString, type, op);
-        TParameter param = { 0, 0, new TType($4->getType()) };
+        TParameter param = { 0, 0, NewArgumentType($4) };
         function->addParameter(param);
         TType type2(EbtVoid, EbpUndefined);  // use this to get the type back
         if (parseContext.constructorErrorCheck($2.line, $4, *function, op, &type2)) {
@@ -2283,7 +2289,7 @@ function_definition
                                                ir_add_symbol(variable, $1.line),
                                                $1.line);
             } else {
-                paramNodes = ir_grow_aggregate(paramNodes, ir_add_symbol_internal(0, "", param.info, *param.type, $1.line), $1.line);
+                paramNodes = ir_grow_aggregate(paramNodes, ir_add_symbol_internal(0, NewPoolTString(""), param.info, *param.type, $1.line), $1.line);
             }
         }
         ir_set_aggregate_op(paramNodes, EOpParameters, $1.line);
@@ -22,7 +22,7 @@ struct TVectorFields
 class TInfoSink;
 
 TIntermSymbol* ir_add_symbol(const TVariable* var, TSourceLoc);
-TIntermSymbol* ir_add_symbol_internal(int id, const TString& name, const TTypeInfo *info, const TType& type, TSourceLoc line);
+TIntermSymbol* ir_add_symbol_internal(int id, const TString* name, const TTypeInfo *info, const TType& type, TSourceLoc line);
 TIntermConstant* ir_add_constant(const TType&, TSourceLoc);
 TIntermTyped* ir_add_index(TOperator op, TIntermTyped* base, TIntermTyped* index, TSourceLoc);
 TIntermTyped* ir_add_comma(TIntermTyped* left, TIntermTyped* right, TSourceLoc);
@@ -57,7 +57,7 @@ void ir_output_tree(TIntermNode* root, TInfoSink& infoSink);
 
 static inline TPublicType ir_get_decl_type_noarray(TIntermTyped* decl)
 {
-	TType& t = *decl->getTypePointer();
+	const TType& t = decl->getType();
 	TPublicType p = {
 		t.getBasicType(),
 		t.getQualifier(),
@@ -68,7 +68,7 @@ static inline TPublicType ir_get_decl_type_noarray(TIntermTyped* decl)
 		false,
 		0,
 		t.getBasicType() == EbtStruct ? &t : NULL,
-		t.getLine()
+		decl->getLine()
 	};
 	return p;
 }
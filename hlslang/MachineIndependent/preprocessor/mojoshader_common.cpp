@@ -25,6 +25,7 @@ static inline uint32 hlmojo_hash_string(const char *str, size_t len)
 typedef struct hlmojo_StringBucket
 {
     char *string;
+    uint32 hash;
     struct hlmojo_StringBucket *next;
 } hlmojo_StringBucket;
 
@@ -32,6 +33,7 @@ struct hlmojo_StringCache
 {
     hlmojo_StringBucket **hashtable;
     uint32 table_size;
+    uint32 count;
     MOJOSHADER_hlslang_malloc m;
     MOJOSHADER_hlslang_free f;
     void *d;
@@ -43,18 +45,49 @@ const char *hlmojo_stringcache(hlmojo_StringCache *cache, const char *str)
     return hlmojo_stringcache_len(cache, str, strlen(str));
 } // hlmojo_stringcache
 
+// Doubles the table once there are more strings than buckets, so chains stay
+//  short however many strings there are. Keeps the old table if out of memory.
+static void hlmojo_stringcache_grow(hlmojo_StringCache *cache)
+{
+    const uint32 size = cache->table_size * 2;
+    const size_t tablelen = sizeof (hlmojo_StringBucket *) * size;
+    hlmojo_StringBucket **table = (hlmojo_StringBucket **) cache->m(tablelen, cache->d);
+    if (table == NULL)
+        return;
+    memset(table, '\0', tablelen);
+
+    uint32 i;
+    for (i = 0; i < cache->table_size; i++)
+    {
+        hlmojo_StringBucket *bucket = cache->hashtable[i];
+        while (bucket)
+        {
+            hlmojo_StringBucket *next = bucket->next;
+            const uint32 idx = bucket->hash & (size-1);
+            bucket->next = table[idx];
+            table[idx] = bucket;
+            bucket = next;
+        } // while
+    } // for
+
+    cache->f(cache->hashtable, cache->d);
+    cache->hashtable = table;
+    cache->table_size = size;
+} // hlmojo_stringcache_grow
+
 static const char *hlmojo_stringcache_len_internal(hlmojo_StringCache *cache,
                                             const char *str,
                                             const unsigned int len,
                                             const int addmissing)
 {
-    const uint8 hash = hlmojo_hash_string(str, len) & (cache->table_size-1);
+    const uint32 fullhash = hlmojo_hash_string(str, len);
+    const uint32 hash = fullhash & (cache->table_size-1);
     hlmojo_StringBucket *bucket = cache->hashtable[hash];
     hlmojo_StringBucket *prev = NULL;
     while (bucket)
     {
         const char *bstr = bucket->string;
-        if ((strncmp(bstr, str, len) == 0) && (bstr[len] == 0))
+        if ((bucket->hash == fullhash) && (strncmp(bstr, str, len) == 0) && (bstr[len] == 0))
         {
             // Matched! Move this to the front of the list.
             if (prev != NULL)
@@ -86,8 +119,11 @@ static const char *hlmojo_stringcache_len_internal(hlmojo_StringCache *cache,
     } // if
     memcpy(bucket->string, str, len);
     bucket->string[len] = '\0';
+    bucket->hash = fullhash;
     bucket->next = cache->hashtable[hash];
     cache->hashtable[hash] = bucket;
+    if (++cache->count > cache->table_size)
+        hlmojo_stringcache_grow(cache);
     return bucket->string;
 } // hlmojo_stringcache_len_internal
 
@@ -97,6 +133,12 @@ const char *hlmojo_stringcache_len(hlmojo_StringCache *cache, const char *str,
     return hlmojo_stringcache_len_internal(cache, str, len, 1);
 } // hlmojo_stringcache_len
 
+const char *hlmojo_stringcache_find_len(hlmojo_StringCache *cache, const char *str,
+                                 const unsigned int len)
+{
+    return hlmojo_stringcache_len_internal(cache, str, len, 0);
+} // hlmojo_stringcache_find_len
+
 
 hlmojo_StringCache *hlmojo_stringcache_create(MOJOSHADER_hlslang_malloc m, MOJOSHADER_hlslang_free f, void *d)
 {
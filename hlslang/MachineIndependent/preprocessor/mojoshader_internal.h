@@ -90,6 +90,9 @@ hlmojo_StringCache *hlmojo_stringcache_create(MOJOSHADER_hlslang_malloc m,MOJOSH
 const char *hlmojo_stringcache(hlmojo_StringCache *cache, const char *str);
 const char *hlmojo_stringcache_len(hlmojo_StringCache *cache, const char *str,
                             const unsigned int len);
+// Returns the cached copy of str, or NULL if it isn't cached (without adding it).
+const char *hlmojo_stringcache_find_len(hlmojo_StringCache *cache, const char *str,
+                                 const unsigned int len);
 void hlmojo_stringcache_destroy(hlmojo_StringCache *cache);
 
 
@@ -221,6 +224,41 @@ typedef struct hlmojo_Conditional
     struct hlmojo_Conditional *next;
 } hlmojo_Conditional;
 
+// An include file that including again gives nothing, while its guard macro
+//  is defined or for good with #pragma once. Files are told apart by key, see
+//  handle_pp_include().
+typedef struct hlmojo_IncludeGuard
+{
+    const char *key;    // in the filename cache
+    const char *macro;  // interned, like macro names; NULL if none
+    int once;
+    struct hlmojo_IncludeGuard *next;
+} hlmojo_IncludeGuard;
+
+// How far an include file matches the pattern of an include guard: nothing
+//  but comments outside of one #ifndef/#endif block.
+typedef enum
+{
+    INCLUDEGUARD_NONE,    // not an include file, or doesn't match
+    INCLUDEGUARD_START,   // nothing seen yet
+    INCLUDEGUARD_OPEN,    // in the #ifndef block
+    INCLUDEGUARD_CLOSED   // after its #endif
+} hlmojo_IncludeGuardState;
+
+// A token of an include file or macro, lexed ahead of time; see
+//  hlmojo_TokenCache and hlmojo_Define.
+typedef struct hlmojo_CachedToken
+{
+    Token tokenval;
+    unsigned int offset;  // of the token in the file
+    unsigned int length;
+    unsigned int lines;   // newlines the lexer went past, up to the end of the token
+} hlmojo_CachedToken;
+
+// The tokens of a macro's definition are lexed the first time it's expanded,
+//  and handed out from then on. Those of a macro argument point into the
+//  arguments being collected, and are NULL when they can't be worked out
+//  without lexing the argument's text.
 typedef struct hlmojo_Define
 {
     const char *identifier;
@@ -228,9 +266,26 @@ typedef struct hlmojo_Define
     const char *original;
     const char **parameters;
     int paramcount;
+    const hlmojo_CachedToken *tokens;  // up to and including TOKEN_EOI
+    unsigned int tokencount;
     struct hlmojo_Define *next;
 } hlmojo_Define;
 
+// The text of a function-like macro's expansion, and its tokens, unless they
+//  have to be lexed from the text (like after a ## paste). Kept in a pool with
+//  their memory, so expanding a macro doesn't allocate once they are big enough.
+typedef struct hlmojo_Expansion
+{
+    char *text;
+    unsigned int textlen;
+    unsigned int textcap;
+    hlmojo_CachedToken *tokens;
+    unsigned int tokencount;
+    unsigned int tokencap;
+    int tokenized;
+    struct hlmojo_Expansion *next;
+} hlmojo_Expansion;
+
 typedef struct hlmojo_IncludeState
 {
     const char *filename;
@@ -247,11 +302,41 @@ typedef struct hlmojo_IncludeState
     unsigned int line;
     hlmojo_Conditional *conditional_stack;
     MOJOSHADER_hlslang_includeClose close_callback;
+    const hlmojo_CachedToken *cached;  // the file's tokens, if lexed ahead of time
+    unsigned int cached_count;
+    unsigned int cached_next;  // handed out next, if the source is where the last one ended
+    void *cached_handle;
+    hlmojo_Expansion *expansion;  // the source, if it's a macro expansion
+    hlmojo_IncludeGuardState guard;
+    const char *guard_key;    // the file's key, if it's an include file
+    const char *guard_macro;  // of its #ifndef, once the guard is open
     struct hlmojo_IncludeState *next;
 } hlmojo_IncludeState;
 
 Token hlmojo_preprocessor_lexer(hlmojo_IncludeState *s);
 
+// Lexes a whole file as the preprocessor does outside of directives, up to and
+//  including TOKEN_EOI. Calls add for each token; stops when add returns 0.
+typedef int (*hlmojo_AddCachedToken)(const hlmojo_CachedToken *token, void *data);
+void hlmojo_preprocessor_tokenize(const char *source, unsigned int sourcelen,
+                                  hlmojo_AddCachedToken add, void *data);
+
+// Include files can have their tokens lexed ahead of time, and shared between
+//  preprocessor runs. open returns the tokens of a file (NULL to lex it as
+//  usual), and a handle for close, which is called when the file is done.
+//  With main_source set, the source the preprocessor starts with gets its
+//  tokens from open, too.
+typedef struct hlmojo_TokenCache
+{
+    const hlmojo_CachedToken *(*open)(const char *fname, const char *source,
+                                      unsigned int sourcelen,
+                                      unsigned int *count, void **handle,
+                                      void *data);
+    void (*close)(void *handle, void *data);
+    void *data;
+    int main_source;
+} hlmojo_TokenCache;
+
 // This will only fail if the allocator fails, so it doesn't return any
 //  error code...NULL on failure.
 hlmojo_Preprocessor *hlmojo_preprocessor_start(const char *fname, const char *source,
@@ -260,6 +345,7 @@ hlmojo_Preprocessor *hlmojo_preprocessor_start(const char *fname, const char *so
                             MOJOSHADER_hlslang_includeClose close_callback,
                             const MOJOSHADER_hlslang_preprocessorDefine *defines,
                             unsigned int define_count,
+                            const hlmojo_TokenCache *token_cache,
                             MOJOSHADER_hlslang_malloc m, MOJOSHADER_hlslang_free f, void *d);
 
 void hlmojo_preprocessor_end(hlmojo_Preprocessor *pp);
@@ -267,6 +353,8 @@ int hlmojo_preprocessor_outofmemory(hlmojo_Preprocessor *pp);
 const char *hlmojo_preprocessor_nexttoken(hlmojo_Preprocessor *_ctx,
                                    unsigned int *_len, Token *_token);
 const char *hlmojo_preprocessor_sourcepos(hlmojo_Preprocessor *pp, unsigned int *pos);
+// #includes that were skipped, because the file was guarded and included before.
+unsigned int hlmojo_preprocessor_skipped_includes(hlmojo_Preprocessor *pp);
 
 
 void MOJOSHADER_hlslang_print_debug_token(const char *subsystem, const char *token,
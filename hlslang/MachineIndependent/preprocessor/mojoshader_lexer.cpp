@@ -31,7 +31,9 @@ typedef unsigned char uchar;
 #define YYCURSOR cursor
 #define YYLIMIT limit
 #define YYMARKER s->lexer_marker
-#define YYFILL(n) { if ((n) == 1) { cursor = sentinel; limit = cursor + YYMAXFILL; eoi = 1; } }
+// Only a string or char literal can go on into the sentinel's zeros, and
+//  past them; it's unterminated then, instead of going around forever.
+#define YYFILL(n) { if ((n) == 1) { if (limit == sentinel + YYMAXFILL) goto unterminated_literal; cursor = sentinel; limit = cursor + YYMAXFILL; eoi = 1; } }
 
 static uchar sentinel[YYMAXFILL];
 
@@ -1545,6 +1547,9 @@ yy284:
 
     assert(0 && "Shouldn't hit this code");
     RET(TOKEN_UNKNOWN);
+
+unterminated_literal:
+    RET(TOKEN_BAD_CHARS);  // up to the end, next call will be EOI.
 } // hlmojo_preprocessor_lexer
 
 // end of mojoshader_lexer_preprocessor.re (or .c) ...
@@ -48,13 +48,23 @@ typedef struct Context
     hlmojo_Conditional *conditional_pool;
     hlmojo_IncludeState *include_stack;
     hlmojo_IncludeState *include_pool;
-    hlmojo_Define *define_hashtable[256];
+    hlmojo_Define **define_table;  // open addressing, by interned identifier
+    uint32 define_table_size;
+    uint32 define_count;
     hlmojo_Define *define_pool;
     hlmojo_Define *file_macro;
     hlmojo_Define *line_macro;
     hlmojo_StringCache *filename_cache;
+    hlmojo_StringCache *ident_cache;  // macro and parameter names
     MOJOSHADER_hlslang_includeOpen open_callback;
     MOJOSHADER_hlslang_includeClose close_callback;
+    hlmojo_TokenCache token_cache;
+    hlmojo_IncludeGuard *include_guards;
+    hlmojo_IncludeGuard *include_guard_pool;
+    unsigned int skipped_includes;
+    hlmojo_Expansion *expansion_pool;
+    hlmojo_Expansion *arg_text;      // arguments of the macro being expanded
+    hlmojo_Expansion *arg_original;  // the same, before replacing macros in them
     MOJOSHADER_hlslang_malloc malloc;
     MOJOSHADER_hlslang_free free;
     void *malloc_data;
@@ -335,69 +345,121 @@ void MOJOSHADER_hlslang_internal_include_close(const char *data, MOJOSHADER_hlsl
 IMPLEMENT_POOL(hlmojo_Conditional, conditional)
 IMPLEMENT_POOL(hlmojo_IncludeState, include)
 IMPLEMENT_POOL(hlmojo_Define, define)
+IMPLEMENT_POOL(hlmojo_IncludeGuard, include_guard)
 
 
 // hlmojo_Preprocessor define hashtable stuff...
 
-// !!! FIXME: why isn't this using mojoshader_common.c's code?
+// Macro names (and parameter names) are interned in ctx->ident_cache, so the
+//  table is keyed by pointer: no string compares, and a name that isn't in
+//  the cache can't be a macro at all. The table grows to stay at most half full;
+//  linear probing, and #undef moves later entries back instead of leaving
+//  tombstones.
 
-// this is djb's xor hashing function.
-static inline uint32 hash_string_djbxor(const char *sym)
+static const uint32 initial_define_table_size = 256;
+
+static inline uint32 hash_ident(const char *ident)
+{
+    uint64 x = (uint64) (size_t) ident;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return (uint32) x;
+} // hash_ident
+
+static inline const char *find_ident(Context *ctx, const char *sym,
+                                     const unsigned int len)
+{
+    return hlmojo_stringcache_find_len(ctx->ident_cache, sym, len);
+} // find_ident
+
+static inline const char *add_ident(Context *ctx, const char *sym,
+                                    const unsigned int len)
 {
-    register uint32 hash = 5381;
-    while (*sym)
-        hash = ((hash << 5) + hash) ^ *(sym++);
-    return hash;
-} // hash_string_djbxor
+    const char *retval = hlmojo_stringcache_len(ctx->ident_cache, sym, len);
+    if (retval == NULL)
+        out_of_memory(ctx);
+    return retval;
+} // add_ident
 
-static inline uint8 hash_define(const char *sym)
+static uint32 find_define_slot(Context *ctx, const char *ident)
+{
+    const uint32 mask = ctx->define_table_size - 1;
+    uint32 i = hash_ident(ident) & mask;
+    while ((ctx->define_table[i] != NULL) &&
+           (ctx->define_table[i]->identifier != ident))
+        i = (i + 1) & mask;
+    return i;
+} // find_define_slot
+
+static int grow_define_table(Context *ctx)
 {
-    return (uint8) hash_string_djbxor(sym);
-} // hash_define
+    hlmojo_Define **oldtable = ctx->define_table;
+    const uint32 oldsize = ctx->define_table_size;
+    const uint32 size = oldsize ? (oldsize * 2) : initial_define_table_size;
+    const size_t tablelen = sizeof (hlmojo_Define *) * size;
+    hlmojo_Define **table = (hlmojo_Define **) Malloc(ctx, tablelen);
+    if (table == NULL)
+        return 0;
+    memset(table, '\0', tablelen);
+
+    ctx->define_table = table;
+    ctx->define_table_size = size;
+
+    uint32 i;
+    for (i = 0; i < oldsize; i++)
+    {
+        if (oldtable[i] != NULL)
+            table[find_define_slot(ctx, oldtable[i]->identifier)] = oldtable[i];
+    } // for
+
+    Free(ctx, oldtable);
+    return 1;
+} // grow_define_table
 
 
 static int add_define(Context *ctx, const char *sym, const char *val,
-                      char **parameters, int paramcount)
+                      const char **parameters, int paramcount)
 {
-    const uint8 hash = hash_define(sym);
-    hlmojo_Define *bucket = ctx->define_hashtable[hash];
-    while (bucket)
+    if ((ctx->define_count + 1) * 2 > ctx->define_table_size)
     {
-        if (strcmp(bucket->identifier, sym) == 0)
-        {
-            failf(ctx, "'%s' already defined", sym); // !!! FIXME: warning?
-            // !!! FIXME: gcc reports the location of previous #define here.
+        if (!grow_define_table(ctx))
             return 0;
-        } // if
-        bucket = bucket->next;
-    } // while
+    } // if
 
-    bucket = get_define(ctx);
+    const uint32 slot = find_define_slot(ctx, sym);
+    if (ctx->define_table[slot] != NULL)
+    {
+        failf(ctx, "'%s' already defined", sym); // !!! FIXME: warning?
+        // !!! FIXME: gcc reports the location of previous #define here.
+        return 0;
+    } // if
+
+    hlmojo_Define *bucket = get_define(ctx);
     if (bucket == NULL)
         return 0;
 
     bucket->definition = val;
     bucket->original = NULL;
     bucket->identifier = sym;
-    bucket->parameters = (const char **) parameters;
+    bucket->parameters = parameters;
     bucket->paramcount = paramcount;
-    bucket->next = ctx->define_hashtable[hash];
-    ctx->define_hashtable[hash] = bucket;
+    bucket->next = NULL;
+    ctx->define_table[slot] = bucket;
+    ctx->define_count++;
     return 1;
 } // add_define
 
 
+// identifier and parameter names are interned, and not freed here.
 static void free_define(Context *ctx, hlmojo_Define *def)
 {
     if (def != NULL)
     {
-        int i;
-        for (i = 0; i < def->paramcount; i++)
-            Free(ctx, (void *) def->parameters[i]);
         Free(ctx, (void *) def->parameters);
-        Free(ctx, (void *) def->identifier);
         Free(ctx, (void *) def->definition);
         Free(ctx, (void *) def->original);
+        Free(ctx, (void *) def->tokens);
         put_define(ctx, def);
     } // if
 } // free_define
@@ -405,46 +467,57 @@ static void free_define(Context *ctx, hlmojo_Define *def)
 
 static int remove_define(Context *ctx, const char *sym)
 {
-    const uint8 hash = hash_define(sym);
-    hlmojo_Define *bucket = ctx->define_hashtable[hash];
-    hlmojo_Define *prev = NULL;
-    while (bucket)
+    const char *ident = find_ident(ctx, sym, (unsigned int) strlen(sym));
+    if ((ident == NULL) || (ctx->define_count == 0))
+        return 0;
+
+    const uint32 mask = ctx->define_table_size - 1;
+    uint32 i = find_define_slot(ctx, ident);
+    if (ctx->define_table[i] == NULL)
+        return 0;
+
+    free_define(ctx, ctx->define_table[i]);
+    ctx->define_table[i] = NULL;
+    ctx->define_count--;
+
+    // move back whatever probed past the freed slot.
+    uint32 j = i;
+    while (1)
     {
-        if (strcmp(bucket->identifier, sym) == 0)
+        j = (j + 1) & mask;
+        hlmojo_Define *def = ctx->define_table[j];
+        if (def == NULL)
+            break;
+        const uint32 home = hash_ident(def->identifier) & mask;
+        const int stays = (i <= j) ? ((i < home) && (home <= j))
+                                   : ((i < home) || (home <= j));
+        if (!stays)
         {
-            if (prev == NULL)
-                ctx->define_hashtable[hash] = bucket->next;
-            else
-                prev->next = bucket->next;
-            free_define(ctx, bucket);
-            return 1;
+            ctx->define_table[i] = def;
+            ctx->define_table[j] = NULL;
+            i = j;
         } // if
-        prev = bucket;
-        bucket = bucket->next;
     } // while
 
-    return 0;
+    return 1;
 } // remove_define
 
 
-static const hlmojo_Define *find_define(Context *ctx, const char *sym)
+static const hlmojo_Define *find_define_len(Context *ctx, const char *sym,
+                                            const unsigned int len)
 {
-    const uint8 hash = hash_define(sym);
-    hlmojo_Define *bucket = ctx->define_hashtable[hash];
-    while (bucket)
-    {
-        if (strcmp(bucket->identifier, sym) == 0)
-            return bucket;
-        bucket = bucket->next;
-    } // while
-
-    const uint8 filestrhash = 67;
-    assert(hash_define("__FILE__") == filestrhash);
+    const char *ident = find_ident(ctx, sym, len);
+    if (ident == NULL)
+        return NULL;
 
-    const uint8 linestrhash = 75;
-    assert(hash_define("__LINE__") == linestrhash);
+    if (ctx->define_count > 0)
+    {
+        hlmojo_Define *def = ctx->define_table[find_define_slot(ctx, ident)];
+        if (def != NULL)
+            return def;
+    } // if
 
-    if ( (hash == filestrhash) && (ctx->file_macro) && (strcmp(sym, "__FILE__") == 0) )
+    if ( (ctx->file_macro) && (ident == ctx->file_macro->identifier) )
     {
         Free(ctx, (char *) ctx->file_macro->definition);
         const hlmojo_IncludeState *state = ctx->include_stack;
@@ -460,7 +533,7 @@ static const hlmojo_Define *find_define(Context *ctx, const char *sym)
         return ctx->file_macro;
     } // if
 
-    else if ( (hash == linestrhash) && (ctx->line_macro) && (strcmp(sym, "__LINE__") == 0) )
+    else if ( (ctx->line_macro) && (ident == ctx->line_macro->identifier) )
     {
         Free(ctx, (char *) ctx->line_macro->definition);
         const hlmojo_IncludeState *state = ctx->include_stack;
@@ -476,6 +549,12 @@ static const hlmojo_Define *find_define(Context *ctx, const char *sym)
     } // else
 
     return NULL;
+} // find_define_len
+
+
+static inline const hlmojo_Define *find_define(Context *ctx, const char *sym)
+{
+    return find_define_len(ctx, sym, (unsigned int) strlen(sym));
 } // find_define
 
 
@@ -483,47 +562,236 @@ static const hlmojo_Define *find_define_by_token(Context *ctx)
 {
     hlmojo_IncludeState *state = ctx->include_stack;
     assert(state->tokenval == TOKEN_IDENTIFIER);
-    char *sym = (char *) alloca(state->tokenlen+1);
-    memcpy(sym, state->token, state->tokenlen);
-    sym[state->tokenlen] = '\0';
-    return find_define(ctx, sym);
+    return find_define_len(ctx, state->token, state->tokenlen);
 } // find_define_by_token
 
 
-static const hlmojo_Define *find_macro_arg(const hlmojo_IncludeState *state,
+static const hlmojo_Define *find_macro_arg(Context *ctx,
+                                    const hlmojo_IncludeState *state,
                                     const hlmojo_Define *defines)
 {
-    const hlmojo_Define *def = NULL;
-    char *sym = (char *) alloca(state->tokenlen + 1);
-    memcpy(sym, state->token, state->tokenlen);
-    sym[state->tokenlen] = '\0';
+    if (defines == NULL)
+        return NULL;
 
-    for (def = defines; def != NULL; def = def->next)
+    const char *ident = find_ident(ctx, state->token, state->tokenlen);
+    const hlmojo_Define *def = NULL;
+    for (def = defines; (ident != NULL) && (def != NULL); def = def->next)
     {
         assert(def->parameters == NULL);  // args can't have args!
         assert(def->paramcount == 0);  // args can't have args!
-        if (strcmp(def->identifier, sym) == 0)
-            break;
+        if (def->identifier == ident)
+            return def;
     } // while
 
-    return def;
+    return NULL;
 } // find_macro_arg
 
 
-static void put_all_defines(Context *ctx)
+// Macro expansions...
+
+// Returns array with room for at least needed elements, moved to a bigger
+//  allocation if it had to grow; NULL if out of memory (array is kept then).
+static void *grow_array(Context *ctx, void *array, unsigned int *cap,
+                        const unsigned int needed, const size_t elemsize)
 {
-    size_t i;
-    for (i = 0; i < STATICARRAYLEN(ctx->define_hashtable); i++)
+    if (needed <= *cap)
+        return array;
+
+    unsigned int newcap = (*cap > 0) ? *cap : 64;
+    while (newcap < needed)
+        newcap *= 2;
+
+    void *retval = Malloc(ctx, newcap * elemsize);
+    if (retval == NULL)
+        return NULL;
+    if (*cap > 0)
+        memcpy(retval, array, *cap * elemsize);
+    Free(ctx, array);
+    *cap = newcap;
+    return retval;
+} // grow_array
+
+
+// not GET_POOL, that would clear out the memory it keeps.
+static hlmojo_Expansion *get_expansion(Context *ctx)
+{
+    hlmojo_Expansion *retval = ctx->expansion_pool;
+    if (retval != NULL)
+        ctx->expansion_pool = retval->next;
+    else
     {
-        hlmojo_Define *bucket = ctx->define_hashtable[i];
-        ctx->define_hashtable[i] = NULL;
-        while (bucket)
+        retval = (hlmojo_Expansion *) Malloc(ctx, sizeof (hlmojo_Expansion));
+        if (retval == NULL)
+            return NULL;
+        memset(retval, '\0', sizeof (hlmojo_Expansion));
+    } // else
+
+    retval->textlen = 0;
+    retval->tokencount = 0;
+    retval->tokenized = 1;
+    retval->next = NULL;
+    return retval;
+} // get_expansion
+
+static void put_expansion(Context *ctx, hlmojo_Expansion *expansion)
+{
+    expansion->next = ctx->expansion_pool;
+    ctx->expansion_pool = expansion;
+} // put_expansion
+
+static void free_expansion(Context *ctx, hlmojo_Expansion *expansion)
+{
+    if (expansion != NULL)
+    {
+        Free(ctx, expansion->text);
+        Free(ctx, expansion->tokens);
+        Free(ctx, expansion);
+    } // if
+} // free_expansion
+
+static void free_expansion_pool(Context *ctx)
+{
+    hlmojo_Expansion *item = ctx->expansion_pool;
+    while (item != NULL)
+    {
+        hlmojo_Expansion *next = item->next;
+        free_expansion(ctx, item);
+        item = next;
+    } // while
+    ctx->expansion_pool = NULL;
+} // free_expansion_pool
+
+// Adds len bytes of text, and a zero after them that isn't counted.
+static int expansion_append(Context *ctx, hlmojo_Expansion *expansion,
+                            const char *data, const unsigned int len)
+{
+    char *text = (char *) grow_array(ctx, expansion->text, &expansion->textcap,
+                                     expansion->textlen + len + 1, 1);
+    if (text == NULL)
+        return 0;
+    expansion->text = text;
+    memcpy(text + expansion->textlen, data, len);
+    expansion->textlen += len;
+    text[expansion->textlen] = '\0';
+    return 1;
+} // expansion_append
+
+// Adds a token of the text (at offset), as long as the expansion can still
+//  hand out tokens without lexing. Those that could come out differently at
+//  the start of the text, where the lexer looks for directives, or anywhere
+//  else (a quote in bad chars can start a literal with text after it), make
+//  it give up on that.
+static int expansion_token(Context *ctx, hlmojo_Expansion *expansion,
+                           const Token tokenval, const unsigned int offset,
+                           const unsigned int length)
+{
+    if (!expansion->tokenized)
+        return 1;
+
+    if ( (tokenval >= TOKEN_PP_INCLUDE) || (tokenval == TOKEN_BAD_CHARS) ||
+         ((expansion->tokencount == 0) &&
+         ((tokenval == TOKEN_HASH) || (tokenval == TOKEN_HASHHASH))) )
+    {
+        expansion->tokenized = 0;
+        return 1;
+    } // if
+
+    hlmojo_CachedToken *tokens = (hlmojo_CachedToken *)
+        grow_array(ctx, expansion->tokens, &expansion->tokencap,
+                   expansion->tokencount + 1, sizeof (hlmojo_CachedToken));
+    if (tokens == NULL)
+        return 0;
+    expansion->tokens = tokens;
+
+    hlmojo_CachedToken *token = &tokens[expansion->tokencount++];
+    token->tokenval = tokenval;
+    token->offset = offset;
+    token->length = length;
+    token->lines = 0;
+    return 1;
+} // expansion_token
+
+// Adds the tokens of a macro or argument, with its text at offset.
+static int expansion_tokens(Context *ctx, hlmojo_Expansion *expansion,
+                            const hlmojo_CachedToken *tokens,
+                            const unsigned int count, const unsigned int offset)
+{
+    unsigned int i;
+    if (tokens == NULL)
+        expansion->tokenized = 0;
+    for (i = 0; (i < count) && (expansion->tokenized); i++)
+    {
+        if (tokens[i].tokenval == TOKEN_EOI)
+            break;
+        else if (tokens[i].lines > 0)
+            expansion->tokenized = 0;
+        else if (!expansion_token(ctx, expansion, tokens[i].tokenval,
+                                  offset + tokens[i].offset, tokens[i].length))
+            return 0;
+    } // for
+    return 1;
+} // expansion_tokens
+
+
+typedef struct DefineTokens
+{
+    Context *ctx;
+    hlmojo_CachedToken *tokens;
+    unsigned int count;
+    unsigned int cap;
+} DefineTokens;
+
+static int add_define_token(const hlmojo_CachedToken *token, void *data)
+{
+    DefineTokens *dt = (DefineTokens *) data;
+    hlmojo_CachedToken *tokens = (hlmojo_CachedToken *)
+        grow_array(dt->ctx, dt->tokens, &dt->cap, dt->count + 1,
+                   sizeof (hlmojo_CachedToken));
+    if (tokens == NULL)
+        return 0;
+    dt->tokens = tokens;
+    dt->tokens[dt->count++] = *token;
+    return 1;
+} // add_define_token
+
+// The tokens of a macro's definition, lexed the first time they're asked for.
+//  __FILE__ and __LINE__ have none, their definition changes all the time.
+static const hlmojo_CachedToken *define_tokens(Context *ctx,
+                                               const hlmojo_Define *_def)
+{
+    hlmojo_Define *def = (hlmojo_Define *) _def;
+    if ( (def->tokens == NULL) && (def != ctx->file_macro) &&
+         (def != ctx->line_macro) && (def->definition != NULL) )
+    {
+        DefineTokens dt;
+        memset(&dt, '\0', sizeof (dt));
+        dt.ctx = ctx;
+        hlmojo_preprocessor_tokenize(def->definition,
+                                     (unsigned int) strlen(def->definition),
+                                     add_define_token, &dt);
+        if ((dt.count > 0) && (dt.tokens[dt.count-1].tokenval == TOKEN_EOI))
         {
-            hlmojo_Define *next = bucket->next;
-            free_define(ctx, bucket);
-            bucket = next;
-        } // while
+            def->tokens = dt.tokens;
+            def->tokencount = dt.count;
+        } // if
+        else
+        {
+            Free(ctx, dt.tokens);  // out of memory.
+        } // else
+    } // if
+    return def->tokens;
+} // define_tokens
+
+
+static void put_all_defines(Context *ctx)
+{
+    uint32 i;
+    for (i = 0; i < ctx->define_table_size; i++)
+    {
+        free_define(ctx, ctx->define_table[i]);
+        ctx->define_table[i] = NULL;
     } // for
+    ctx->define_count = 0;
 } // put_all_defines
 
 
@@ -576,6 +844,12 @@ static void pop_source(Context *ctx)
                               ctx->free, ctx->malloc_data);
     } // if
 
+    if (state->cached_handle)
+        ctx->token_cache.close(state->cached_handle, ctx->token_cache.data);
+
+    if (state->expansion)
+        put_expansion(ctx, state->expansion);
+
     // state->filename is a pointer to the filename cache; don't free it here!
 
     hlmojo_Conditional *cond = state->conditional_stack;
@@ -607,6 +881,7 @@ hlmojo_Preprocessor *hlmojo_preprocessor_start(const char *fname, const char *so
                             MOJOSHADER_hlslang_includeClose close_callback,
                             const MOJOSHADER_hlslang_preprocessorDefine *defines,
                             unsigned int define_count,
+                            const hlmojo_TokenCache *token_cache,
                             MOJOSHADER_hlslang_malloc m, MOJOSHADER_hlslang_free f, void *d)
 {
     int okay = 1;
@@ -626,19 +901,26 @@ hlmojo_Preprocessor *hlmojo_preprocessor_start(const char *fname, const char *so
     ctx->malloc_data = d;
     ctx->open_callback = open_callback;
     ctx->close_callback = close_callback;
+    if (token_cache != NULL)
+        ctx->token_cache = *token_cache;
 
     ctx->filename_cache = hlmojo_stringcache_create(MallocBridge, FreeBridge, ctx);
     okay = ((okay) && (ctx->filename_cache != NULL));
 
+    ctx->ident_cache = hlmojo_stringcache_create(MallocBridge, FreeBridge, ctx);
+    okay = ((okay) && (ctx->ident_cache != NULL));
+
+    okay = ((okay) && (grow_define_table(ctx)));
+
     ctx->file_macro = get_define(ctx);
     okay = ((okay) && (ctx->file_macro != NULL));
     if ((okay) && (ctx->file_macro))
-        okay = ((ctx->file_macro->identifier = StrDup(ctx, "__FILE__")) != 0);
+        okay = ((ctx->file_macro->identifier = add_ident(ctx, "__FILE__", 8)) != 0);
 
     ctx->line_macro = get_define(ctx);
     okay = ((okay) && (ctx->line_macro != NULL));
     if ((okay) && (ctx->line_macro))
-        okay = ((ctx->line_macro->identifier = StrDup(ctx, "__LINE__")) != 0);
+        okay = ((ctx->line_macro->identifier = add_ident(ctx, "__LINE__", 8)) != 0);
 
     // let the usual preprocessor parser sort these out.
     char *define_include = NULL;
@@ -665,6 +947,15 @@ hlmojo_Preprocessor *hlmojo_preprocessor_start(const char *fname, const char *so
     if ((okay) && (!push_source(ctx,fname,source,sourcelen,1,NULL)))
         okay = 0;
 
+    if ((okay) && (token_cache != NULL) && (token_cache->main_source))
+    {
+        hlmojo_IncludeState *state = ctx->include_stack;
+        state->cached = token_cache->open(fname, source, sourcelen,
+                                          &state->cached_count,
+                                          &state->cached_handle,
+                                          token_cache->data);
+    } // if
+
     if ((okay) && (define_include_len > 0))
     {
         assert(define_include != NULL);
@@ -692,15 +983,30 @@ void hlmojo_preprocessor_end(hlmojo_Preprocessor *_ctx)
         pop_source(ctx);
 
     put_all_defines(ctx);
+    Free(ctx, ctx->define_table);
+
+    while (ctx->include_guards != NULL)
+    {
+        hlmojo_IncludeGuard *next = ctx->include_guards->next;
+        put_include_guard(ctx, ctx->include_guards);
+        ctx->include_guards = next;
+    } // while
 
     if (ctx->filename_cache != NULL)
         hlmojo_stringcache_destroy(ctx->filename_cache);
 
+    if (ctx->ident_cache != NULL)
+        hlmojo_stringcache_destroy(ctx->ident_cache);
+
     free_define(ctx, ctx->file_macro);
     free_define(ctx, ctx->line_macro);
     free_define_pool(ctx);
     free_conditional_pool(ctx);
     free_include_pool(ctx);
+    free_include_guard_pool(ctx);
+    free_expansion(ctx, ctx->arg_text);
+    free_expansion(ctx, ctx->arg_original);
+    free_expansion_pool(ctx);
 
     Free(ctx, ctx);
 } // hlmojo_preprocessor_end
@@ -723,10 +1029,122 @@ static inline void pushback(hlmojo_IncludeState *state)
 } // pushback
 
 
+void hlmojo_preprocessor_tokenize(const char *source, unsigned int sourcelen,
+                                  hlmojo_AddCachedToken add, void *data)
+{
+    hlmojo_IncludeState state;
+    memset(&state, '\0', sizeof (state));
+    state.source_base = source;
+    state.source = source;
+    state.token = source;
+    state.tokenval = ((Token) '\n');  // like push_source()
+    state.orig_length = sourcelen;
+    state.bytes_left = sourcelen;
+
+    while (1)
+    {
+        const unsigned int line = state.line;
+        hlmojo_CachedToken token;
+        token.tokenval = hlmojo_preprocessor_lexer(&state);
+        token.offset = (unsigned int) (state.token - source);
+        token.length = state.tokenlen;
+        token.lines = state.line - line;
+        if ((!add(&token, data)) || (token.tokenval == TOKEN_EOI))
+            break;
+    } // while
+} // hlmojo_preprocessor_tokenize
+
+
+// Whether there's nothing but spaces and tabs from ptr to end, which the
+//  lexer would return as one ' ' token when whitespace is reported.
+static int only_blanks(const char *ptr, const char *end)
+{
+    while ((ptr < end) && ((*ptr == ' ') || (*ptr == '\t') || (*ptr == '\v') || (*ptr == '\f')))
+        ptr++;
+    return (ptr == end);
+} // only_blanks
+
+// Hands out the tokens of a file lexed ahead of time, as long as the lexer
+//  would return the same: when the source is still where the last of them
+//  ended. They have no whitespace, so when it's reported, only plain spaces
+//  and tabs before the next of them can be (as one token), and not at the
+//  start of a line, where the lexer skips them. Otherwise lexes, and gets back
+//  to them once the lexer returns one of them again.
+static Token cached_lexer(hlmojo_IncludeState *state)
+{
+    const hlmojo_CachedToken *cached = state->cached;
+    const unsigned int pos = (unsigned int) (state->source - state->source_base);
+    const unsigned int next = state->cached_next;
+    const unsigned int last_end = (next == 0) ? 0 : cached[next-1].offset + cached[next-1].length;
+    const int whitespace = state->report_whitespace;
+
+    if ( (next < state->cached_count) &&
+         ((!whitespace) || (state->tokenval != ((Token) '\n'))) )
+    {
+        const char *end = state->source_base + cached[next].offset;
+        int resume = (pos == last_end);
+        if ( (!resume) && (whitespace) && (state->tokenval == ((Token) ' ')) &&
+             (state->source == end) &&
+             (state->token == state->source_base + last_end) )
+            resume = only_blanks(state->token, end);  // after blanks we returned
+
+        if ((resume) && (whitespace) && (state->source < end))
+        {
+            if (!only_blanks(state->source, end))
+                goto cached_lexer_lex;  // comments, newlines...
+            state->token = state->source;
+            state->tokenlen = (unsigned int) (end - state->source);
+            state->tokenval = (Token) ' ';
+            state->source = end;
+            state->bytes_left = state->orig_length - cached[next].offset;
+            return state->tokenval;
+        } // if
+
+        if (resume)
+        {
+            const hlmojo_CachedToken *t = &cached[next];
+            state->cached_next = next + 1;
+            state->token = state->source_base + t->offset;
+            state->tokenlen = t->length;
+            state->tokenval = t->tokenval;
+            state->source = state->token + t->length;
+            state->bytes_left = state->orig_length - (t->offset + t->length);
+            state->line += t->lines;
+            return t->tokenval;
+        } // if
+    } // if
+
+cached_lexer_lex:
+    const Token token = hlmojo_preprocessor_lexer(state);
+
+    // the lexer goes on the same from the end of a token it returned before
+    const unsigned int offset = (unsigned int) (state->token - state->source_base);
+    unsigned int lo = 0;
+    unsigned int hi = state->cached_count;
+    while (lo < hi)
+    {
+        const unsigned int mid = (lo + hi) / 2;
+        if (cached[mid].offset < offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    } // while
+    if ( (lo < state->cached_count) && (cached[lo].offset == offset) &&
+         (cached[lo].length == state->tokenlen) && (cached[lo].tokenval == token) )
+        state->cached_next = lo + 1;
+
+    return token;
+} // cached_lexer
+
+
 static Token lexer(hlmojo_IncludeState *state)
 {
     if (!state->pushedback)
+    {
+        if (state->cached)
+            return cached_lexer(state);
         return hlmojo_preprocessor_lexer(state);
+    } // if
     state->pushedback = 0;
     return state->tokenval;
 } // lexer
@@ -752,6 +1170,121 @@ static int token_to_int(hlmojo_IncludeState *state)
 } // token_to_int
 
 
+// Include guards...
+
+// A file wrapped in #ifndef X / #define X ... #endif, with nothing but comments
+//  around it, gives nothing when included again while X is defined; neither
+//  does one with #pragma once. Such files aren't opened (or lexed) again.
+//  Include files are followed through INCLUDEGUARD_START, _OPEN and _CLOSED
+//  as their top level tokens go by (see track_include_guard()), and their
+//  guard is remembered when they end in _CLOSED.
+
+// There's no knowing which file the open callback finds for a name, so the
+//  key is the name, and for #include "..." the directory of the including
+//  file, where C looks first. <...> looks in the same places from anywhere.
+static const char *include_guard_key(Context *ctx,
+                                     MOJOSHADER_hlslang_includeType incltype,
+                                     const char *parent, const char *filename)
+{
+    unsigned int dirlen = 0;
+    if ((incltype == MOJOSHADER_hlslang_INCLUDETYPE_LOCAL) && (parent != NULL))
+    {
+        const char *ptr;
+        for (ptr = parent; *ptr; ptr++)
+        {
+            if ((*ptr == '/') || (*ptr == '\\'))
+                dirlen = (unsigned int) (ptr - parent) + 1;
+        } // for
+    } // if
+
+    const unsigned int namelen = (unsigned int) strlen(filename);
+    char *key = (char *) alloca(dirlen + namelen + 1);
+    key[0] = (incltype == MOJOSHADER_hlslang_INCLUDETYPE_SYSTEM) ? '<' : '\"';
+    memcpy(key + 1, parent, dirlen);
+    memcpy(key + 1 + dirlen, filename, namelen);
+    return hlmojo_stringcache_len(ctx->filename_cache, key, dirlen + namelen + 1);
+} // include_guard_key
+
+
+static hlmojo_IncludeGuard *find_include_guard(Context *ctx, const char *key)
+{
+    hlmojo_IncludeGuard *guard;
+    for (guard = ctx->include_guards; guard != NULL; guard = guard->next)
+    {
+        if (guard->key == key)
+            return guard;
+    } // for
+    return NULL;
+} // find_include_guard
+
+
+static void add_include_guard(Context *ctx, const char *key,
+                              const char *macro, const int once)
+{
+    hlmojo_IncludeGuard *guard = find_include_guard(ctx, key);
+    if (guard == NULL)
+    {
+        guard = get_include_guard(ctx);
+        if (guard == NULL)
+            return;
+        guard->key = key;
+        guard->next = ctx->include_guards;
+        ctx->include_guards = guard;
+    } // if
+
+    if (macro != NULL)
+        guard->macro = macro;
+    if (once)
+        guard->once = 1;
+} // add_include_guard
+
+
+static int include_guard_holds(Context *ctx, const hlmojo_IncludeGuard *guard)
+{
+    if (guard->once)
+        return 1;
+    else if ((guard->macro == NULL) || (ctx->define_count == 0))
+        return 0;
+    return (ctx->define_table[find_define_slot(ctx, guard->macro)] != NULL);
+} // include_guard_holds
+
+
+// Called with every token of an include file but newlines, before it's
+//  handled; _handle_pp_ifdef() picks up the macro name of the guard.
+static void track_include_guard(hlmojo_IncludeState *state, const Token token)
+{
+    const hlmojo_Conditional *cond = state->conditional_stack;
+    switch (state->guard)
+    {
+        case INCLUDEGUARD_START:
+            if (token == TOKEN_PP_IFNDEF)
+                state->guard = INCLUDEGUARD_OPEN;
+            else if (token != TOKEN_EOI)
+                state->guard = INCLUDEGUARD_NONE;
+            break;
+
+        case INCLUDEGUARD_OPEN:
+            if ((cond == NULL) || (state->guard_macro == NULL))
+                state->guard = INCLUDEGUARD_NONE;  // the #ifndef failed.
+            else if (cond->next != NULL)
+                break;  // nested block.
+            else if (token == TOKEN_PP_ENDIF)
+                state->guard = INCLUDEGUARD_CLOSED;
+            else if ((token == TOKEN_PP_ELSE) || (token == TOKEN_PP_ELIF))
+                state->guard = INCLUDEGUARD_NONE;
+            break;
+
+        case INCLUDEGUARD_CLOSED:
+            if (token != TOKEN_EOI)
+                state->guard = INCLUDEGUARD_NONE;
+            break;
+
+        default:
+            break;
+    } // switch
+} // track_include_guard
+
+
 static void handle_pp_include(Context *ctx)
 {
     hlmojo_IncludeState *state = ctx->include_stack;
@@ -812,6 +1345,14 @@ static void handle_pp_include(Context *ctx)
         return;
     } // if
 
+    const char *key = include_guard_key(ctx, incltype, state->filename, filename);
+    const hlmojo_IncludeGuard *guard = key ? find_include_guard(ctx, key) : NULL;
+    if ((guard != NULL) && (include_guard_holds(ctx, guard)))
+    {
+        ctx->skipped_includes++;
+        return;
+    } // if
+
     if (!ctx->open_callback(incltype, filename, state->filename, state->source_base,
                             &newdata, &newbytes, ctx->malloc,
                             ctx->free, ctx->malloc_data))
@@ -825,6 +1366,22 @@ static void handle_pp_include(Context *ctx)
     {
         assert(ctx->out_of_memory);
         ctx->close_callback(newdata, ctx->malloc, ctx->free, ctx->malloc_data);
+        return;
+    } // if
+
+    hlmojo_IncludeState *incl = ctx->include_stack;
+    if (key != NULL)
+    {
+        incl->guard = INCLUDEGUARD_START;
+        incl->guard_key = key;
+    } // if
+
+    if (ctx->token_cache.open != NULL)
+    {
+        incl->cached = ctx->token_cache.open(filename, newdata, newbytes,
+                                             &incl->cached_count,
+                                             &incl->cached_handle,
+                                             ctx->token_cache.data);
     } // if
 } // handle_pp_include
 
@@ -930,6 +1487,8 @@ static void handle_pp_error(Context *ctx)
 static void handle_pp_pragma(Context *ctx)
 {
     hlmojo_IncludeState *state = ctx->include_stack;
+    int words = 0;
+    int once = 0;
     int done = 0;
 
     state->report_whitespace = 1;
@@ -948,14 +1507,23 @@ static void handle_pp_pragma(Context *ctx)
                 done = 1;
                 break;
 
+            case ((Token) ' '):
+                break;
+
             default:
-                // just strip #pragma from source
+                // just strip #pragma from source, but remember #pragma once
+                once = ( (words++ == 0) && (token == TOKEN_IDENTIFIER) &&
+                         (state->tokenlen == 4) &&
+                         (memcmp(state->token, "once", 4) == 0) );
                 break;
         } // switch
     } // while
 
     state->report_whitespace = 0;
 
+    if ((once) && (state->guard_key != NULL))
+        add_include_guard(ctx, state->guard_key, NULL, 1);
+
 } // handle_pp_pragma
 
 
@@ -971,15 +1539,12 @@ static void handle_pp_define(Context *ctx)
     } // if
 
     char *definition = NULL;
-    char *sym = (char *) Malloc(ctx, state->tokenlen+1);
+    const char *sym = add_ident(ctx, state->token, state->tokenlen);
     if (sym == NULL)
         return;
-    memcpy(sym, state->token, state->tokenlen);
-    sym[state->tokenlen] = '\0';
 
     if (strcmp(sym, "defined") == 0)
     {
-        Free(ctx, sym);
         fail(ctx, "'defined' cannot be used as a macro name");
         return;
     } // if
@@ -1010,7 +1575,7 @@ static void handle_pp_define(Context *ctx)
     state->report_whitespace = 0;
 
     int params = 0;
-    char **idents = NULL;
+    const char **idents = NULL;
     static const char space = ' ';
 	int hashhash_error = 0;
 	hlmojo_Buffer *buffer = NULL;
@@ -1041,7 +1606,7 @@ static void handle_pp_define(Context *ctx)
             params = -1;
         else
         {
-            idents = (char **) Malloc(ctx, sizeof (char *) * params);
+            idents = (const char **) Malloc(ctx, sizeof (char *) * params);
             if (idents == NULL)
                 goto handle_pp_define_failed;
 
@@ -1055,14 +1620,10 @@ static void handle_pp_define(Context *ctx)
                 lexer(state);
                 assert(state->tokenval == TOKEN_IDENTIFIER);
 
-                char *dst = (char *) Malloc(ctx, state->tokenlen+1);
-                if (dst == NULL)
+                idents[i] = add_ident(ctx, state->token, state->tokenlen);
+                if (idents[i] == NULL)
                     break;
 
-                memcpy(dst, state->token, state->tokenlen);
-                dst[state->tokenlen] = '\0';
-                idents[i] = dst;
-
                 if (i < (params-1))
                 {
                     lexer(state);
@@ -1159,14 +1720,8 @@ static void handle_pp_define(Context *ctx)
     return;
 
 handle_pp_define_failed:
-    Free(ctx, sym);
     Free(ctx, definition);
-    if (idents != NULL)
-    {
-        while (params--)
-            Free(ctx, idents[params]);
-    } // if
-    Free(ctx, idents);
+    Free(ctx, (void *) idents);
 } // handle_pp_define
 
 
@@ -1254,6 +1809,11 @@ static hlmojo_Conditional *_handle_pp_ifdef(Context *ctx, const Token type)
     conditional->chosen = chosen;
     conditional->next = parent;
     state->conditional_stack = conditional;
+
+    if ( (state->guard == INCLUDEGUARD_OPEN) && (parent == NULL) &&
+         (state->guard_macro == NULL) )
+        state->guard_macro = add_ident(ctx, sym, (unsigned int) strlen(sym));
+
     return conditional;
 } // _handle_pp_ifdef
 
@@ -1270,22 +1830,39 @@ static inline void handle_pp_ifndef(Context *ctx)
 } // handle_pp_ifndef
 
 
+// Pushes a macro's definition, handing out its tokens instead of lexing it.
+static int push_define(Context *ctx, const hlmojo_Define *def,
+                       const char *fname, const unsigned int line)
+{
+    const hlmojo_CachedToken *tokens = define_tokens(ctx, def);
+    const unsigned int deflen = (tokens != NULL) ?
+                tokens[def->tokencount-1].offset :
+                (unsigned int) strlen(def->definition);
+
+    if (!push_source(ctx, fname, def->definition, deflen, line, NULL))
+        return 0;
+
+    ctx->include_stack->cached = tokens;
+    ctx->include_stack->cached_count = (tokens != NULL) ? def->tokencount : 0;
+    return 1;
+} // push_define
+
+
 static int replace_and_push_macro(Context *ctx, const hlmojo_Define *def,
                                   const hlmojo_Define *params)
 {
-    char *final = NULL;
-
-    // We push the #define and lex it, building a buffer with argument
-    //  replacement, stringification, and concatenation.
-    hlmojo_Buffer *buffer = hlmojo_buffer_create(128, MallocBridge, FreeBridge, ctx);
-    if (buffer == NULL)
+    // We push the #define and go through its tokens, building the expansion
+    //  with argument replacement, stringification, and concatenation. It
+    //  gets the tokens of what goes into it along the way, so it doesn't
+    //  have to be lexed again, unless something was concatenated.
+    hlmojo_Expansion *expansion = get_expansion(ctx);
+    if (expansion == NULL)
         return 0;
 
     hlmojo_IncludeState *state = ctx->include_stack;
-    if (!push_source(ctx, state->filename, def->definition,
-                     strlen(def->definition), state->line, NULL))
+    if (!push_define(ctx, def, state->filename, state->line))
     {
-        hlmojo_buffer_destroy(buffer);
+        put_expansion(ctx, expansion);
         return 0;
     } // if
 
@@ -1299,32 +1876,31 @@ static int replace_and_push_macro(Context *ctx, const hlmojo_Define *def,
         if (state->tokenval == TOKEN_HASHHASH)  // concatenate?
         {
             wantorig = 1;
+            expansion->tokenized = 0;
             lexer(state);
             assert(state->tokenval != TOKEN_EOI);
         } // if
         else
         {
-            if (hlmojo_buffer_size(buffer) > 0)
+            if (expansion->textlen > 0)
             {
-                if (!hlmojo_buffer_append(buffer, " ", 1))
+                if (!expansion_append(ctx, expansion, " ", 1))
                     goto replace_and_push_macro_failed;
             } // if
         } // else
 
         const char *data = state->token;
         unsigned int len = state->tokenlen;
+        const unsigned int offset = expansion->textlen;
 
         if (state->tokenval == TOKEN_HASH)  // stringify?
         {
             lexer(state);
             assert(state->tokenval != TOKEN_EOI);  // we checked for this.
 
-            if (!hlmojo_buffer_append(buffer, "\"", 1))
-                goto replace_and_push_macro_failed;
-
             if (state->tokenval == TOKEN_IDENTIFIER)
             {
-                arg = find_macro_arg(state, params);
+                arg = find_macro_arg(ctx, state, params);
                 if (arg != NULL)
                 {
                     data = arg->original;
@@ -1332,18 +1908,36 @@ static int replace_and_push_macro(Context *ctx, const hlmojo_Define *def,
                 } // if
             } // if
 
-            if (!hlmojo_buffer_append(buffer, data, len))
+            if (!expansion_append(ctx, expansion, "\"", 1))
+                goto replace_and_push_macro_failed;
+
+            if (!expansion_append(ctx, expansion, data, len))
                 goto replace_and_push_macro_failed;
 
-            if (!hlmojo_buffer_append(buffer, "\"", 1))
+            if (!expansion_append(ctx, expansion, "\"", 1))
+                goto replace_and_push_macro_failed;
+
+            // one string literal, unless something in it ends it early.
+            unsigned int i;
+            for (i = 0; i < len; i++)
+            {
+                const char ch = data[i];
+                if ((ch == '\"') || (ch == '\\') || (ch == '\r') || (ch == '\n'))
+                    expansion->tokenized = 0;
+            } // for
+
+            if (!expansion_token(ctx, expansion, TOKEN_STRING_LITERAL,
+                                 offset, len + 2))
                 goto replace_and_push_macro_failed;
 
             continue;
         } // if
 
+        const hlmojo_CachedToken *tokens = NULL;
+        unsigned int tokencount = 0;
         if (state->tokenval == TOKEN_IDENTIFIER)
         {
-            arg = find_macro_arg(state, params);
+            arg = find_macro_arg(ctx, state, params);
             if (arg != NULL)
             {
                 if (!wantorig)
@@ -1353,37 +1947,84 @@ static int replace_and_push_macro(Context *ctx, const hlmojo_Define *def,
                 } // if
                 data = wantorig ? arg->original : arg->definition;
                 len = strlen(data);
+                tokens = arg->tokens;
+                tokencount = arg->tokencount;
             } // if
         } // if
 
-        if (!hlmojo_buffer_append(buffer, data, len))
+        if (!expansion_append(ctx, expansion, data, len))
+            goto replace_and_push_macro_failed;
+
+        if (wantorig)
+            expansion->tokenized = 0;
+        else if (arg != NULL)
+        {
+            if (!expansion_tokens(ctx, expansion, tokens, tokencount, offset))
+                goto replace_and_push_macro_failed;
+        } // else if
+        else if (!expansion_token(ctx, expansion, state->tokenval, offset, len))
             goto replace_and_push_macro_failed;
     } // while
 
-    final = hlmojo_buffer_flatten(buffer);
-    if (!final)
+    if (expansion->tokenized)
+    {
+        if (!expansion_token(ctx, expansion, TOKEN_EOI, expansion->textlen, 0))
+            goto replace_and_push_macro_failed;
+    } // if
+
+    if ((expansion->text == NULL) && (!expansion_append(ctx, expansion, "", 0)))
         goto replace_and_push_macro_failed;
 
-    hlmojo_buffer_destroy(buffer);
     pop_source(ctx);  // ditch the macro.
     state = ctx->include_stack;
-    if (!push_source(ctx, state->filename, final, strlen(final), state->line,
-                     close_define_include))
+    if (!push_source(ctx, state->filename, expansion->text,
+                     expansion->textlen, state->line, NULL))
     {
-        Free(ctx, final);
+        put_expansion(ctx, expansion);
         return 0;
     } // if
 
+    state = ctx->include_stack;
+    state->expansion = expansion;
+    if (expansion->tokenized)
+    {
+        state->cached = expansion->tokens;
+        state->cached_count = expansion->tokencount;
+    } // if
+
     return 1;
 
 replace_and_push_macro_failed:
     pop_source(ctx);
-    hlmojo_buffer_destroy(buffer);
+    put_expansion(ctx, expansion);
     return 0;
 } // replace_and_push_macro
 
 
-static int handle_macro_args(Context *ctx, const char *sym, const hlmojo_Define *def)
+// Whether text ending with char a can be followed by text starting with b,
+//  and lex into the tokens of the two. Lexing either one might have been cut
+//  short by the end of its text, unless one of the chars can only be a token
+//  of its own (outside of literals and comments, which can't be cut short).
+static int joins_safely(const char a, const char b)
+{
+    static const char alone[] = "()[]{},;:?~";
+    return ( ((a != '\0') && (strchr(alone, a) != NULL)) ||
+             ((b != '\0') && (strchr(alone, b) != NULL)) );
+} // joins_safely
+
+
+// Where an argument is in ctx->arg_text and ctx->arg_original, while they
+//  are still growing.
+typedef struct MacroArg
+{
+    unsigned int text;
+    unsigned int original;
+    unsigned int token;
+    unsigned int tokencount;
+    int tokenized;
+} MacroArg;
+
+static int handle_macro_args(Context *ctx, const hlmojo_Define *def)
 {
     int retval = 0;
     hlmojo_IncludeState *state = ctx->include_stack;
@@ -1393,6 +2034,9 @@ static int handle_macro_args(Context *ctx, const char *sym, const hlmojo_Define
     hlmojo_IncludeState saved;  // can't pushback, we need the original token.
 	int void_call = 0;
 	int paren = 1;
+    MacroArg *args = (MacroArg *) alloca(sizeof (MacroArg) * (expected + 1));
+    hlmojo_Expansion *text = ctx->arg_text;
+    hlmojo_Expansion *orig = ctx->arg_original;
     memcpy(&saved, state, sizeof (hlmojo_IncludeState));
     if (lexer(state) != ((Token) '('))
     {
@@ -1400,12 +2044,37 @@ static int handle_macro_args(Context *ctx, const char *sym, const hlmojo_Define
         goto handle_macro_args_failed;  // gcc abandons replacement, too.
     } // if
 
+    // all arguments go one after another into the same two buffers, which
+    //  are kept from one macro to the next.
+    if (text == NULL)
+        text = ctx->arg_text = get_expansion(ctx);
+    if (orig == NULL)
+        orig = ctx->arg_original = get_expansion(ctx);
+    if ((text == NULL) || (orig == NULL))
+        goto handle_macro_args_failed;
+    text->textlen = text->tokencount = 0;
+    orig->textlen = 0;
+    text->tokens = (hlmojo_CachedToken *)  // never NULL, see below.
+        grow_array(ctx, text->tokens, &text->tokencap, 1,
+                   sizeof (hlmojo_CachedToken));
+    if (text->tokens == NULL)
+        goto handle_macro_args_failed;
+
     state->report_whitespace = 1;
 
     while (paren > 0)
     {
-        hlmojo_Buffer *buffer = hlmojo_buffer_create(128, MallocBridge, FreeBridge, ctx);
-        hlmojo_Buffer *origbuffer = hlmojo_buffer_create(128, MallocBridge, FreeBridge, ctx);
+        MacroArg arg;
+        arg.text = text->textlen;
+        arg.original = orig->textlen;
+        arg.token = text->tokencount;
+        text->tokenized = 1;
+
+        // the tokens of the argument are those of its pieces, as long as
+        //  pieces that weren't next to each other in the source can't run
+        //  together into other tokens (see joins_safely()).
+        int prev = 0;  // 0: start or space, 1: source token, 2: macro
+        const char *prev_end = NULL;
 
         Token t = lexer(state);
 
@@ -1417,6 +2086,8 @@ static int handle_macro_args(Context *ctx, const char *sym, const hlmojo_Define
             unsigned int origexprlen = state->tokenlen;
             const char *expr = state->token;
             unsigned int exprlen = state->tokenlen;
+            const hlmojo_CachedToken *tokens = NULL;
+            unsigned int tokencount = 0;
 
             if (t == ((Token) '('))
                 paren++;
@@ -1439,8 +2110,8 @@ static int handle_macro_args(Context *ctx, const char *sym, const hlmojo_Define
                 // don't add whitespace to the start, so we recognize
                 //  void calls correctly.
                 origexpr = expr = " ";
-                origexprlen = (hlmojo_buffer_size(origbuffer) == 0) ? 0 : 1;
-                exprlen = (hlmojo_buffer_size(buffer) == 0) ? 0 : 1;
+                origexprlen = (orig->textlen == arg.original) ? 0 : 1;
+                exprlen = (text->textlen == arg.text) ? 0 : 1;
             } // else if
 
             else if (t == TOKEN_IDENTIFIER)
@@ -1449,8 +2120,12 @@ static int handle_macro_args(Context *ctx, const char *sym, const hlmojo_Define
                 // don't replace macros with arguments so they replace correctly, later.
                 if ((def) && (def->paramcount == 0))
                 {
+                    tokens = define_tokens(ctx, def);
+                    tokencount = def->tokencount;
                     expr = def->definition;
                     exprlen = strlen(def->definition);
+                    if (tokens == NULL)
+                        text->tokenized = 0;
                 } // if
             } // else if
 
@@ -1463,62 +2138,85 @@ static int handle_macro_args(Context *ctx, const char *sym, const hlmojo_Define
 
             assert(expr != NULL);
 
-            if (!hlmojo_buffer_append(buffer, expr, exprlen))
+            if (t == ((Token) ' '))
+                prev = 0;
+            else if (t == ((Token) '\n'))
+                text->tokenized = 0;  // lines would have to be counted.
+            else if (tokens != NULL)
+            {
+                if (exprlen > 0)  // an empty one joins what's around it.
+                {
+                    if ((prev != 0) && (!joins_safely(text->text[text->textlen-1], *expr)))
+                        text->tokenized = 0;
+                    else if (!expansion_tokens(ctx, text, tokens, tokencount,
+                                               text->textlen - arg.text))
+                        goto handle_macro_args_failed;
+                    prev = 2;
+                } // if
+            } // else if
+            else
+            {
+                if ( (prev != 0) && ((prev == 2) || (state->token != prev_end)) &&
+                     (!joins_safely(text->text[text->textlen-1], *expr)) )
+                    text->tokenized = 0;
+                else if ( (memchr(state->token, '\n', state->tokenlen) != NULL) ||
+                          (memchr(state->token, '\r', state->tokenlen) != NULL) )
+                    text->tokenized = 0;
+                else if (!expansion_token(ctx, text, t, text->textlen - arg.text,
+                                          exprlen))
+                    goto handle_macro_args_failed;
+                prev = 1;
+                prev_end = state->token + state->tokenlen;
+            } // else
+
+            if (!expansion_append(ctx, text, expr, exprlen))
                 goto handle_macro_args_failed;
 
-            if (!hlmojo_buffer_append(origbuffer, origexpr, origexprlen))
+            if (!expansion_append(ctx, orig, origexpr, origexprlen))
                 goto handle_macro_args_failed;
 
             t = lexer(state);
         } // while
 
-        if (hlmojo_buffer_size(buffer) == 0)
+        if (text->textlen == arg.text)
             void_call = ((saw_params == 0) && (paren == 0));
 
         if (saw_params < expected)
         {
-            const int origdeflen = (int) hlmojo_buffer_size(origbuffer);
-            char *origdefinition = hlmojo_buffer_flatten(origbuffer);
-            const int deflen = (int) hlmojo_buffer_size(buffer);
-            char *definition = hlmojo_buffer_flatten(buffer);
             hlmojo_Define *p = get_define(ctx);
-            if ((!origdefinition) || (!definition) || (!p))
-            {
-                Free(ctx, origdefinition);
-                Free(ctx, definition);
-                hlmojo_buffer_destroy(origbuffer);
-                hlmojo_buffer_destroy(buffer);
-                free_define(ctx, p);
+            if (p == NULL)
                 goto handle_macro_args_failed;
-            } // if
 
             // trim any whitespace from the end of the string...
-            int i;
-            for (i = deflen - 1; i >= 0; i--)
+            while ((text->textlen > arg.text) && (text->text[text->textlen-1] == ' '))
+                text->textlen--;
+            while ((orig->textlen > arg.original) && (orig->text[orig->textlen-1] == ' '))
+                orig->textlen--;
+
+            // ...and end them, so they are strings of their own.
+            if ( (!expansion_append(ctx, text, "", 1)) ||
+                 (!expansion_append(ctx, orig, "", 1)) )
             {
-                if (definition[i] == ' ')
-                    definition[i] = '\0';
-                else
-                    break;
-            } // for
+                put_define(ctx, p);
+                goto handle_macro_args_failed;
+            } // if
 
-            for (i = origdeflen - 1; i >= 0; i--)
-            {
-                if (origdefinition[i] == ' ')
-                    origdefinition[i] = '\0';
-                else
-                    break;
-            } // for
+            arg.tokencount = text->tokencount - arg.token;
+            arg.tokenized = text->tokenized;
+            args[saw_params] = arg;
 
             p->identifier = def->parameters[saw_params];
-            p->definition = definition;
-            p->original = origdefinition;
             p->next = params;
             params = p;
         } // if
+        else
+        {
+            // not kept, so don't keep its text either.
+            text->textlen = arg.text;
+            text->tokencount = arg.token;
+            orig->textlen = arg.original;
+        } // else
 
-        hlmojo_buffer_destroy(buffer);
-        hlmojo_buffer_destroy(origbuffer);
         saw_params++;
     } // while
 
@@ -1534,10 +2232,23 @@ static int handle_macro_args(Context *ctx, const char *sym, const hlmojo_Define
     if (saw_params != expected)
     {
         failf(ctx, "macro '%s' passed %d arguments, but requires %d",
-              sym, saw_params, expected);
+              def->identifier, saw_params, expected);
         goto handle_macro_args_failed;
     } // if
 
+    // the buffers are done growing, point the arguments into them.
+    {
+        hlmojo_Define *p = params;
+        int i;
+        for (i = expected - 1; p != NULL; i--, p = p->next)
+        {
+            p->definition = text->text + args[i].text;
+            p->original = orig->text + args[i].original;
+            p->tokens = args[i].tokenized ? text->tokens + args[i].token : NULL;
+            p->tokencount = args[i].tokencount;
+        } // for
+    }
+
     // this handles arg replacement and the '##' and '#' operators.
     retval = replace_and_push_macro(ctx, def, params);
 
@@ -1545,8 +2256,7 @@ handle_macro_args_failed:
     while (params)
     {
         hlmojo_Define *next = params->next;
-        params->identifier = NULL;
-        free_define(ctx, params);
+        put_define(ctx, params);  // its strings are in ctx->arg_text.
         params = next;
     } // while
 
@@ -1566,19 +2276,15 @@ static int handle_pp_identifier(Context *ctx)
     hlmojo_IncludeState *state = ctx->include_stack;
     const char *fname = state->filename;
     const unsigned int line = state->line;
-    char *sym = (char *) alloca(state->tokenlen+1);
-    memcpy(sym, state->token, state->tokenlen);
-    sym[state->tokenlen] = '\0';
 
     // Is this identifier #defined?
-    const hlmojo_Define *def = find_define(ctx, sym);
+    const hlmojo_Define *def = find_define_by_token(ctx);
     if (def == NULL)
         return 0;   // just send the token through unchanged.
     else if (def->paramcount != 0)
-        return handle_macro_args(ctx, sym, def);
+        return handle_macro_args(ctx, def);
 
-    const size_t deflen = strlen(def->definition);
-    return push_source(ctx, fname, def->definition, deflen, line, NULL);
+    return push_define(ctx, def, fname, line);
 } // handle_pp_identifier
 
 
@@ -2026,6 +2732,254 @@ static void unterminated_pp_condition(Context *ctx)
 } // unterminated_pp_condition
 
 
+// Skipping inactive conditional blocks.
+//
+// Everything between a false #if and its #else/#elif/#endif is thrown away, so
+//  instead of lexing it token by token, skip_inactive_lines() goes over the raw
+//  bytes, a line at a time, up to the next line that starts with a directive
+//  that matters there: a conditional (which keeps track of the nesting, as it
+//  always did) or #line. Other directives are skipped like any other line. The
+//  scan has to agree with mojoshader_lexer.re on where lines start: comments
+//  and literals can hide newlines and '#', backslash-newline joins lines, and
+//  a run of bad characters swallows quotes.
+
+typedef enum
+{
+    SKIPCHAR_PLAIN,       // part of a token that can't hide anything
+    SKIPCHAR_SPACE,
+    SKIPCHAR_NEWLINE,
+    SKIPCHAR_SLASH,       // maybe a comment
+    SKIPCHAR_HASH,        // maybe a directive
+    SKIPCHAR_QUOTE,       // maybe a string or character literal; '"' isn't legal
+    SKIPCHAR_BACKSLASH,   // maybe a line continuation
+    SKIPCHAR_BAD          // not in ANYLEGAL: starts a run of bad characters
+} SkipCharClass;
+
+#define P SKIPCHAR_PLAIN
+#define S SKIPCHAR_SPACE
+#define N SKIPCHAR_NEWLINE
+#define X SKIPCHAR_BAD
+static const unsigned char skip_char_class[256] =
+{
+    X, X, X, X, X, X, X, X, X, S, N, S, S, N, X, X,  // \0 - \x0F
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    S, P, SKIPCHAR_QUOTE, SKIPCHAR_HASH, X, P, P, SKIPCHAR_QUOTE,  // ' ' - '\''
+    P, P, P, P, P, P, P, SKIPCHAR_SLASH,                           // '(' - '/'
+    P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P,  // '0' - '?'
+    X, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P,  // '@' - 'O'
+    P, P, P, P, P, P, P, P, P, P, P, P, SKIPCHAR_BACKSLASH, P, P, P,  // 'P' - '_'
+    X, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P,  // '`' - 'o'
+    P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, X,  // 'p' - \x7F
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,  // \x80 - \xFF
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+};
+#undef P
+#undef S
+#undef N
+#undef X
+
+
+// Past a newline ("\r\n" is one) at p.
+static inline const unsigned char *skip_newline(const unsigned char *p,
+                                                const unsigned char *end)
+{
+    return ((*p == '\r') && (p + 1 < end) && (p[1] == '\n')) ? p + 2 : p + 1;
+} // skip_newline
+
+
+// Past the string or character literal starting at p, or NULL if the lexer
+//  wouldn't take it as one (it doesn't end on this line, or has a bad escape).
+static const unsigned char *skip_literal(const unsigned char *p,
+                                         const unsigned char *end)
+{
+    const unsigned char quote = *(p++);
+    while (p < end)
+    {
+        const unsigned char c = *p;
+        if (c == quote)
+            return p + 1;
+        else if ((c == '\n') || (c == '\r'))
+            return NULL;
+        else if (c != '\\')
+            p++;
+        else if (p + 1 == end)
+            return NULL;
+        else
+        {
+            const unsigned char e = p[1];
+            if ( (e == 'a') || (e == 'b') || (e == 'f') || (e == 'n') ||
+                 (e == 'r') || (e == 't') || (e == 'v') || (e == '?') ||
+                 (e == '\'') || (e == '"') || (e == '\\') ||
+                 ((e >= '0') && (e <= '7')) )
+                p += 2;
+            else if ( (e == 'x') && (p + 2 < end) &&
+                      ( ((p[2] >= '0') && (p[2] <= '9')) ||
+                        ((p[2] >= 'a') && (p[2] <= 'f')) ||
+                        ((p[2] >= 'A') && (p[2] <= 'F')) ) )
+                p += 3;
+            else
+                return NULL;
+        } // else
+    } // while
+    return NULL;
+} // skip_literal
+
+
+// Whether the lexer makes a conditional or #line directive of this name.
+static int is_skip_stop_directive(const unsigned char *p,
+                                  const unsigned char *end)
+{
+    const size_t avail = (size_t) (end - p);
+    #define DIRECTIVE_IS(name) \
+        ((avail >= sizeof (name) - 1) && (memcmp(p, name, sizeof (name) - 1) == 0))
+    // "if" covers #ifdef and #ifndef, "el" #else and #elif.
+    const int retval = ( DIRECTIVE_IS("if") || DIRECTIVE_IS("el") ||
+                         DIRECTIVE_IS("endif") || DIRECTIVE_IS("line") );
+    #undef DIRECTIVE_IS
+    return retval;
+} // is_skip_stop_directive
+
+
+// Moves the lexer ahead to the start of the next line that could change what
+//  is skipped, as if it had lexed every token up to there. It only ever stops
+//  right after a newline token, so any line it can't skip whole (one that ends
+//  in an unterminated comment, or in the end of the file) is left to the lexer.
+//
+// Like the lexer, this keeps track of whether the last token was a newline
+//  (linestart), and whether a '#' would start a directive (directive): only
+//  after a newline and whitespace, or after a comment that follows a newline,
+//  even if a line continuation came in between.
+static void skip_inactive_lines(hlmojo_IncludeState *state)
+{
+    const unsigned char *p = (const unsigned char *) state->source;
+    const unsigned char *end = p + state->bytes_left;
+    const unsigned char *resume = NULL;
+    unsigned int line = state->line;
+    unsigned int resume_line = line;
+    int linestart = (state->tokenval == ((Token) '\n'));
+    int directive = linestart;
+
+    while (p < end)
+    {
+        const unsigned char *literal;
+        const unsigned char *q;
+        switch (skip_char_class[*p])
+        {
+            case SKIPCHAR_PLAIN:
+                // spaces don't matter anymore on this line.
+                linestart = directive = 0;
+                for (p++; (p < end) && (skip_char_class[*p] <= SKIPCHAR_SPACE); p++)
+                    ;
+                break;
+
+            case SKIPCHAR_SPACE:
+                p++;
+                break;
+
+            case SKIPCHAR_NEWLINE:
+                p = skip_newline(p, end);
+                line++;
+                resume = p;
+                resume_line = line;
+                linestart = directive = 1;
+                break;
+
+            case SKIPCHAR_SLASH:
+                if ((p + 1 < end) && (p[1] == '/'))
+                {
+                    // up to the newline, which ends the line as usual.
+                    p += 2;
+                    while ((p < end) && (*p != '\n') && (*p != '\r'))
+                        p++;
+                } // if
+                else if ((p + 1 < end) && (p[1] == '*'))
+                {
+                    for (p += 2; p < end; )
+                    {
+                        if ((*p == '*') && (p + 1 < end) && (p[1] == '/'))
+                            break;
+                        else if ((*p == '\n') || (*p == '\r'))
+                        {
+                            p = skip_newline(p, end);
+                            line++;
+                        } // else if
+                        else
+                            p++;
+                    } // for
+                    if (p == end)
+                        goto done;  // an incomplete comment, for the lexer.
+                    p += 2;
+                    directive = linestart;
+                } // else if
+                else
+                {
+                    linestart = directive = 0;
+                    p++;
+                } // else
+                break;
+
+            case SKIPCHAR_HASH:
+                if (directive)
+                {
+                    q = p + 1;
+                    while ((q < end) && ((*q == ' ') || (*q == '\t')))
+                        q++;
+                    if (is_skip_stop_directive(q, end))
+                        goto done;
+                } // if
+                linestart = directive = 0;
+                p++;
+                break;
+
+            case SKIPCHAR_QUOTE:
+                literal = skip_literal(p, end);
+                if (literal == NULL)
+                    goto bad_chars;
+                linestart = directive = 0;
+                p = literal;
+                break;
+
+            case SKIPCHAR_BACKSLASH:
+                q = p + 1;
+                while ((q < end) && ((*q == ' ') || (*q == '\t') || (*q == '\v') || (*q == '\f')))
+                    q++;
+                if ((q >= end) || ((*q != '\n') && (*q != '\r')))
+                    goto bad_chars;
+                // joins the lines, without a newline token.
+                p = skip_newline(q, end);
+                line++;
+                directive = 0;
+                break;
+
+            case SKIPCHAR_BAD:
+            bad_chars:
+                // swallows everything up to a legal character, quotes too.
+                linestart = directive = 0;
+                for (p++; (p < end) && ((*p == '"') || (skip_char_class[*p] == SKIPCHAR_BAD)); p++)
+                    ;
+                break;
+        } // switch
+    } // while
+
+done:
+    if (resume != NULL)
+    {
+        state->bytes_left -= (unsigned int) (resume - (const unsigned char *) state->source);
+        state->source = (const char *) resume;
+        state->token = (const char *) resume;
+        state->tokenlen = 0;
+        state->tokenval = (Token) '\n';
+        state->line = resume_line;
+    } // if
+} // skip_inactive_lines
+
+
 static inline const char *_hlmojo_preprocessor_nexttoken(hlmojo_Preprocessor *_ctx,
                                              unsigned int *_len, Token *_token)
 {
@@ -2052,8 +3006,14 @@ static inline const char *_hlmojo_preprocessor_nexttoken(hlmojo_Preprocessor *_c
         const hlmojo_Conditional *cond = state->conditional_stack;
         const int skipping = ((cond != NULL) && (cond->skipping));
 
+        if ((skipping) && (!state->pushedback) && (!state->report_whitespace))
+            skip_inactive_lines(state);
+
         const Token token = lexer(state);
 
+        if ((state->guard != INCLUDEGUARD_NONE) && (token != ((Token) '\n')))
+            track_include_guard(state, token);
+
         if (token != TOKEN_IDENTIFIER)
             ctx->recursion_count = 0;
 
@@ -2062,10 +3022,14 @@ static inline const char *_hlmojo_preprocessor_nexttoken(hlmojo_Preprocessor *_c
             assert(state->bytes_left == 0);
             if (state->conditional_stack != NULL)
             {
+                state->guard = INCLUDEGUARD_NONE;
                 unterminated_pp_condition(ctx);
                 continue;  // returns an error.
             } // if
 
+            if (state->guard == INCLUDEGUARD_CLOSED)
+                add_include_guard(ctx, state->guard_key, state->guard_macro, 0);
+
             pop_source(ctx);
             continue;  // pick up again after parent's #include line.
         } // if
@@ -2203,6 +3167,13 @@ const char *hlmojo_preprocessor_sourcepos(hlmojo_Preprocessor *_ctx, unsigned in
 } // hlmojo_preprocessor_sourcepos
 
 
+unsigned int hlmojo_preprocessor_skipped_includes(hlmojo_Preprocessor *_ctx)
+{
+    Context *ctx = (Context *) _ctx;
+    return ctx->skipped_includes;
+} // hlmojo_preprocessor_skipped_includes
+
+
 
 
 // end of mojoshader_preprocessor.c ...
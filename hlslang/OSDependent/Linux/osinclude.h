@@ -45,4 +45,20 @@ inline void * OS_GetTLSValue(OS_TLSIndex nIndex)
 	return pthread_getspecific(nIndex); 
 }
 
+//
+// Thread Operations
+//
+typedef void (*OS_ThreadFunc)(void* data);
+typedef pthread_t OS_Thread;
+typedef pthread_mutex_t OS_Mutex;
+
+bool OS_CreateThread(OS_Thread* thread, OS_ThreadFunc func, void* data);
+void OS_JoinThread(OS_Thread thread);
+int  OS_GetProcessorCount();
+
+void OS_InitMutex(OS_Mutex* mutex);
+void OS_DestroyMutex(OS_Mutex* mutex);
+inline void OS_LockMutex(OS_Mutex* mutex) { pthread_mutex_lock(mutex); }
+inline void OS_UnlockMutex(OS_Mutex* mutex) { pthread_mutex_unlock(mutex); }
+
 #endif // __OSINCLUDE_H
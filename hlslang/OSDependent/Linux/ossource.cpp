@@ -6,6 +6,7 @@
 // This file contains the Linux specific functions
 //
 #include "osinclude.h"
+#include <unistd.h>
 
 #if !(defined(linux))
 #error Trying to build a Linux specific file in a non-Linux build.
@@ -59,3 +60,59 @@ bool OS_FreeTLSIndex(OS_TLSIndex nIndex)
 	else
 		return false;
 }
+
+
+//
+// Thread Operations
+//
+struct OS_ThreadStart
+{
+	OS_ThreadFunc func;
+	void* data;
+};
+
+static void* OS_ThreadEntry(void* d)
+{
+	OS_ThreadStart start = *reinterpret_cast<OS_ThreadStart*>(d);
+	delete reinterpret_cast<OS_ThreadStart*>(d);
+	start.func(start.data);
+	return NULL;
+}
+
+
+bool OS_CreateThread(OS_Thread* thread, OS_ThreadFunc func, void* data)
+{
+	OS_ThreadStart* start = new OS_ThreadStart;
+	start->func = func;
+	start->data = data;
+	if (pthread_create(thread, NULL, OS_ThreadEntry, start) != 0) {
+		delete start;
+		return false;
+	}
+	return true;
+}
+
+
+void OS_JoinThread(OS_Thread thread)
+{
+	pthread_join(thread, NULL);
+}
+
+
+int OS_GetProcessorCount()
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+}
+
+
+void OS_InitMutex(OS_Mutex* mutex)
+{
+	pthread_mutex_init(mutex, NULL);
+}
+
+
+void OS_DestroyMutex(OS_Mutex* mutex)
+{
+	pthread_mutex_destroy(mutex);
+}
@@ -37,4 +37,20 @@ inline void* OS_GetTLSValue(OS_TLSIndex nIndex)
 	return TlsGetValue(nIndex);
 }
 
+//
+// Thread Operations
+//
+typedef void (*OS_ThreadFunc)(void* data);
+typedef HANDLE OS_Thread;
+typedef CRITICAL_SECTION OS_Mutex;
+
+bool OS_CreateThread(OS_Thread* thread, OS_ThreadFunc func, void* data);
+void OS_JoinThread(OS_Thread thread);
+int  OS_GetProcessorCount();
+
+inline void OS_InitMutex(OS_Mutex* mutex) { InitializeCriticalSection(mutex); }
+inline void OS_DestroyMutex(OS_Mutex* mutex) { DeleteCriticalSection(mutex); }
+inline void OS_LockMutex(OS_Mutex* mutex) { EnterCriticalSection(mutex); }
+inline void OS_UnlockMutex(OS_Mutex* mutex) { LeaveCriticalSection(mutex); }
+
 #endif // __OSINCLUDE_H
@@ -54,3 +54,50 @@ bool OS_FreeTLSIndex(OS_TLSIndex nIndex)
 	else
 		return false;
 }
+
+
+//
+// Thread Operations
+//
+struct OS_ThreadStart
+{
+	OS_ThreadFunc func;
+	void* data;
+};
+
+static DWORD WINAPI OS_ThreadEntry(LPVOID d)
+{
+	OS_ThreadStart start = *reinterpret_cast<OS_ThreadStart*>(d);
+	delete reinterpret_cast<OS_ThreadStart*>(d);
+	start.func(start.data);
+	return 0;
+}
+
+
+bool OS_CreateThread(OS_Thread* thread, OS_ThreadFunc func, void* data)
+{
+	OS_ThreadStart* start = new OS_ThreadStart;
+	start->func = func;
+	start->data = data;
+	*thread = CreateThread(NULL, 0, OS_ThreadEntry, start, 0, NULL);
+	if (*thread == NULL) {
+		delete start;
+		return false;
+	}
+	return true;
+}
+
+
+void OS_JoinThread(OS_Thread thread)
+{
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+
+
+int OS_GetProcessorCount()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
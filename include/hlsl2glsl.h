@@ -15,6 +15,7 @@
 #endif
 
 #include <string>
+#include <vector>
 
 extern "C" {
 
@@ -235,7 +236,10 @@ SH_IMPORT_EXPORT ShHandle C_DECL Hlsl2Glsl_ConstructCompiler( const EShLanguage
 SH_IMPORT_EXPORT void C_DECL Hlsl2Glsl_DestructCompiler( ShHandle handle );
 
 
-/// File read callback for #include processing.
+/// File read callback for #include processing. A file that was included before isn't opened again
+/// when it has #pragma once, or is wrapped in an include guard (#ifndef X / #define X ... #endif, with
+/// nothing but comments outside) whose macro is still defined. Files are told apart by the name they
+/// are included by, and for #include "..." the directory of the including file.
 typedef bool (C_DECL *Hlsl2Glsl_IncludeOpenFunc)(bool isSystem, const char* fname, const char* parentfname, const char* parent, std::string& output, void* data);
 typedef void (C_DECL *Hlsl2Glsl_IncludeCloseFunc)(const char* file, void* data);
 struct Hlsl2Glsl_ParseCallbacks
@@ -245,7 +249,20 @@ struct Hlsl2Glsl_ParseCallbacks
 	void* data;
 };
 
-/// Parse HLSL shader to prepare it for final translation.
+/// Zero-copy flavor of the file read callback, for Hlsl2Glsl_ParseBuffer: points *text at the file
+/// (*length bytes, no terminating zero needed) instead of copying it. The text must stay alive and
+/// unchanged until the close callback is called with the same pointer. Text that doesn't end with a
+/// newline is copied after all.
+typedef bool (C_DECL *Hlsl2Glsl_IncludeOpenRefFunc)(bool isSystem, const char* fname, const char* parentfname, const char* parent, const char** text, size_t* length, void* data);
+struct Hlsl2Glsl_ParseCallbacksRef
+{
+	Hlsl2Glsl_IncludeOpenRefFunc includeOpenCallback;
+	Hlsl2Glsl_IncludeCloseFunc includeCloseCallback;
+	void* data;
+};
+
+/// Parse HLSL shader to prepare it for final translation. This replaces any shader parsed before
+/// by this compiler; the shader is kept until the next one (or the compiler is destructed).
 /// \param callbacks
 ///		File read callback for #include processing. If NULL is passed, then #include directives will result in error.
 /// \param options
@@ -257,9 +274,25 @@ SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_Parse(
 	Hlsl2Glsl_ParseCallbacks* callbacks,
 	unsigned options);
 
+/// Like Hlsl2Glsl_Parse, without copying the shader or include files: the shader is length bytes
+/// that don't need a terminating zero (e.g. in a memory mapped file), and is only copied when it
+/// doesn't end with a newline. Include files are read by the zero-copy callback.
+/// \param callbacks
+///		Zero-copy file read callback for #include processing. If NULL is passed, then #include directives will result in error.
+SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_ParseBuffer(
+	const ShHandle handle,
+	const char* shaderString,
+	size_t length,
+	ETargetVersion targetVersion,
+	Hlsl2Glsl_ParseCallbacksRef* callbacks,
+	unsigned options);
 
 
-/// After parsing a HLSL shader, do the final translation to GLSL.
+
+/// After parsing a HLSL shader, do the final translation to GLSL. Can be called any number of times
+/// with different entry points, target versions and options, without parsing the shader again;
+/// each translation replaces the shader text and uniform info of the previous one. The shader is
+/// only parsed again when going between targets before GLSL 1.20 (ES 1.00, 1.10) and after it.
 SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_Translate(
 	const ShHandle handle,
 	const char* entry,
@@ -267,6 +300,210 @@ SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_Translate(
 	unsigned options);
 
 
+/// One shader for Hlsl2Glsl_TranslateBatch. The first fields are filled in by the caller,
+/// the rest is written by the translator.
+struct Hlsl2Glsl_BatchJob
+{
+	const char* source;
+	const char* entry;
+	EShLanguage language;
+	ETargetVersion targetVersion;
+	unsigned options;
+	Hlsl2Glsl_ParseCallbacks* callbacks; ///< can be NULL; called from worker threads
+
+	int result;          ///< 1 if the shader was parsed and translated, 0 otherwise
+	std::string shader;  ///< translated GLSL source
+	std::string infoLog; ///< errors and warnings
+};
+
+/// Parse and translate many shaders at once, on a pool of worker threads. The calling thread
+/// is one of the workers. Each worker reuses its memory pool and compilers for all the jobs it runs;
+/// when a worker runs out of jobs it steals some from another.
+/// \param threadCount
+///		Number of worker threads; 0 means one per processor.
+/// \return
+///		Number of jobs that succeeded.
+SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_TranslateBatch(
+	Hlsl2Glsl_BatchJob* jobs,
+	int jobCount,
+	int threadCount);
+
+
+/// A macro for Hlsl2Glsl_TranslateVariants and Hlsl2Glsl_Preprocess, as if by "#define name value".
+struct Hlsl2Glsl_Define
+{
+	const char* name;
+	const char* value; ///< NULL means "1"
+};
+
+/// One variant for Hlsl2Glsl_TranslateVariants: the macros it is compiled with, filled in by the
+/// caller, and its results, written by the translator.
+struct Hlsl2Glsl_Variant
+{
+	const Hlsl2Glsl_Define* defines;
+	int defineCount;
+
+	int result;          ///< 1 if the variant was parsed and translated, 0 otherwise
+	int sharedWith;      ///< index of the first variant with the same preprocessed tokens; its own index if none before it
+	std::string shader;  ///< translated GLSL source
+	std::string infoLog; ///< errors and warnings
+};
+
+/// Translate one shader with many sets of macros, like keyword variants. Include files are only read
+/// once, for all the variants. Each variant is preprocessed with its macros, and variants that end up
+/// with the same tokens share one parse and translation, so only the distinct ones are paid for.
+/// The shader and include files are lexed once, too; include files in the include cache, if enabled.
+/// Leaves the compiler with the last distinct variant, as if it was parsed and translated by itself.
+/// \param callbacks
+///		File read callback for #include processing; each file is opened (and closed) once.
+/// \return
+///		Number of variants that succeeded.
+SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_TranslateVariants(
+	const ShHandle handle,
+	const char* shaderString,
+	const char* entry,
+	ETargetVersion targetVersion,
+	Hlsl2Glsl_ParseCallbacks* callbacks,
+	unsigned options,
+	Hlsl2Glsl_Variant* variants,
+	int variantCount);
+
+
+/// A file read by the include callbacks, see Hlsl2Glsl_Preprocess.
+struct Hlsl2Glsl_IncludedFile
+{
+	std::string name;           ///< as included
+	std::string parentName;     ///< of the file it was included from; empty for the shader itself
+	bool isSystem;              ///< included with <>
+	unsigned long long hash[2]; ///< 128 bit hash of what the open callback returned
+};
+
+/// What Hlsl2Glsl_Preprocess returns.
+struct Hlsl2Glsl_PreprocessResult
+{
+	Hlsl2Glsl_PreprocessResult() : skippedIncludes(0) { }
+
+	std::string text;     ///< preprocessed source
+	std::vector<Hlsl2Glsl_IncludedFile> includes; ///< in the order they were opened
+	std::string infoLog;  ///< errors
+	unsigned skippedIncludes; ///< #includes of guarded files included before, that weren't opened again
+};
+
+/// Only preprocess a shader: expand its macros and include files, without parsing or translating
+/// it, e.g. to look it up in a cache or to find out what it depends on. Needs no compiler and
+/// can be called from any thread.
+///
+/// The text has the tokens of each line of the shader and its include files on a line of their
+/// own, with #line directives where the file changes, so parsing it gives the same results and
+/// messages as parsing the shader. Every file is opened once, even if included more than once
+/// from the same file, and listed in the includes with a hash of its contents; guarded files are
+/// only opened the first time they are included, see Hlsl2Glsl_IncludeOpenFunc.
+/// \param length
+///		Bytes of the shader; it doesn't need a terminating zero.
+/// \param callbacks
+///		File read callback for #include processing, as in Hlsl2Glsl_Parse.
+/// \return
+///		1 on success, 0 on a preprocessing error (in the info log). The includes are filled in either way.
+SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_Preprocess(
+	const char* shaderString,
+	size_t length,
+	Hlsl2Glsl_ParseCallbacks* callbacks,
+	const Hlsl2Glsl_Define* defines,
+	int defineCount,
+	Hlsl2Glsl_PreprocessResult* result);
+
+
+/// Cache translation results, so that translating the same shader again skips parsing and
+/// translation altogether. Hlsl2Glsl_Parse then preprocesses the shader and looks it up by its
+/// tokens, so the cache works no matter where the includes come from; Hlsl2Glsl_Translate looks up
+/// the result for the entry point, target version, options and user attribute names. The cached
+/// GLSL, info log and uniform info are returned just like freshly translated ones.
+///
+/// Call this when no shaders are being translated; Hlsl2Glsl_TranslateBatch uses the cache, too.
+///
+/// \param memoryLimit
+///		Bytes of results kept in memory; the least recently used ones are dropped when over it.
+/// \param directory
+///		If not NULL, every result is also stored in a file in this (existing) directory, and results
+///		not in memory are looked up there. Can be shared by many processes and runs; a hash of the
+///		library sources is put in the keys, so results of other library builds are never used.
+///		Only builds made with the CMake project have that hash; other builds don't support a
+///		directory, and fail.
+/// \return
+///		1 on success, 0 on failure (then the cache is left as it was)
+SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_EnableCache( size_t memoryLimit, const char* directory );
+
+/// Stop caching, and free the results kept in memory. Hlsl2Glsl_Shutdown does this, too.
+SH_IMPORT_EXPORT void C_DECL Hlsl2Glsl_DisableCache();
+
+
+/// Counters of the include cache, see Hlsl2Glsl_EnableIncludeCache.
+struct Hlsl2Glsl_IncludeCacheStats
+{
+	unsigned hits;   ///< include files whose tokens were in the cache
+	unsigned misses; ///< include files that were lexed and added to it
+	unsigned files;  ///< include files in the cache; a file counts again for each of its contents
+	size_t bytes;    ///< memory taken by their tokens
+};
+
+/// Keep the tokens of include files, so that including a file again, in any shader or variant,
+/// doesn't lex it again. Files are looked up by the name they are included by and a hash of what
+/// the include callback returned, so a changed file is lexed again; the tokens of what it was
+/// before are kept until Hlsl2Glsl_InvalidateIncludeCache.
+///
+/// Call this when no shaders are being translated.
+/// \return
+///		1 on success, 0 on failure
+SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_EnableIncludeCache();
+
+/// Stop caching include files, and free their tokens. Hlsl2Glsl_Shutdown does this, too.
+SH_IMPORT_EXPORT void C_DECL Hlsl2Glsl_DisableIncludeCache();
+
+/// Drop the tokens of an include file, by the name it is included by; of all files for NULL.
+/// Can be called at any time.
+SH_IMPORT_EXPORT void C_DECL Hlsl2Glsl_InvalidateIncludeCache( const char* fname );
+
+/// Get the counters of the include cache; all zero when it is disabled.
+SH_IMPORT_EXPORT void C_DECL Hlsl2Glsl_GetIncludeCacheStats( Hlsl2Glsl_IncludeCacheStats* stats );
+
+
+/// How a compiler's memory pool (which holds its AST) gets memory, see Hlsl2Glsl_SetMemoryOptions.
+struct Hlsl2Glsl_MemoryOptions
+{
+	size_t pageSize;    ///< bytes of the first page, at least 4096 (default 8192); larger allocations get a block of their own
+	size_t maxPageSize; ///< each page taken from the OS is twice as big as the one before, up to this (default pageSize)
+	size_t keepBytes;   ///< pages and blocks freed by the next shader are kept for reuse up to this many bytes (default no limit)
+	int reuseFreed;     ///< if not 0, small buffers that strings and arrays grow out of are reused by allocations of their size (default 0)
+};
+
+/// Counters of a compiler's memory pool since the last parse, translations included.
+struct Hlsl2Glsl_MemoryStats
+{
+	size_t bytesRequested;      ///< bytes asked for by all allocations
+	size_t bytesReused;         ///< of those, bytes given out from reused buffers
+	size_t bytesReserved;       ///< bytes of pages holding allocations now
+	size_t peakBytes;           ///< the most bytesReserved there was
+	size_t freeBytes;           ///< bytes of pages kept for reuse
+	unsigned allocations;
+	unsigned reusedAllocations; ///< allocations given out from reused buffers
+	unsigned largeAllocations;  ///< allocations that got a block of their own
+	unsigned pages;             ///< pages and blocks holding allocations now
+	unsigned osAllocations;     ///< pages and blocks that had to be taken from the OS
+};
+
+/// Set how a compiler's memory pool gets memory, e.g. to size the memory of worker threads.
+/// Takes effect for pages taken after this; frees the pages kept for reuse.
+/// \return
+///		1 on success, 0 on failure
+SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_SetMemoryOptions( ShHandle handle, const Hlsl2Glsl_MemoryOptions* options );
+
+/// Get the memory pool settings of a compiler (the defaults, if they were never set).
+SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_GetMemoryOptions( const ShHandle handle, Hlsl2Glsl_MemoryOptions* options );
+
+/// Get the counters of a compiler's memory pool; they start over with each parse.
+SH_IMPORT_EXPORT int C_DECL Hlsl2Glsl_GetMemoryStats( const ShHandle handle, Hlsl2Glsl_MemoryStats* stats );
+
+
 /// After translating HLSL shader(s), retrieve the translated GLSL source.
 SH_IMPORT_EXPORT const char* C_DECL Hlsl2Glsl_GetShader( const ShHandle handle );
 
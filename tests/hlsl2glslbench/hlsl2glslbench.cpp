@@ -0,0 +1,639 @@
+// Microbenchmarks for the translator.
+//
+// Usage: hlsl2glslbench [benchmark...]
+// Runs all benchmarks if none are named.
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <time.h>
+
+#include "../../include/hlsl2glsl.h"
+
+
+static double GetSeconds ()
+{
+	return double(clock()) / double(CLOCKS_PER_SEC);
+}
+
+static void Report (const char* name, int iterations, double seconds)
+{
+	printf ("%-24s %8i iterations %10.2f us/iteration\n", name, iterations, seconds * 1.0e6 / iterations);
+}
+
+
+// Fixed cost of a parse: a shader with nothing in it.
+static void BenchEmptyShader ()
+{
+	const int kIterations = 200000;
+	ShHandle parser = Hlsl2Glsl_ConstructCompiler (EShLangFragment);
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+		Hlsl2Glsl_Parse (parser, "", ETargetGLSL_110, NULL, 0);
+	double t1 = GetSeconds();
+	Hlsl2Glsl_DestructCompiler (parser);
+	Report ("empty-shader", kIterations, t1 - t0);
+}
+
+
+// Intrinsic calls whose arguments need conversions, so the overload can't be
+// found by mangled name and goes through overload resolution.
+static void BenchIntrinsicCalls ()
+{
+	const int kIterations = 100;
+	const int kCalls = 1000;
+	std::string source = "float4 main (float4 uv : TEXCOORD0) : COLOR0 {\n\tfloat4 r = 0;\n";
+	for (int i = 0; i < kCalls / 4; ++i)
+	{
+		source += "\tr += max (0, uv);\n";
+		source += "\tr += pow (uv, 2);\n";
+		source += "\tr += clamp (uv, 0, 1);\n";
+		source += "\tr.xy += lerp (uv.xy, uv.zw, 0);\n";
+	}
+	source += "\treturn r;\n}\n";
+
+	ShHandle parser = Hlsl2Glsl_ConstructCompiler (EShLangFragment);
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		if (!Hlsl2Glsl_Parse (parser, source.c_str(), ETargetGLSL_110, NULL, 0))
+		{
+			printf ("intrinsic-calls: %s\n", Hlsl2Glsl_GetInfoLog (parser));
+			break;
+		}
+	}
+	double t1 = GetSeconds();
+	Hlsl2Glsl_DestructCompiler (parser);
+	Report ("intrinsic-calls", kIterations * kCalls, t1 - t0);
+}
+
+
+// Lots of identifiers: locals in nested blocks that use the ones declared before
+// them, so each use is looked up through several scopes and the built-ins.
+static void BenchIdentifiers ()
+{
+	const int kIterations = 100;
+	const int kLocals = 1000;
+	char buf[128];
+	std::string source = "float4 main (float4 uv : TEXCOORD0) : COLOR0 {\n\tfloat4 value_0 = uv;\n";
+	for (int i = 1; i < kLocals; ++i)
+	{
+		if (i % 100 == 0)
+			source += "\t{\n";
+		sprintf (buf, "\tfloat4 value_%i = value_%i * uv + value_%i;\n", i, i - 1, i / 2);
+		source += buf;
+	}
+	sprintf (buf, "\tuv = value_%i;\n", kLocals - 1);
+	source += buf;
+	for (int i = 100; i < kLocals; i += 100)
+		source += "\t}\n";
+	source += "\treturn uv;\n}\n";
+
+	ShHandle parser = Hlsl2Glsl_ConstructCompiler (EShLangFragment);
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		if (!Hlsl2Glsl_Parse (parser, source.c_str(), ETargetGLSL_110, NULL, 0))
+		{
+			printf ("identifiers: %s\n", Hlsl2Glsl_GetInfoLog (parser));
+			break;
+		}
+	}
+	double t1 = GetSeconds();
+	Hlsl2Glsl_DestructCompiler (parser);
+	Report ("identifiers", kIterations * kLocals, t1 - t0);
+}
+
+
+// Allocation heavy: long expressions with constructors, swizzles and constants, so
+// most of the time goes to making nodes, types and their pool strings and vectors.
+static void BenchExpressions ()
+{
+	const int kIterations = 100;
+	const int kStatements = 1000;
+	std::string source = "float4 main (float4 uv : TEXCOORD0) : COLOR0 {\n\tfloat4 r = uv;\n";
+	for (int i = 0; i < kStatements; ++i)
+		source += "\tr = float4 (r.xy * 0.5 + uv.zw, r.z - uv.x * 2.0, 1.0) * float4 (uv.wzyx + r.yxwz) - r.xxyy * 0.25;\n";
+	source += "\treturn r;\n}\n";
+
+	ShHandle parser = Hlsl2Glsl_ConstructCompiler (EShLangFragment);
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		if (!Hlsl2Glsl_Parse (parser, source.c_str(), ETargetGLSL_110, NULL, 0))
+		{
+			printf ("expressions: %s\n", Hlsl2Glsl_GetInfoLog (parser));
+			break;
+		}
+	}
+	double t1 = GetSeconds();
+	Hlsl2Glsl_DestructCompiler (parser);
+	Report ("expressions", kIterations * kStatements, t1 - t0);
+}
+
+
+// Many untyped samplers, each typed by its use through a function parameter, and
+// as many uniforms that are written to.
+static void BenchSamplers (const char* name, int samplers)
+{
+	const int kIterations = 20;
+	std::string source;
+	char buf[200];
+	for (int i = 0; i < samplers; ++i)
+	{
+		sprintf (buf, "sampler s%i;\nfloat4 u%i;\n", i, i);
+		source += buf;
+	}
+	source += "float4 fetch (sampler s, float2 uv) { return tex2D (s, uv); }\n";
+	source += "float4 main (float2 uv : TEXCOORD0) : COLOR0 {\n\tfloat4 r = 0;\n";
+	for (int i = 0; i < samplers; ++i)
+	{
+		sprintf (buf, "\tu%i *= 2;\n\tr += fetch (s%i, uv) * u%i;\n", i, i, i);
+		source += buf;
+	}
+	source += "\treturn r;\n}\n";
+
+	ShHandle parser = Hlsl2Glsl_ConstructCompiler (EShLangFragment);
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		if (!Hlsl2Glsl_Parse (parser, source.c_str(), ETargetGLSL_110, NULL, 0))
+		{
+			printf ("%s: %s\n", name, Hlsl2Glsl_GetInfoLog (parser));
+			break;
+		}
+	}
+	double t1 = GetSeconds();
+	Hlsl2Glsl_DestructCompiler (parser);
+	Report (name, kIterations, t1 - t0);
+}
+
+static void BenchSamplers16 () { BenchSamplers ("samplers-16", 16); }
+static void BenchSamplers64 () { BenchSamplers ("samplers-64", 64); }
+static void BenchSamplers256 () { BenchSamplers ("samplers-256", 256); }
+
+
+// Lexing and parsing of a shader that is mostly included code, with file names in
+// the source locations of all its tokens; with the include cache, the headers are
+// lexed in the first iteration only.
+static bool C_DECL BenchIncludeOpen (bool isSystem, const char* fname, const char* parentfname, const char* parent, std::string& output, void* d)
+{
+	const int header = atoi (fname + 1);
+	char buf[400];
+	for (int i = 0; i < 40; ++i)
+	{
+		sprintf (buf,
+			"float4 f%i_%i (float4 a, float4 b, float2 uv) {\n"
+			"\tfloat4 r = a * b + float4 (1.0, 2.5, 3.0, 4.0) - dot (a.xyz, b.xyz);\n"
+			"\tr.xy += uv * 0.5f; r.zw -= a.wz * (b.x >= 0.0 ? 1.0 : -1.0);\n"
+			"\treturn r;\n}\n", header, i);
+		output += buf;
+	}
+	return true;
+}
+
+static std::string IncludesSource ()
+{
+	const int kHeaders = 16;
+	std::string source;
+	char buf[200];
+	for (int i = 0; i < kHeaders; ++i)
+	{
+		sprintf (buf, "#include \"h%i.hlsl\"\n", i);
+		source += buf;
+	}
+	source += "float4 main (float4 uv : TEXCOORD0) : COLOR0 {\n\treturn f0_0 (uv, uv, uv.xy);\n}\n";
+	return source;
+}
+
+static void BenchParseIncludes (const char* name, bool cached)
+{
+	const int kIterations = 20;
+	const std::string source = IncludesSource ();
+
+	Hlsl2Glsl_ParseCallbacks callbacks;
+	callbacks.includeOpenCallback = BenchIncludeOpen;
+	callbacks.includeCloseCallback = NULL;
+	callbacks.data = NULL;
+
+	if (cached)
+		Hlsl2Glsl_EnableIncludeCache ();
+	ShHandle parser = Hlsl2Glsl_ConstructCompiler (EShLangFragment);
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		if (!Hlsl2Glsl_Parse (parser, source.c_str(), ETargetGLSL_110, &callbacks, 0))
+		{
+			printf ("%s: %s\n", name, Hlsl2Glsl_GetInfoLog (parser));
+			break;
+		}
+	}
+	double t1 = GetSeconds();
+	Hlsl2Glsl_DestructCompiler (parser);
+	Hlsl2Glsl_DisableIncludeCache ();
+	Report (name, kIterations, t1 - t0);
+}
+
+static void BenchParseIncludesUncached () { BenchParseIncludes ("parse-includes", false); }
+static void BenchParseIncludesCached () { BenchParseIncludes ("parse-includes-cached", true); }
+
+// The same shader through Hlsl2Glsl_Preprocess: only the preprocessor's part of parse-includes.
+static void BenchPreprocessIncludes ()
+{
+	const int kIterations = 20;
+	const std::string source = IncludesSource ();
+
+	Hlsl2Glsl_ParseCallbacks callbacks;
+	callbacks.includeOpenCallback = BenchIncludeOpen;
+	callbacks.includeCloseCallback = NULL;
+	callbacks.data = NULL;
+
+	Hlsl2Glsl_PreprocessResult result;
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		if (!Hlsl2Glsl_Preprocess (source.data(), source.size(), &callbacks, NULL, 0, &result))
+		{
+			printf ("preprocess-includes: %s\n", result.infoLog.c_str());
+			break;
+		}
+	}
+	double t1 = GetSeconds();
+	Report ("preprocess-includes", kIterations, t1 - t0);
+}
+
+
+// Process start up: Hlsl2Glsl_Initialize, up to the point a shader can be parsed.
+static void BenchColdStart ()
+{
+	const int kIterations = 200;
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		Hlsl2Glsl_Shutdown ();
+		Hlsl2Glsl_Initialize ();
+	}
+	double t1 = GetSeconds();
+	Report ("cold-start", kIterations, t1 - t0);
+}
+
+
+// Parse and translate of a whole shader on a new compiler, with and without the
+// translation cache; the cached one is in the cache from the first iteration on.
+static void BenchTranslate (const char* name, bool cached)
+{
+	const int kIterations = 200;
+	std::string source = "sampler2D tex;\nfloat4 tint;\n";
+	source += "float4 main (float4 uv : TEXCOORD0) : COLOR0 {\n\tfloat4 r = tex2D (tex, uv.xy) * tint;\n";
+	for (int i = 0; i < 50; ++i)
+	{
+		source += "\tr += max (0, uv);\n";
+		source += "\tr.xy += lerp (uv.xy, uv.zw, 0);\n";
+	}
+	source += "\treturn r;\n}\n";
+
+	if (cached)
+		Hlsl2Glsl_EnableCache (1 << 20, NULL);
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		ShHandle parser = Hlsl2Glsl_ConstructCompiler (EShLangFragment);
+		if (!Hlsl2Glsl_Parse (parser, source.c_str(), ETargetGLSL_110, NULL, 0) ||
+			!Hlsl2Glsl_Translate (parser, "main", ETargetGLSL_110, 0))
+		{
+			printf ("%s: %s\n", name, Hlsl2Glsl_GetInfoLog (parser));
+			i = kIterations;
+		}
+		Hlsl2Glsl_DestructCompiler (parser);
+	}
+	double t1 = GetSeconds();
+	Hlsl2Glsl_DisableCache ();
+	Report (name, kIterations, t1 - t0);
+}
+
+static void BenchTranslateUncached () { BenchTranslate ("translate-uncached", false); }
+static void BenchTranslateCached () { BenchTranslate ("translate-cached", true); }
+
+
+// Translating one shader for all target versions: parsing it for each of them,
+// or parsing it once and translating that for all.
+static void BenchAllTargets (const char* name, bool parseOnce)
+{
+	const int kIterations = 100;
+	const ETargetVersion kTargets[] = { ETargetGLSL_ES_100, ETargetGLSL_110, ETargetGLSL_120, ETargetGLSL_140, ETargetGLSL_ES_300 };
+	const int kTargetCount = sizeof(kTargets) / sizeof(kTargets[0]);
+	std::string source = "sampler2D tex;\nfloat4 tint;\n";
+	source += "float4 main (float4 uv : TEXCOORD0) : COLOR0 {\n\tfloat4 r = tex2D (tex, uv.xy) * tint;\n";
+	for (int i = 0; i < 50; ++i)
+	{
+		source += "\tr += max (0, uv);\n";
+		source += "\tr.xy += lerp (uv.xy, uv.zw, 0);\n";
+	}
+	source += "\treturn r;\n}\n";
+
+	ShHandle parser = Hlsl2Glsl_ConstructCompiler (EShLangFragment);
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		for (int t = 0; t < kTargetCount; ++t)
+		{
+			bool ok = (parseOnce && t > 0) || Hlsl2Glsl_Parse (parser, source.c_str(), kTargets[t], NULL, 0);
+			if (!ok || !Hlsl2Glsl_Translate (parser, "main", kTargets[t], 0))
+			{
+				printf ("%s: %s\n", name, Hlsl2Glsl_GetInfoLog (parser));
+				i = kIterations;
+				break;
+			}
+		}
+	}
+	double t1 = GetSeconds();
+	Hlsl2Glsl_DestructCompiler (parser);
+	Report (name, kIterations, t1 - t0);
+}
+
+static void BenchAllTargetsParseEach () { BenchAllTargets ("all-targets-parse-each", false); }
+static void BenchAllTargetsParseOnce () { BenchAllTargets ("all-targets-parse-once", true); }
+
+
+// All 256 combinations of 8 keywords, of which this shader only uses 3: pasting
+// #define lines in front of the source for each variant, or giving the keywords to
+// Hlsl2Glsl_TranslateVariants, which translates the 8 distinct ones once each.
+static void BenchVariants (const char* name, bool shared)
+{
+	const int kIterations = 2;
+	const int kKeywords = 8;
+	const int kVariantCount = 1 << kKeywords;
+	std::string source = "sampler2D tex;\nfloat4 tint;\n";
+	source += "float4 main (float4 uv : TEXCOORD0) : COLOR0 {\n\tfloat4 r = tex2D (tex, uv.xy) * tint;\n";
+	for (int i = 0; i < 20; ++i)
+	{
+		source += "#if KEYWORD_0\n\tr += max (0, uv);\n#endif\n";
+		source += "#if KEYWORD_1\n\tr.xy += lerp (uv.xy, uv.zw, 0.5);\n#else\n\tr.xy -= uv.zw;\n#endif\n";
+		source += "#if KEYWORD_2\n\tr *= dot (r, uv);\n#endif\n";
+	}
+	source += "\treturn r;\n}\n";
+
+	static const char* kNames[kKeywords] = { "KEYWORD_0", "KEYWORD_1", "KEYWORD_2", "KEYWORD_3", "KEYWORD_4", "KEYWORD_5", "KEYWORD_6", "KEYWORD_7" };
+	std::vector<Hlsl2Glsl_Define> defines (kVariantCount * kKeywords);
+	std::vector<Hlsl2Glsl_Variant> variants (kVariantCount);
+	std::vector<std::string> pasted (kVariantCount);
+	for (int v = 0; v < kVariantCount; ++v)
+	{
+		variants[v].defines = &defines[v * kKeywords];
+		variants[v].defineCount = 0;
+		for (int k = 0; k < kKeywords; ++k)
+		{
+			if (!(v & (1 << k)))
+				continue;
+			Hlsl2Glsl_Define& d = defines[v * kKeywords + variants[v].defineCount++];
+			d.name = kNames[k];
+			d.value = NULL;
+			pasted[v] += std::string ("#define ") + kNames[k] + " 1\n";
+		}
+		pasted[v] += source;
+	}
+
+	ShHandle parser = Hlsl2Glsl_ConstructCompiler (EShLangFragment);
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		int succeeded = 0;
+		if (shared)
+			succeeded = Hlsl2Glsl_TranslateVariants (parser, source.c_str(), "main", ETargetGLSL_110, NULL, 0, &variants[0], kVariantCount);
+		else
+		{
+			for (int v = 0; v < kVariantCount; ++v)
+				succeeded += Hlsl2Glsl_Parse (parser, pasted[v].c_str(), ETargetGLSL_110, NULL, 0) && Hlsl2Glsl_Translate (parser, "main", ETargetGLSL_110, 0);
+		}
+		if (succeeded != kVariantCount)
+		{
+			printf ("%s: %s\n", name, Hlsl2Glsl_GetInfoLog (parser));
+			break;
+		}
+	}
+	double t1 = GetSeconds();
+	Hlsl2Glsl_DestructCompiler (parser);
+	Report (name, kIterations, t1 - t0);
+}
+
+static void BenchVariantsPasted () { BenchVariants ("variants-pasted", false); }
+static void BenchVariantsShared () { BenchVariants ("variants-shared", true); }
+
+
+// A generated header with 10000 macros (a tenth of them with arguments), and code
+// that uses some of them along with other identifiers, which aren't macros.
+static void BenchMacros ()
+{
+	const int kIterations = 10;
+	const int kMacros = 10000;
+	std::string source;
+	char buf[200];
+	for (int i = 0; i < kMacros; ++i)
+	{
+		if (i % 10 == 0)
+			sprintf (buf, "#define SCALE_%i(a, b) ((a) * K_%i + (b))\n", i, i + 1);
+		else
+			sprintf (buf, "#define K_%i %i.5\n", i, i);
+		source += buf;
+	}
+	source += "float4 main (float4 uv : TEXCOORD0) : COLOR0 {\n\tfloat4 r = uv;\n";
+	for (int i = 0; i < 200; ++i)
+	{
+		const int m = (i * 7919) % kMacros;
+		sprintf (buf, "\tr.xy = SCALE_%i (r.xy, uv.zw) + K_%i * r.zw;\n", m - m % 10, m - m % 10 + 3);
+		source += buf;
+	}
+	source += "\treturn r;\n}\n";
+
+	ShHandle parser = Hlsl2Glsl_ConstructCompiler (EShLangFragment);
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		if (!Hlsl2Glsl_Parse (parser, source.c_str(), ETargetGLSL_110, NULL, 0))
+		{
+			printf ("macros-10k: %s\n", Hlsl2Glsl_GetInfoLog (parser));
+			break;
+		}
+	}
+	double t1 = GetSeconds();
+	Hlsl2Glsl_DestructCompiler (parser);
+	Report ("macros-10k", kIterations, t1 - t0);
+}
+
+
+// Preprocessing a shader made mostly of calls to a few small macros, with
+// arguments that are other macro calls and object-like macros.
+static void BenchMacroCalls ()
+{
+	const int kIterations = 20;
+	std::string source =
+		"#define HALF 0.5\n"
+		"#define ONE float4 (1.0, 1.0, 1.0, 1.0)\n"
+		"#define MUL(a, b) ((a) * (b))\n"
+		"#define MAD(a, b, c) ((a) * (b) + (c))\n"
+		"#define LERP(a, b, t) ((a) + ((b) - (a)) * (t))\n"
+		"#define SAT(x) clamp (x, 0.0, 1.0)\n"
+		"float4 main (float4 uv : TEXCOORD0) : COLOR0 {\n\tfloat4 r = uv;\n";
+	char buf[200];
+	for (int i = 0; i < 1000; ++i)
+	{
+		sprintf (buf, "\tr = LERP (r, MAD (uv, HALF, ONE), SAT (MUL (r.x, %i.0)));\n", i);
+		source += buf;
+	}
+	source += "\treturn r;\n}\n";
+
+	Hlsl2Glsl_PreprocessResult result;
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		if (!Hlsl2Glsl_Preprocess (source.data(), source.size(), NULL, NULL, 0, &result))
+		{
+			printf ("macro-calls: %s\n", result.infoLog.c_str());
+			break;
+		}
+	}
+	double t1 = GetSeconds();
+	Report ("macro-calls", kIterations, t1 - t0);
+}
+
+
+// Preprocessing one variant of a generated uber-shader: ten blocks under #if, with
+// comments and nested conditionals, of which the variant compiles only one.
+static void BenchSkipInactive ()
+{
+	const int kIterations = 20;
+	const int kBlocks = 10;
+	std::string source;
+	char buf[400];
+	for (int b = 0; b < kBlocks; ++b)
+	{
+		sprintf (buf, "#if VARIANT == %i\n", b);
+		source += buf;
+		for (int i = 0; i < 40; ++i)
+		{
+			sprintf (buf,
+				"// f%i_%i: scales and biases a, with the sign of b.x\n"
+				"float4 f%i_%i (float4 a, float4 b, float2 uv) {\n"
+				"\tfloat4 r = a * b + float4 (1.0, 2.5, 3.0, 4.0) - dot (a.xyz, b.xyz); /* not normalized */\n"
+				"#ifdef USE_UV\n"
+				"\tr.xy += uv * 0.5f; r.zw -= a.wz * (b.x >= 0.0 ? 1.0 : -1.0);\n"
+				"#endif\n"
+				"\treturn r;\n}\n", b, i, b, i);
+			source += buf;
+		}
+		source += "#endif\n";
+	}
+	source += "float4 main (float4 uv : TEXCOORD0) : COLOR0 {\n\treturn f3_0 (uv, uv, uv.xy);\n}\n";
+
+	const Hlsl2Glsl_Define defines[] = { { "VARIANT", "3" }, { "USE_UV", NULL } };
+	Hlsl2Glsl_PreprocessResult result;
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		if (!Hlsl2Glsl_Preprocess (source.data(), source.size(), NULL, defines, 2, &result))
+		{
+			printf ("skip-inactive: %s\n", result.infoLog.c_str());
+			break;
+		}
+	}
+	double t1 = GetSeconds();
+	Report ("skip-inactive", kIterations, t1 - t0);
+}
+
+
+// Preprocessing a shader whose headers all include the same big guarded header;
+// only the first include of it is opened and lexed.
+static bool C_DECL BenchGuardedIncludeOpen (bool isSystem, const char* fname, const char* parentfname, const char* parent, std::string& output, void* d)
+{
+	if (strcmp (fname, "common.hlsl") != 0)
+	{
+		char buf[200];
+		sprintf (buf, "#include \"common.hlsl\"\nfloat4 f%i_0 (float4 a, float4 b, float2 uv) { return a * b; }\n", atoi (fname + 1));
+		output = buf;
+		return true;
+	}
+	output = "#ifndef COMMON_HLSL\n#define COMMON_HLSL\n";
+	for (int i = 0; i < 4; ++i)
+		BenchIncludeOpen (isSystem, "h99", parentfname, parent, output, d);
+	output += "#endif\n";
+	return true;
+}
+
+static void BenchIncludeGuards ()
+{
+	const int kIterations = 20;
+	const std::string source = IncludesSource ();
+
+	Hlsl2Glsl_ParseCallbacks callbacks;
+	callbacks.includeOpenCallback = BenchGuardedIncludeOpen;
+	callbacks.includeCloseCallback = NULL;
+	callbacks.data = NULL;
+
+	Hlsl2Glsl_PreprocessResult result;
+	double t0 = GetSeconds();
+	for (int i = 0; i < kIterations; ++i)
+	{
+		if (!Hlsl2Glsl_Preprocess (source.data(), source.size(), &callbacks, NULL, 0, &result))
+		{
+			printf ("include-guards: %s\n", result.infoLog.c_str());
+			break;
+		}
+	}
+	double t1 = GetSeconds();
+	if (result.skippedIncludes != 15)
+		printf ("include-guards: skipped %u includes instead of 15\n", result.skippedIncludes);
+	Report ("include-guards", kIterations, t1 - t0);
+}
+
+
+struct Benchmark
+{
+	const char* name;
+	void (*func)();
+};
+
+static const Benchmark kBenchmarks[] = {
+	{ "empty-shader", BenchEmptyShader },
+	{ "intrinsic-calls", BenchIntrinsicCalls },
+	{ "identifiers", BenchIdentifiers },
+	{ "expressions", BenchExpressions },
+	{ "samplers-16", BenchSamplers16 },
+	{ "samplers-64", BenchSamplers64 },
+	{ "samplers-256", BenchSamplers256 },
+	{ "parse-includes", BenchParseIncludesUncached },
+	{ "parse-includes-cached", BenchParseIncludesCached },
+	{ "preprocess-includes", BenchPreprocessIncludes },
+	{ "cold-start", BenchColdStart },
+	{ "translate-uncached", BenchTranslateUncached },
+	{ "translate-cached", BenchTranslateCached },
+	{ "all-targets-parse-each", BenchAllTargetsParseEach },
+	{ "all-targets-parse-once", BenchAllTargetsParseOnce },
+	{ "variants-pasted", BenchVariantsPasted },
+	{ "variants-shared", BenchVariantsShared },
+	{ "macros-10k", BenchMacros },
+	{ "macro-calls", BenchMacroCalls },
+	{ "skip-inactive", BenchSkipInactive },
+	{ "include-guards", BenchIncludeGuards },
+};
+
+
+int main (int argc, const char** argv)
+{
+	Hlsl2Glsl_Initialize ();
+
+	const int count = sizeof(kBenchmarks) / sizeof(kBenchmarks[0]);
+	for (int i = 0; i < count; ++i)
+	{
+		bool run = argc < 2;
+		for (int a = 1; a < argc; ++a)
+			run |= strcmp (argv[a], kBenchmarks[i].name) == 0;
+		if (run)
+			kBenchmarks[i].func ();
+	}
+
+	Hlsl2Glsl_Shutdown ();
+	return 0;
+}
@@ -0,0 +1,240 @@
+// Generates the precompiled built-in symbol table (BuiltInSymbols.h) from the
+// built-in prototypes in Initialize.cpp, or checks that it is up to date.
+//
+// Usage: hlsl2glslbuiltins [--write] path/to/BuiltInSymbols.h
+// Without --write, fails if the file differs from what would be generated, or
+// if the built-ins loaded from it differ from the parsed ones.
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "../../include/hlsl2glsl.h"
+#include "../../hlslang/MachineIndependent/Initialize.h"
+
+
+struct OperatorName
+{
+	TOperator op;
+	const char* name;
+};
+
+#define OP(x) { x, #x }
+static const OperatorName kOperatorNames[] = {
+	OP(EOpNull), OP(EOpMod), OP(EOpRadians), OP(EOpDegrees), OP(EOpSin), OP(EOpCos), OP(EOpTan),
+	OP(EOpAsin), OP(EOpAcos), OP(EOpAtan), OP(EOpAtan2), OP(EOpSinCos), OP(EOpPow), OP(EOpExp2),
+	OP(EOpLog), OP(EOpExp), OP(EOpLog2), OP(EOpLog10), OP(EOpSqrt), OP(EOpInverseSqrt), OP(EOpAbs),
+	OP(EOpSign), OP(EOpFloor), OP(EOpCeil), OP(EOpFract), OP(EOpMin), OP(EOpMax), OP(EOpClamp),
+	OP(EOpMix), OP(EOpStep), OP(EOpSmoothStep), OP(EOpMul), OP(EOpTranspose), OP(EOpDeterminant),
+	OP(EOpLength), OP(EOpDistance), OP(EOpDot), OP(EOpCross), OP(EOpNormalize), OP(EOpFaceForward),
+	OP(EOpReflect), OP(EOpRefract), OP(EOpAny), OP(EOpAll),
+	OP(EOpTex1D), OP(EOpTex1DProj), OP(EOpTex1DLod), OP(EOpTex1DBias), OP(EOpTex1DGrad),
+	OP(EOpTex2D), OP(EOpTex2DProj), OP(EOpTex2DLod), OP(EOpTex2DBias), OP(EOpTex2DGrad),
+	OP(EOpTex3D), OP(EOpTex3DProj), OP(EOpTex3DLod), OP(EOpTex3DBias), OP(EOpTex3DGrad),
+	OP(EOpTexRect), OP(EOpTexRectProj), OP(EOpTexCube), OP(EOpTexCubeProj), OP(EOpTexCubeLod),
+	OP(EOpTexCubeBias), OP(EOpTexCubeGrad), OP(EOpShadow2D), OP(EOpShadow2DProj),
+	OP(EOpTex2DArray), OP(EOpTex2DArrayLod), OP(EOpTex2DArrayBias),
+	OP(EOpSaturate), OP(EOpModf), OP(EOpLdexp), OP(EOpRound), OP(EOpTrunc), OP(EOpLit),
+	OP(EOpD3DCOLORtoUBYTE4), OP(EOpDPdx), OP(EOpDPdy), OP(EOpFwidth), OP(EOpFclip),
+};
+#undef OP
+
+static const char* kBasicTypeNames[] = {
+	"EbtVoid", "EbtFloat", "EbtInt", "EbtBool", "EbtGuardSamplerBegin", "EbtSamplerGeneric",
+	"EbtSampler1D", "EbtSampler2D", "EbtSampler3D", "EbtSamplerCube", "EbtSampler1DShadow",
+	"EbtSampler2DShadow", "EbtSamplerRect", "EbtSamplerRectShadow", "EbtSampler2DArray",
+};
+
+static const char* kPrecisionNames[] = { "EbpUndefined", "EbpLow", "EbpMedium", "EbpHigh" };
+
+static const char* kQualifierNames[] = {
+	"EvqTemporary", "EvqGlobal", "EvqConst", "EvqStatic", "EvqAttribute", "EvqUniform",
+	"EvqMutableUniform", "EvqIn", "EvqOut", "EvqInOut",
+};
+
+#define ARRAY_SIZE(a) int(sizeof(a) / sizeof(a[0]))
+
+
+static bool Fail (const char* message, const char* detail = "")
+{
+	printf ("hlsl2glslbuiltins: %s%s\n", message, detail);
+	return false;
+}
+
+static bool CompareUniqueId (const TFunction* a, const TFunction* b)
+{
+	return a->getUniqueId() < b->getUniqueId();
+}
+
+static bool AddType (std::vector<std::string>& types, const TType& type, int* index)
+{
+	if (type.isArray() || type.getStruct() || type.getBasicType() >= ARRAY_SIZE(kBasicTypeNames) ||
+		type.getQualifier() >= ARRAY_SIZE(kQualifierNames))
+		return Fail ("built-in type can't be precompiled: ", type.getBasicString());
+
+	char buf[200];
+	sprintf (buf, "{ %s, %s, %s, %i, %i, %s }",
+		kBasicTypeNames[type.getBasicType()], kPrecisionNames[type.getPrecision()], kQualifierNames[type.getQualifier()],
+		type.getColsCount(), type.getRowsCount(), type.isMatrix() ? "true" : "false");
+
+	*index = int(std::find (types.begin(), types.end(), buf) - types.begin());
+	if (*index == int(types.size()))
+		types.push_back (buf);
+	return true;
+}
+
+// Writes the built-in level of a symbol table as BuiltInSymbols.h source.
+static bool WriteBuiltInSymbols (const TSymbolTable& symbolTable, std::string& out)
+{
+	std::vector<const TFunction*> functions;
+	const TSymbolTableLevel* level = symbolTable.getBuiltInLevel();
+	for (TSymbolTableLevel::const_iterator it = level->begin(); it != level->end(); ++it)
+	{
+		if (!it->second->isFunction() || it->second->getInfo())
+			return Fail ("built-in can't be precompiled: ", it->second->getName().c_str());
+		functions.push_back (static_cast<const TFunction*>(it->second));
+	}
+
+	// Duplicated prototypes leave gaps in the unique IDs, which the loader
+	// reproduces; but it can't reproduce a gap at the very end.
+	std::sort (functions.begin(), functions.end(), CompareUniqueId);
+	if (!functions.empty() && symbolTable.getLastUniqueId() != functions.back()->getUniqueId())
+		return Fail ("the last built-in prototype is a duplicate");
+
+	std::vector<std::string> types;
+	std::vector<std::string> params;
+	std::string funcs;
+	char buf[200];
+	for (size_t i = 0; i < functions.size(); ++i)
+	{
+		const TFunction& f = *functions[i];
+		const char* opName = NULL;
+		for (int o = 0; o < ARRAY_SIZE(kOperatorNames); ++o)
+			if (kOperatorNames[o].op == f.getBuiltInOp())
+				opName = kOperatorNames[o].name;
+		if (!opName)
+			return Fail ("unknown operator for built-in: ", f.getName().c_str());
+
+		// parameter lists are shared between functions where they match
+		std::vector<std::string> fparams;
+		for (int p = 0; p < f.getParamCount(); ++p)
+		{
+			int type;
+			if (f[p].info || !AddType (types, *f[p].type, &type))
+				return Fail ("parameter can't be precompiled: ", f.getMangledName().c_str());
+			sprintf (buf, "{ \"%s\", %i }", f[p].name->c_str(), type);
+			fparams.push_back (buf);
+		}
+		size_t first = params.size();
+		if (!fparams.empty())
+		{
+			std::vector<std::string>::iterator it = std::search (params.begin(), params.end(), fparams.begin(), fparams.end());
+			first = it - params.begin();
+			if (it == params.end())
+				params.insert (params.end(), fparams.begin(), fparams.end());
+		}
+
+		int returnType;
+		if (!AddType (types, f.getReturnType(), &returnType))
+			return false;
+		sprintf (buf, "\t{ \"%s\", %s, %i, %i, %i, %i },\n", f.getName().c_str(), opName, returnType, int(first), f.getParamCount(), f.getUniqueId());
+		funcs += buf;
+	}
+
+	out = "// Generated by hlsl2glslbuiltins from the built-in prototypes in Initialize.cpp, do not edit.\n";
+	out += "// See Initialize.h.\n\n";
+	out += "#ifndef _BUILT_IN_SYMBOLS_INCLUDED_\n#define _BUILT_IN_SYMBOLS_INCLUDED_\n\n";
+	out += "static const TBuiltInType kBuiltInTypes[] = {\n";
+	for (size_t i = 0; i < types.size(); ++i)
+		out += "\t" + types[i] + ",\n";
+	out += "};\n\nstatic const TBuiltInParameter kBuiltInParameters[] = {\n";
+	for (size_t i = 0; i < params.size(); ++i)
+		out += "\t" + params[i] + ",\n";
+	out += "};\n\n// in unique ID order\nstatic const TBuiltInFunction kBuiltInFunctions[] = {\n";
+	out += funcs;
+	out += "};\n\n#endif // _BUILT_IN_SYMBOLS_INCLUDED_\n";
+	return true;
+}
+
+
+static bool ReadFile (const char* path, std::string& text)
+{
+	FILE* f = fopen (path, "rb");
+	if (!f)
+		return false;
+	char buf[4096];
+	size_t n;
+	while ((n = fread (buf, 1, sizeof(buf), f)) > 0)
+		text.append (buf, n);
+	fclose (f);
+	return true;
+}
+
+static bool Run (const char* path, bool write)
+{
+	TInfoSink infoSink;
+	TBuiltIns builtIns;
+	builtIns.initialize ();
+
+	std::string generated;
+	for (int language = EShLangVertex; language < EShLangCount; ++language)
+	{
+		TSymbolTable parsed;
+		if (!ParseBuiltInSymbols (builtIns.getBuiltInStrings(), EShLanguage(language), infoSink, parsed))
+			return Fail ("can't parse built-ins: ", infoSink.info.c_str());
+		std::string text;
+		if (!WriteBuiltInSymbols (parsed, text))
+			return false;
+		if (language != EShLangVertex && text != generated)
+			return Fail ("built-ins differ between languages");
+		generated = text;
+	}
+
+	if (write)
+	{
+		FILE* f = fopen (path, "wb");
+		if (!f || fwrite (generated.data(), 1, generated.size(), f) != generated.size())
+			return Fail ("can't write ", path);
+		fclose (f);
+		return true;
+	}
+
+	std::string existing;
+	if (!ReadFile (path, existing))
+		return Fail ("can't read ", path);
+	if (existing != generated)
+		return Fail ("out of date, regenerate with --write: ", path);
+
+	for (int language = EShLangVertex; language < EShLangCount; ++language)
+	{
+		TSymbolTable loaded;
+		LoadBuiltInSymbols (EShLanguage(language), loaded);
+		std::string text;
+		if (!WriteBuiltInSymbols (loaded, text) || text != generated)
+			return Fail ("loaded built-ins differ from the parsed ones");
+	}
+	return true;
+}
+
+
+int main (int argc, const char** argv)
+{
+	bool write = argc == 3 && strcmp (argv[1], "--write") == 0;
+	if (argc != 2 && !write)
+	{
+		printf ("Usage: hlsl2glslbuiltins [--write] path/to/BuiltInSymbols.h\n");
+		return 1;
+	}
+
+	// sets up the memory pools of this thread
+	Hlsl2Glsl_Initialize ();
+	bool ok = Run (argv[argc - 1], write);
+	Hlsl2Glsl_Shutdown ();
+
+	if (ok)
+		printf ("hlsl2glslbuiltins: %s %s\n", argv[argc - 1], write ? "written" : "is up to date");
+	return ok ? 0 : 1;
+}
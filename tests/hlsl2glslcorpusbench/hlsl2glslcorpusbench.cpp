@@ -0,0 +1,441 @@
+// Times the translator on the test corpus, phase by phase.
+//
+// Usage: hlsl2glslcorpusbench testfolder [iterations] [results.json]
+//
+// All shaders (and the files they include) are read into memory first, and
+// translated once untimed. Then every shader is translated for each of its
+// targets [iterations] times, timing preprocessing, parsing, TransformAST,
+// ProduceGLSL, linking and getShaderText separately. Prints the median and
+// 99th percentile time of each phase, shaders per second and the peak pool
+// memory of a translation; the JSON file has the same, plus the median time and
+// peak pool memory of each shader, to diff between builds.
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <time.h>
+#endif
+
+#include "../../include/hlsl2glsl.h"
+#include "../../hlslang/MachineIndependent/ParseHelper.h"
+#include "../../hlslang/GLSLCodeGen/hlslCrossCompiler.h"
+#include "../../hlslang/GLSLCodeGen/hlslLinker.h"
+
+
+static const int kDefaultIterations = 10;
+
+
+static double GetSeconds ()
+{
+	#ifdef _MSC_VER
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency (&frequency);
+	QueryPerformanceCounter (&counter);
+	return double(counter.QuadPart) / double(frequency.QuadPart);
+	#else
+	timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return double(ts.tv_sec) + double(ts.tv_nsec) * 1.0e-9;
+	#endif
+}
+
+
+typedef std::vector<std::string> StringVector;
+
+static bool EndsWith (const std::string& str, const std::string& sub)
+{
+	return (str.size() >= sub.size()) && (strncmp (str.c_str()+str.size()-sub.size(), sub.c_str(), sub.size())==0);
+}
+
+static StringVector GetFiles (const std::string& folder, const std::string& endsWith)
+{
+	StringVector res;
+
+	#ifdef _MSC_VER
+	WIN32_FIND_DATAA FindFileData;
+	HANDLE hFind = FindFirstFileA ((folder+"/*"+endsWith).c_str(), &FindFileData);
+	if (hFind == INVALID_HANDLE_VALUE)
+		return res;
+
+	do {
+		res.push_back (FindFileData.cFileName);
+	} while (FindNextFileA (hFind, &FindFileData));
+
+	FindClose (hFind);
+
+	#else
+
+	DIR *dirp;
+	struct dirent *dp;
+
+	if ((dirp = opendir(folder.c_str())) == NULL)
+		return res;
+
+	while ( (dp = readdir(dirp)) )
+	{
+		std::string fname = dp->d_name;
+		if (fname == "." || fname == "..")
+			continue;
+		if (!EndsWith (fname, endsWith))
+			continue;
+		res.push_back (fname);
+	}
+	closedir(dirp);
+
+	#endif
+
+	// sorted, so that the JSON of different runs can be diffed
+	std::sort (res.begin(), res.end());
+	return res;
+}
+
+static bool ReadStringFromFile (const char* pathName, std::string& output)
+{
+	FILE* file = fopen(pathName, "rb");
+	if (file == NULL)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (length < 0)
+	{
+		fclose( file );
+		return false;
+	}
+
+	output.resize(length);
+	size_t readLength = length ? fread(&*output.begin(), 1, length, file) : 0;
+	fclose(file);
+
+	if (readLength != (size_t)length)
+	{
+		output.clear();
+		return false;
+	}
+	return true;
+}
+
+
+// Included files are read on the first (untimed) translation, and kept here.
+typedef std::map<std::string, std::string> FileMap;
+
+struct IncludeData
+{
+	std::string folder;
+	FileMap* files;
+};
+
+static bool C_DECL IncludeOpenCallback(bool isSystem, const char* fname, const char* parentfname, const char* parent, const char** text, size_t* length, void* d)
+{
+	const IncludeData* data = reinterpret_cast<const IncludeData*>(d);
+	std::string pathName = data->folder + "/" + fname;
+	FileMap::iterator it = data->files->find (pathName);
+	if (it == data->files->end())
+	{
+		std::string text;
+		if (!ReadStringFromFile (pathName.c_str(), text))
+			return false;
+		it = data->files->insert (std::make_pair (pathName, text)).first;
+	}
+	*text = it->second.data();
+	*length = it->second.size();
+	return true;
+}
+
+
+enum Phase
+{
+	kPhasePreprocess,
+	kPhaseParse,
+	kPhaseTransform,
+	kPhaseProduceGLSL,
+	kPhaseLink,
+	kPhaseShaderText,
+	kPhaseCount
+};
+
+static const char* kPhaseNames[kPhaseCount] = { "preprocess", "parse", "transform", "produceGLSL", "link", "shaderText" };
+
+static const char* kTargetNames[ETargetVersionCount] = { "es100", "110", "120", "140", "es300" };
+
+
+// One translation: a shader, its entry point and the target to translate it for.
+struct BenchJob
+{
+	std::string name;
+	IncludeData include;
+	std::string source;
+	EShLanguage language;
+	const char* entryPoint;
+	ETargetVersion version;
+
+	std::vector<double> times;  // of all phases, per timed iteration
+	size_t peakPoolBytes;
+};
+
+typedef std::vector<BenchJob> JobVector;
+
+
+static void AddJobs (JobVector& jobs, FileMap& files, const std::string& baseFolder, const char* typeName,
+					 EShLanguage language, const char* entryPoint, const ETargetVersion* versions, int versionCount)
+{
+	const std::string folder = baseFolder + "/" + typeName;
+	StringVector inputFiles = GetFiles (folder, "-in.txt");
+	for (size_t i = 0; i < inputFiles.size(); ++i)
+	{
+		BenchJob job;
+		job.include.folder = folder;
+		job.include.files = &files;
+		if (!ReadStringFromFile ((folder + "/" + inputFiles[i]).c_str(), job.source))
+			continue;
+		job.language = language;
+		job.entryPoint = entryPoint;
+		job.peakPoolBytes = 0;
+		for (int v = 0; v < versionCount; ++v)
+		{
+			job.name = std::string(typeName) + "/" + inputFiles[i] + ":" + entryPoint + "@" + kTargetNames[versions[v]];
+			job.version = versions[v];
+			jobs.push_back (job);
+		}
+	}
+}
+
+
+// Translates a job one phase at a time, the way Hlsl2Glsl_Parse and Hlsl2Glsl_Translate do
+// (without the translation cache). Phases that aren't run, as the shader failed before, get
+// a negative time. Returns the peak pool memory of the translation.
+static size_t TranslateJob (HlslCrossCompiler* compiler, BenchJob& job, double times[kPhaseCount])
+{
+	for (int p = 0; p < kPhaseCount; ++p)
+		times[p] = -1.0;
+
+	TParseCallbacks callbacks;
+	callbacks.openRef = IncludeOpenCallback;
+	callbacks.data = &job.include;
+
+	compiler->Reset();
+	TPoolAllocator& threadPool = GetGlobalPoolAllocator();
+	const size_t threadPoolBase = threadPool.getBytesInUse();
+	threadPool.resetPeakBytes();
+	compiler->GetASTPool().resetPeakBytes();
+
+	double t0 = GetSeconds();
+	TPreprocessedSource* source = new TPreprocessedSource();
+	PaPreprocess (job.source.c_str(), job.source.size(), *source, &callbacks);
+	compiler->SetSource (source);
+	double t1 = GetSeconds();
+	times[kPhasePreprocess] = t1 - t0;
+
+	bool ok = PaBuildAST (compiler, job.version, 0);
+	t0 = GetSeconds();
+	times[kPhaseParse] = t0 - t1;
+
+	if (ok && compiler->HasAST (job.version))
+	{
+		compiler->TransformAST ();
+		t1 = GetSeconds();
+		times[kPhaseTransform] = t1 - t0;
+
+		compiler->ProduceGLSL (job.version, 0);
+		t0 = GetSeconds();
+		times[kPhaseProduceGLSL] = t0 - t1;
+
+		ok = compiler->GetLinker()->link (compiler, job.entryPoint, job.version, 0);
+		t1 = GetSeconds();
+		times[kPhaseLink] = t1 - t0;
+
+		if (ok)
+		{
+			compiler->GetLinker()->getShaderText ();
+			t0 = GetSeconds();
+			times[kPhaseShaderText] = t0 - t1;
+		}
+	}
+
+	return compiler->GetASTPool().getPeakBytes() + (threadPool.getPeakBytes() - threadPoolBase);
+}
+
+
+struct PhaseStats
+{
+	size_t count;
+	double total, p50, p99;
+};
+
+// Of the times that aren't negative.
+static PhaseStats GetStats (const std::vector<double>& allTimes)
+{
+	PhaseStats stats = { 0, 0.0, 0.0, 0.0 };
+	std::vector<double> times;
+	for (size_t i = 0; i < allTimes.size(); ++i)
+		if (allTimes[i] >= 0.0)
+			times.push_back (allTimes[i]);
+	if (times.empty())
+		return stats;
+	std::sort (times.begin(), times.end());
+	stats.count = times.size();
+	for (size_t i = 0; i < times.size(); ++i)
+		stats.total += times[i];
+	// nearest rank
+	stats.p50 = times[(times.size() * 50 + 99) / 100 - 1];
+	stats.p99 = times[(times.size() * 99 + 99) / 100 - 1];
+	return stats;
+}
+
+
+static void WriteJSONString (FILE* f, const std::string& s)
+{
+	fputc ('"', f);
+	for (size_t i = 0; i < s.size(); ++i)
+	{
+		const unsigned char c = s[i];
+		if (c == '"' || c == '\\')
+			fprintf (f, "\\%c", c);
+		else if (c < 0x20)
+			fprintf (f, "\\u%04x", c);
+		else
+			fputc (c, f);
+	}
+	fputc ('"', f);
+}
+
+static bool WriteJSON (const char* path, const JobVector& jobs, int iterations, const PhaseStats* phases,
+					   const PhaseStats& total, double shadersPerSecond, size_t peakPoolBytes)
+{
+	FILE* f = fopen (path, "wb");
+	if (!f)
+		return false;
+	fprintf (f, "{\n");
+	fprintf (f, "\t\"shaders\": %i,\n", (int)jobs.size());
+	fprintf (f, "\t\"iterations\": %i,\n", iterations);
+	fprintf (f, "\t\"shadersPerSecond\": %.1f,\n", shadersPerSecond);
+	fprintf (f, "\t\"peakPoolBytes\": %i,\n", (int)peakPoolBytes);
+	fprintf (f, "\t\"phases\": {\n");
+	for (int p = 0; p <= kPhaseCount; ++p)
+	{
+		const PhaseStats& s = p < kPhaseCount ? phases[p] : total;
+		fprintf (f, "\t\t\"%s\": { \"count\": %i, \"p50us\": %.2f, \"p99us\": %.2f, \"totalms\": %.3f }%s\n",
+			p < kPhaseCount ? kPhaseNames[p] : "total", (int)s.count, s.p50 * 1.0e6, s.p99 * 1.0e6, s.total * 1.0e3, p < kPhaseCount ? "," : "");
+	}
+	fprintf (f, "\t},\n");
+	fprintf (f, "\t\"perShader\": [\n");
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		std::vector<double> totals (iterations, 0.0);
+		for (int iter = 0; iter < iterations; ++iter)
+			for (int p = 0; p < kPhaseCount; ++p)
+				totals[iter] += std::max (jobs[i].times[iter * kPhaseCount + p], 0.0);
+		fprintf (f, "\t\t{ \"name\": ");
+		WriteJSONString (f, jobs[i].name);
+		fprintf (f, ", \"p50us\": %.2f, \"peakPoolBytes\": %i }%s\n", GetStats (totals).p50 * 1.0e6, (int)jobs[i].peakPoolBytes, i + 1 < jobs.size() ? "," : "");
+	}
+	fprintf (f, "\t]\n");
+	fprintf (f, "}\n");
+	fclose (f);
+	return true;
+}
+
+
+int main (int argc, const char** argv)
+{
+	if (argc < 2)
+	{
+		printf ("USAGE: hlsl2glslcorpusbench testfolder [iterations] [results.json]\n");
+		return 1;
+	}
+
+	int iterations = argc > 2 ? atoi(argv[2]) : kDefaultIterations;
+	if (iterations < 1)
+		iterations = 1;
+
+	Hlsl2Glsl_Initialize ();
+
+	const std::string baseFolder = argv[1];
+	const ETargetVersion kAllTargets[] = { ETargetGLSL_110, ETargetGLSL_120, ETargetGLSL_ES_100, ETargetGLSL_ES_300 };
+	const ETargetVersion kGLTargets[] = { ETargetGLSL_110, ETargetGLSL_120 };
+
+	FileMap files;
+	JobVector jobs;
+	AddJobs (jobs, files, baseFolder, "vertex", EShLangVertex, "main", kAllTargets, 4);
+	AddJobs (jobs, files, baseFolder, "fragment", EShLangFragment, "main", kAllTargets, 4);
+	AddJobs (jobs, files, baseFolder, "vertex-120", EShLangVertex, "main", kAllTargets, 4);
+	AddJobs (jobs, files, baseFolder, "fragment-120", EShLangFragment, "main", kAllTargets, 4);
+	AddJobs (jobs, files, baseFolder, "vertex-failures", EShLangVertex, "main", kGLTargets, 2);
+	AddJobs (jobs, files, baseFolder, "fragment-failures", EShLangFragment, "main", kGLTargets, 2);
+	AddJobs (jobs, files, baseFolder, "combined", EShLangVertex, "vs_main", kAllTargets, 4);
+	AddJobs (jobs, files, baseFolder, "combined", EShLangFragment, "ps_main", kAllTargets, 4);
+	if (jobs.empty())
+	{
+		printf ("no tests found in %s\n", baseFolder.c_str());
+		Hlsl2Glsl_Shutdown();
+		return 1;
+	}
+
+	// compilers are reused, like Hlsl2Glsl_TranslateBatch does
+	HlslCrossCompiler* compilers[EShLangCount];
+	for (int i = 0; i < EShLangCount; ++i)
+		compilers[i] = static_cast<HlslCrossCompiler*>(Hlsl2Glsl_ConstructCompiler (EShLanguage(i)));
+
+	double times[kPhaseCount];
+	for (size_t i = 0; i < jobs.size(); ++i)
+		TranslateJob (compilers[jobs[i].language], jobs[i], times);
+
+	std::vector<double> phaseTimes[kPhaseCount];
+	std::vector<double> totalTimes;
+	for (int iter = 0; iter < iterations; ++iter)
+	{
+		for (size_t i = 0; i < jobs.size(); ++i)
+		{
+			BenchJob& job = jobs[i];
+			job.peakPoolBytes = std::max (job.peakPoolBytes, TranslateJob (compilers[job.language], job, times));
+			double total = 0.0;
+			for (int p = 0; p < kPhaseCount; ++p)
+			{
+				job.times.push_back (times[p]);
+				phaseTimes[p].push_back (times[p]);
+				total += std::max (times[p], 0.0);
+			}
+			totalTimes.push_back (total);
+		}
+	}
+
+	for (int i = 0; i < EShLangCount; ++i)
+		Hlsl2Glsl_DestructCompiler (compilers[i]);
+
+	PhaseStats phases[kPhaseCount];
+	printf ("%-12s %8s %10s %10s %10s\n", "phase", "count", "p50 us", "p99 us", "total ms");
+	for (int p = 0; p < kPhaseCount; ++p)
+	{
+		phases[p] = GetStats (phaseTimes[p]);
+		printf ("%-12s %8i %10.2f %10.2f %10.2f\n", kPhaseNames[p], (int)phases[p].count, phases[p].p50 * 1.0e6, phases[p].p99 * 1.0e6, phases[p].total * 1.0e3);
+	}
+	const PhaseStats total = GetStats (totalTimes);
+	printf ("%-12s %8i %10.2f %10.2f %10.2f\n", "total", (int)total.count, total.p50 * 1.0e6, total.p99 * 1.0e6, total.total * 1.0e3);
+
+	size_t peakPoolBytes = 0;
+	for (size_t i = 0; i < jobs.size(); ++i)
+		peakPoolBytes = std::max (peakPoolBytes, jobs[i].peakPoolBytes);
+	const double shadersPerSecond = total.total > 0.0 ? double(total.count) / total.total : 0.0;
+	printf ("%i shaders x %i iterations, %.1f shaders/s, peak pool %i bytes\n", (int)jobs.size(), iterations, shadersPerSecond, (int)peakPoolBytes);
+
+	int result = 0;
+	if (argc > 3 && !WriteJSON (argv[3], jobs, iterations, phases, total, shadersPerSecond, peakPoolBytes))
+	{
+		printf ("can't write %s\n", argv[3]);
+		result = 1;
+	}
+
+	Hlsl2Glsl_Shutdown ();
+	return result;
+}
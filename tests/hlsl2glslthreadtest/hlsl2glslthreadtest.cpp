@@ -0,0 +1,843 @@
+// Translates the test corpus from several threads at once, and through
+// Hlsl2Glsl_TranslateBatch, and checks that the output is exactly the same
+// as a single threaded run produced. Then does it all again with the
+// translation cache, which has to give the same output as well. Also checks
+// that a shader parsed once translates for all targets as if parsed for each,
+// that variants sharing tokens translate as if each was translated alone, that
+// include files translate the same from the include cache, that shaders
+// parse the same from buffers that aren't zero terminated, and with other
+// memory pool options.
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <time.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#define snprintf _snprintf
+#else
+#include <dirent.h>
+#include <pthread.h>
+#endif
+
+#include "../../include/hlsl2glsl.h"
+
+
+static const int kDefaultThreadCount = 8;
+static const int kIterations = 4;
+static const int kCacheIterations = 2;
+
+
+typedef std::vector<std::string> StringVector;
+
+static bool EndsWith (const std::string& str, const std::string& sub)
+{
+	return (str.size() >= sub.size()) && (strncmp (str.c_str()+str.size()-sub.size(), sub.c_str(), sub.size())==0);
+}
+
+static StringVector GetFiles (const std::string& folder, const std::string& endsWith)
+{
+	StringVector res;
+
+	#ifdef _MSC_VER
+	WIN32_FIND_DATAA FindFileData;
+	HANDLE hFind = FindFirstFileA ((folder+"/*"+endsWith).c_str(), &FindFileData);
+	if (hFind == INVALID_HANDLE_VALUE)
+		return res;
+
+	do {
+		res.push_back (FindFileData.cFileName);
+	} while (FindNextFileA (hFind, &FindFileData));
+
+	FindClose (hFind);
+
+	#else
+
+	DIR *dirp;
+	struct dirent *dp;
+
+	if ((dirp = opendir(folder.c_str())) == NULL)
+		return res;
+
+	while ( (dp = readdir(dirp)) )
+	{
+		std::string fname = dp->d_name;
+		if (fname == "." || fname == "..")
+			continue;
+		if (!EndsWith (fname, endsWith))
+			continue;
+		res.push_back (fname);
+	}
+	closedir(dirp);
+
+	#endif
+
+	return res;
+}
+
+static bool ReadStringFromFile (const char* pathName, std::string& output)
+{
+	FILE* file = fopen(pathName, "rb");
+	if (file == NULL)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (length < 0)
+	{
+		fclose( file );
+		return false;
+	}
+
+	output.resize(length);
+	size_t readLength = length ? fread(&*output.begin(), 1, length, file) : 0;
+	fclose(file);
+
+	if (readLength != (size_t)length)
+	{
+		output.clear();
+		return false;
+	}
+	return true;
+}
+
+
+static bool C_DECL IncludeOpenCallback(bool isSystem, const char* fname, const char* parentfname, const char* parent, std::string& output, void* d)
+{
+	const std::string* folder = reinterpret_cast<const std::string*>(d);
+	std::string pathName = *folder + "/" + fname;
+	return ReadStringFromFile(pathName.c_str(), output);
+}
+
+
+// Shader and include files for the zero-copy callback and Hlsl2Glsl_ParseBuffer: read once,
+// and followed by bytes that must not be lexed. Counts the files that are open.
+struct ZeroCopyFiles
+{
+	std::string folder;
+	std::map<std::string, std::string> files;
+	std::map<const char*, int> open;
+	int closeErrors;
+};
+
+static const char kPastEnd[] = "<<=/*\"@#";
+
+static const char* ZeroCopyText (ZeroCopyFiles& files, const std::string& pathName, const std::string* source, size_t& length)
+{
+	std::map<std::string, std::string>::iterator it = files.files.find (pathName);
+	if (it == files.files.end())
+	{
+		std::string text;
+		if (source)
+			text = *source;
+		else if (!ReadStringFromFile (pathName.c_str(), text))
+			return NULL;
+		it = files.files.insert (std::make_pair (pathName, text + kPastEnd)).first;
+	}
+	length = it->second.size() - strlen (kPastEnd);
+	return it->second.data();
+}
+
+static bool C_DECL ZeroCopyIncludeOpen(bool isSystem, const char* fname, const char* parentfname, const char* parent, const char** text, size_t* length, void* d)
+{
+	ZeroCopyFiles& files = *reinterpret_cast<ZeroCopyFiles*>(d);
+	*text = ZeroCopyText (files, files.folder + "/" + fname, NULL, *length);
+	if (!*text)
+		return false;
+	++files.open[*text];
+	return true;
+}
+
+static void C_DECL ZeroCopyIncludeClose(const char* file, void* d)
+{
+	ZeroCopyFiles& files = *reinterpret_cast<ZeroCopyFiles*>(d);
+	if (--files.open[file] < 0)
+		++files.closeErrors;
+}
+
+
+// One translation: a shader, its entry point and the target to translate it for.
+struct TranslateJob
+{
+	std::string name;
+	std::string folder;
+	std::string source;
+	EShLanguage language;
+	const char* entryPoint;
+	ETargetVersion version;
+	unsigned options;
+};
+
+typedef std::vector<TranslateJob> JobVector;
+
+
+// What Hlsl2Glsl_TranslateBatch reports for a job.
+static std::string BatchResult (int result, const char* shader, const char* infoLog)
+{
+	std::string res = result ? "ok\n" : "failed\n";
+	res += shader;
+	res += infoLog;
+	return res;
+}
+
+
+// Translates a parsed shader, and adds the results to res.
+static int AddTranslateResult (ShHandle parser, const TranslateJob& job, std::string& res)
+{
+	int translateOk = Hlsl2Glsl_Translate (parser, job.entryPoint, job.version, job.options);
+	res += translateOk ? "translate ok\n" : "translate failed\n";
+	if (translateOk)
+	{
+		res += Hlsl2Glsl_GetShader (parser);
+
+		int count = Hlsl2Glsl_GetUniformCount (parser);
+		const ShUniformInfo* uni = Hlsl2Glsl_GetUniformInfo (parser);
+		for (int i = 0; i < count; ++i)
+		{
+			char buf[1000];
+			snprintf(buf,1000,"// %s:%s type %d arrsize %d %s\n", uni[i].name, uni[i].semantic?uni[i].semantic:"<none>", uni[i].type, uni[i].arraySize, uni[i].registerSpec?uni[i].registerSpec:"");
+			res += buf;
+		}
+	}
+	return translateOk;
+}
+
+
+static int ParseJob (ShHandle parser, const TranslateJob& job, ZeroCopyFiles* zeroCopy = NULL)
+{
+	if (zeroCopy)
+	{
+		Hlsl2Glsl_ParseCallbacksRef includeRefCB;
+		includeRefCB.includeOpenCallback = ZeroCopyIncludeOpen;
+		includeRefCB.includeCloseCallback = ZeroCopyIncludeClose;
+		includeRefCB.data = zeroCopy;
+		zeroCopy->folder = job.folder;
+
+		size_t length = 0;
+		const char* text = ZeroCopyText (*zeroCopy, job.name, &job.source, length);
+		return Hlsl2Glsl_ParseBuffer (parser, text, length, job.version, &includeRefCB, job.options);
+	}
+
+	// aggregate initialization, as hosts written against the original struct do
+	Hlsl2Glsl_ParseCallbacks includeCB = { IncludeOpenCallback, NULL, const_cast<std::string*>(&job.folder) };
+
+	return Hlsl2Glsl_Parse (parser, job.source.c_str(), job.version, &includeCB, job.options);
+}
+
+
+// Everything the library reports for a job: parse/translate results, info log,
+// shader text and uniforms. Also returns what the batch API should report for it.
+static std::string RunJobOn (ShHandle parser, const TranslateJob& job, std::string* batchResult = NULL, ZeroCopyFiles* zeroCopy = NULL)
+{
+	std::string res;
+	int translateOk = 0;
+
+	int parseOk = ParseJob (parser, job, zeroCopy);
+	res += parseOk ? "parse ok\n" : "parse failed\n";
+	if (parseOk)
+		translateOk = AddTranslateResult (parser, job, res);
+	const char* infoLog = Hlsl2Glsl_GetInfoLog (parser);
+	res += infoLog;
+	if (batchResult)
+		*batchResult = BatchResult (translateOk, translateOk ? Hlsl2Glsl_GetShader (parser) : "", infoLog);
+	return res;
+}
+
+static std::string RunJob (const TranslateJob& job, std::string* batchResult = NULL, ZeroCopyFiles* zeroCopy = NULL)
+{
+	ShHandle parser = Hlsl2Glsl_ConstructCompiler (job.language);
+	std::string res = RunJobOn (parser, job, batchResult, zeroCopy);
+	Hlsl2Glsl_DestructCompiler (parser);
+	return res;
+}
+
+
+// Parses each shader once, for the target of its first job, then translates it for
+// the targets of all its jobs; returns the number of differences from parsing it
+// for every target.
+static int RunTranslateMany (const JobVector& jobs, const StringVector& expected, const char* what)
+{
+	int errors = 0;
+	size_t first = 0;
+	while (first < jobs.size())
+	{
+		size_t end = first + 1;
+		while (end < jobs.size() && jobs[end].name == jobs[first].name && jobs[end].language == jobs[first].language)
+			++end;
+
+		ShHandle parser = Hlsl2Glsl_ConstructCompiler (jobs[first].language);
+		if (ParseJob (parser, jobs[first]))
+		{
+			for (size_t i = first; i < end; ++i)
+			{
+				// a shader that doesn't parse for this target can't translate for it either
+				std::string res = "parse ok\n";
+				int translateOk = AddTranslateResult (parser, jobs[i], res);
+				res += Hlsl2Glsl_GetInfoLog (parser);
+				const bool parses = expected[i].compare (0, 9, "parse ok\n") == 0;
+				if (parses ? res != expected[i] : translateOk != 0)
+				{
+					if (errors == 0)
+						printf ("%stranslate many: first difference in %s\n", what, jobs[i].name.c_str());
+					++errors;
+				}
+			}
+		}
+		Hlsl2Glsl_DestructCompiler (parser);
+		first = end;
+	}
+	if (errors)
+		printf ("%stranslate many: %i translations differ from parsing for each target\n", what, errors);
+	return errors;
+}
+
+
+// Translates each shader as variants with macros it doesn't use, which all have to share
+// the translation of the first one, the same as the batch API gives; then a shader whose
+// variants do differ. Returns the number of differences.
+static int RunVariants (const JobVector& jobs, const StringVector& expectedBatch, const char* what)
+{
+	const Hlsl2Glsl_Define kUnused[] = { { "HLSL2GLSL_TEST_UNUSED", NULL }, { "HLSL2GLSL_TEST_OTHER", "2" } };
+	const int kVariantCount = 4;
+
+	int errors = 0;
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		Hlsl2Glsl_ParseCallbacks includeCB;
+		includeCB.includeOpenCallback = IncludeOpenCallback;
+		includeCB.includeCloseCallback = NULL;
+		includeCB.data = const_cast<std::string*>(&jobs[i].folder);
+
+		Hlsl2Glsl_Variant variants[kVariantCount];
+		variants[0].defines = NULL;        variants[0].defineCount = 0;
+		variants[1].defines = &kUnused[0]; variants[1].defineCount = 1;
+		variants[2].defines = &kUnused[1]; variants[2].defineCount = 1;
+		variants[3].defines = &kUnused[0]; variants[3].defineCount = 2;
+
+		ShHandle parser = Hlsl2Glsl_ConstructCompiler (jobs[i].language);
+		Hlsl2Glsl_TranslateVariants (parser, jobs[i].source.c_str(), jobs[i].entryPoint, jobs[i].version, &includeCB, jobs[i].options, variants, kVariantCount);
+		Hlsl2Glsl_DestructCompiler (parser);
+
+		for (int v = 0; v < kVariantCount; ++v)
+		{
+			if (variants[v].sharedWith != 0 || BatchResult (variants[v].result, variants[v].shader.c_str(), variants[v].infoLog.c_str()) != expectedBatch[i])
+			{
+				if (errors == 0)
+					printf ("%svariants: first difference in %s\n", what, jobs[i].name.c_str());
+				++errors;
+			}
+		}
+	}
+
+	// Variants with and without VARIANT_RED have to translate like the source with
+	// the #if resolved by hand, which has the same tokens on the same lines.
+	const char* kSource =
+		"float4 main () : COLOR0 {\n"
+		"#if VARIANT_RED\n"
+		"\treturn float4 (1.0, 0.0, 0.0, 1.0);\n"
+		"#else\n"
+		"\treturn float4 (0.0, 0.0, 1.0, 1.0);\n"
+		"#endif\n"
+		"}\n";
+	const Hlsl2Glsl_Define kRed[] = { { "VARIANT_RED", NULL }, { "VARIANT_OFF", "0" } };
+	const Hlsl2Glsl_Define kNotRed[] = { { "VARIANT_RED", "0" } };
+	Hlsl2Glsl_Variant variants[kVariantCount];
+	variants[0].defines = NULL;    variants[0].defineCount = 0;
+	variants[1].defines = kRed;    variants[1].defineCount = 1;
+	variants[2].defines = kNotRed; variants[2].defineCount = 1;
+	variants[3].defines = kRed;    variants[3].defineCount = 2;
+	const int kSharedWith[kVariantCount] = { 0, 1, 0, 1 };
+
+	std::string sources[2] = { kSource, kSource };
+	sources[0].replace (sources[0].find ("#if VARIANT_RED"), 15, "#if 0");
+	sources[1].replace (sources[1].find ("#if VARIANT_RED"), 15, "#if 1");
+	std::string expectedShaders[2];
+	ShHandle parser = Hlsl2Glsl_ConstructCompiler (EShLangFragment);
+	for (int s = 0; s < 2; ++s)
+	{
+		if (Hlsl2Glsl_Parse (parser, sources[s].c_str(), ETargetGLSL_110, NULL, 0) && Hlsl2Glsl_Translate (parser, "main", ETargetGLSL_110, 0))
+			expectedShaders[s] = Hlsl2Glsl_GetShader (parser);
+	}
+	const int succeeded = Hlsl2Glsl_TranslateVariants (parser, kSource, "main", ETargetGLSL_110, NULL, 0, variants, kVariantCount);
+	Hlsl2Glsl_DestructCompiler (parser);
+
+	bool ok = succeeded == kVariantCount && !expectedShaders[0].empty() && expectedShaders[0] != expectedShaders[1];
+	for (int v = 0; v < kVariantCount; ++v)
+		ok = ok && variants[v].sharedWith == kSharedWith[v] && variants[v].shader == expectedShaders[kSharedWith[v]];
+	if (!ok)
+	{
+		printf ("%svariants: macros are not applied to each variant\n", what);
+		++errors;
+	}
+
+	if (errors)
+		printf ("%svariants: %i variants differ\n", what, errors);
+	return errors;
+}
+
+
+// The jobs, with one line shaders that include the original shaders.
+static JobVector MakeIncluders (const JobVector& jobs)
+{
+	JobVector includers = jobs;
+	for (size_t i = 0; i < includers.size(); ++i)
+		includers[i].source = "#include \"" + jobs[i].name.substr (jobs[i].name.find ('/') + 1) + "\"\n";
+	return includers;
+}
+
+
+// Includes each shader from a one line shader, without the include cache, and
+// then twice with it (lexing the shader, then taking its tokens from the cache).
+// Returns the number of differences.
+static int RunIncludeCache (const JobVector& jobs)
+{
+	JobVector includers = MakeIncluders (jobs);
+
+	StringVector expected (includers.size());
+	for (size_t i = 0; i < includers.size(); ++i)
+		expected[i] = RunJob (includers[i]);
+
+	int errors = 0;
+	Hlsl2Glsl_EnableIncludeCache ();
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (size_t i = 0; i < includers.size(); ++i)
+		{
+			if (RunJob (includers[i]) != expected[i])
+			{
+				if (errors == 0)
+					printf ("include cache: first difference in %s\n", jobs[i].name.c_str());
+				++errors;
+			}
+		}
+	}
+
+	Hlsl2Glsl_IncludeCacheStats stats;
+	Hlsl2Glsl_GetIncludeCacheStats (&stats);
+	Hlsl2Glsl_InvalidateIncludeCache (NULL);
+	Hlsl2Glsl_IncludeCacheStats cleared;
+	Hlsl2Glsl_GetIncludeCacheStats (&cleared);
+	if (stats.hits < jobs.size() || stats.misses == 0 || stats.files == 0 || cleared.files != 0 || cleared.bytes != 0)
+	{
+		printf ("include cache: wrong counters, %u hits %u misses %u files\n", stats.hits, stats.misses, stats.files);
+		++errors;
+	}
+	Hlsl2Glsl_DisableIncludeCache ();
+
+	if (errors)
+		printf ("include cache: %i translations differ\n", errors);
+	return errors;
+}
+
+
+// Translates all shaders on one compiler per language, whose pools start with small pages
+// that grow, keep few pages between shaders and reuse freed buffers; that has to give the
+// same results. Also checks the pool counters. Returns the number of differences.
+static int RunMemoryOptions (const JobVector& jobs, const StringVector& expected)
+{
+	Hlsl2Glsl_MemoryOptions options;
+	options.pageSize = 4096;
+	options.maxPageSize = 64 << 10;
+	options.keepBytes = 32 << 10;
+	options.reuseFreed = 1;
+
+	ShHandle parsers[EShLangCount];
+	for (int i = 0; i < EShLangCount; ++i)
+	{
+		parsers[i] = Hlsl2Glsl_ConstructCompiler (EShLanguage(i));
+		Hlsl2Glsl_SetMemoryOptions (parsers[i], &options);
+	}
+
+	int errors = 0;
+	unsigned reused = 0;
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		if (RunJobOn (parsers[jobs[i].language], jobs[i]) != expected[i])
+		{
+			if (errors == 0)
+				printf ("memory options: first difference in %s\n", jobs[i].name.c_str());
+			++errors;
+		}
+
+		Hlsl2Glsl_MemoryStats stats;
+		Hlsl2Glsl_GetMemoryStats (parsers[jobs[i].language], &stats);
+		reused += stats.reusedAllocations;
+		if (stats.bytesRequested == 0 || stats.bytesReserved > stats.peakBytes || stats.freeBytes > options.keepBytes ||
+			stats.bytesReused > stats.bytesRequested || stats.reusedAllocations > stats.allocations)
+		{
+			printf ("memory options: wrong counters for %s, %u bytes requested, %u reserved, %u peak, %u kept\n", jobs[i].name.c_str(),
+				(unsigned)stats.bytesRequested, (unsigned)stats.bytesReserved, (unsigned)stats.peakBytes, (unsigned)stats.freeBytes);
+			++errors;
+		}
+	}
+	if (reused == 0)
+	{
+		printf ("memory options: no buffers were reused\n");
+		++errors;
+	}
+
+	Hlsl2Glsl_MemoryOptions got;
+	Hlsl2Glsl_GetMemoryOptions (parsers[0], &got);
+	if (got.pageSize != options.pageSize || got.maxPageSize != options.maxPageSize || got.keepBytes != options.keepBytes || !got.reuseFreed)
+	{
+		printf ("memory options: options read back differ\n");
+		++errors;
+	}
+
+	for (int i = 0; i < EShLangCount; ++i)
+		Hlsl2Glsl_DestructCompiler (parsers[i]);
+
+	if (errors)
+		printf ("memory options: %i translations differ\n", errors);
+	return errors;
+}
+
+
+// Parses all shaders from buffers with bytes after them that aren't part of the shader,
+// with the zero-copy include callback. Returns the number of differences, and of files
+// not closed exactly once.
+static int RunZeroCopy (const JobVector& jobs, const StringVector& expected)
+{
+	ZeroCopyFiles files;
+	files.closeErrors = 0;
+
+	int errors = 0;
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		if (RunJob (jobs[i], NULL, &files) != expected[i])
+		{
+			if (errors == 0)
+				printf ("zero copy: first difference in %s\n", jobs[i].name.c_str());
+			++errors;
+		}
+	}
+	if (errors)
+		printf ("zero copy: %i translations differ\n", errors);
+
+	for (std::map<const char*, int>::const_iterator it = files.open.begin(); it != files.open.end(); ++it)
+		files.closeErrors += it->second != 0;
+	if (files.open.empty() || files.closeErrors)
+	{
+		printf ("zero copy: %i include files not closed once, of %i\n", files.closeErrors, (int)files.open.size());
+		++errors;
+	}
+	return errors;
+}
+
+
+// Preprocesses all shaders with Hlsl2Glsl_Preprocess, and parses the text it returns
+// without include files. Returns the number of differences from parsing the shaders,
+// and of shaders with includes that weren't listed.
+static int RunPreprocess (const JobVector& jobs, const StringVector& expected)
+{
+	int errors = 0;
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		const TranslateJob& job = jobs[i];
+		Hlsl2Glsl_ParseCallbacks includeCB;
+		includeCB.includeOpenCallback = IncludeOpenCallback;
+		includeCB.includeCloseCallback = NULL;
+		includeCB.data = const_cast<std::string*>(&job.folder);
+
+		Hlsl2Glsl_PreprocessResult result;
+		bool same;
+		if (Hlsl2Glsl_Preprocess (job.source.data(), job.source.size(), &includeCB, NULL, 0, &result))
+		{
+			TranslateJob flattened = job;
+			flattened.source = result.text;
+			same = RunJob (flattened) == expected[i];
+		}
+		else
+		{
+			// parsing fails, too, though it can stop on a syntax error before getting to it
+			same = expected[i].compare (0, 13, "parse failed\n") == 0 && !result.infoLog.empty();
+		}
+		if (!same)
+		{
+			if (errors == 0)
+				printf ("preprocess: first difference in %s\n", job.name.c_str());
+			++errors;
+		}
+
+		const bool hasIncludes = job.source.find ("#include") != std::string::npos;
+		if (hasIncludes != !result.includes.empty())
+		{
+			printf ("preprocess: %i include files listed for %s\n", (int)result.includes.size(), job.name.c_str());
+			++errors;
+		}
+	}
+	if (errors)
+		printf ("preprocess: %i translations differ\n", errors);
+	return errors;
+}
+
+
+static void AddJobs (JobVector& jobs, const std::string& baseFolder, const char* typeName,
+					 EShLanguage language, const char* entryPoint, const ETargetVersion* versions, int versionCount)
+{
+	const std::string folder = baseFolder + "/" + typeName;
+	StringVector inputFiles = GetFiles (folder, "-in.txt");
+	for (size_t i = 0; i < inputFiles.size(); ++i)
+	{
+		TranslateJob job;
+		job.name = std::string(typeName) + "/" + inputFiles[i];
+		job.folder = folder;
+		if (!ReadStringFromFile ((folder + "/" + inputFiles[i]).c_str(), job.source))
+			continue;
+		job.language = language;
+		job.entryPoint = entryPoint;
+		job.options = 0;
+		for (int v = 0; v < versionCount; ++v)
+		{
+			job.version = versions[v];
+			jobs.push_back (job);
+		}
+	}
+}
+
+
+struct ThreadData
+{
+	const JobVector* jobs;
+	const StringVector* expected;
+	size_t startJob;
+	int iterations;
+	bool invalidateIncludes; // after every job
+	int errors;
+	std::string firstError;
+};
+
+static void RunThread (ThreadData& data)
+{
+	const size_t n = data.jobs->size();
+	for (int iter = 0; iter < data.iterations; ++iter)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			// every thread starts at a different job, so that different
+			// shaders end up being translated at the same time
+			const size_t idx = (data.startJob + i) % n;
+			if (RunJob ((*data.jobs)[idx]) != (*data.expected)[idx])
+			{
+				if (data.errors == 0)
+					data.firstError = (*data.jobs)[idx].name;
+				++data.errors;
+			}
+			if (data.invalidateIncludes)
+				Hlsl2Glsl_InvalidateIncludeCache (NULL);
+		}
+	}
+}
+
+#ifdef _MSC_VER
+static DWORD WINAPI ThreadFunc (LPVOID d)
+{
+	RunThread (*reinterpret_cast<ThreadData*>(d));
+	return 0;
+}
+#else
+static void* ThreadFunc (void* d)
+{
+	RunThread (*reinterpret_cast<ThreadData*>(d));
+	return NULL;
+}
+#endif
+
+
+// Translates the jobs from many threads at once; returns the number of differences.
+// With invalidateIncludes, the first thread empties the include cache after each job.
+static int RunThreads (const JobVector& jobs, const StringVector& expected, int threadCount, int iterations, const char* what, bool invalidateIncludes = false)
+{
+	std::vector<ThreadData> threads (threadCount);
+	for (int t = 0; t < threadCount; ++t)
+	{
+		threads[t].jobs = &jobs;
+		threads[t].expected = &expected;
+		threads[t].startJob = jobs.size() * t / threadCount;
+		threads[t].iterations = iterations;
+		threads[t].invalidateIncludes = invalidateIncludes && t == 0;
+		threads[t].errors = 0;
+	}
+
+	#ifdef _MSC_VER
+	std::vector<HANDLE> handles (threadCount);
+	for (int t = 0; t < threadCount; ++t)
+		handles[t] = CreateThread (NULL, 0, ThreadFunc, &threads[t], 0, NULL);
+	for (int t = 0; t < threadCount; ++t)
+	{
+		WaitForSingleObject (handles[t], INFINITE);
+		CloseHandle (handles[t]);
+	}
+	#else
+	std::vector<pthread_t> handles (threadCount);
+	for (int t = 0; t < threadCount; ++t)
+		pthread_create (&handles[t], NULL, ThreadFunc, &threads[t]);
+	for (int t = 0; t < threadCount; ++t)
+		pthread_join (handles[t], NULL);
+	#endif
+
+	int errors = 0;
+	for (int t = 0; t < threadCount; ++t)
+	{
+		if (threads[t].errors)
+			printf ("%sthread %i: %i translations differ from single threaded output, first: %s\n", what, t, threads[t].errors, threads[t].firstError.c_str());
+		errors += threads[t].errors;
+	}
+	return errors;
+}
+
+
+// Translates one line shaders that include the jobs' shaders from many threads, through
+// the include cache, while one of them keeps invalidating it: tokens are dropped from the
+// cache while other threads are reading them. Returns the number of differences.
+static int RunIncludeCacheThreads (const JobVector& jobs, int threadCount)
+{
+	JobVector includers = MakeIncluders (jobs);
+	StringVector expected (includers.size());
+	for (size_t i = 0; i < includers.size(); ++i)
+		expected[i] = RunJob (includers[i]);
+
+	Hlsl2Glsl_EnableIncludeCache ();
+	int errors = RunThreads (includers, expected, threadCount, 1, "include cache threads: ", true);
+	Hlsl2Glsl_DisableIncludeCache ();
+	return errors;
+}
+
+
+// Translates the jobs through the batch API; returns the number of differences.
+static int RunBatch (JobVector& jobs, const StringVector& expectedBatch, int threadCount, int iterations, const char* what)
+{
+	std::vector<Hlsl2Glsl_ParseCallbacks> batchCallbacks (jobs.size());
+	std::vector<Hlsl2Glsl_BatchJob> batch (jobs.size());
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		batchCallbacks[i].includeOpenCallback = IncludeOpenCallback;
+		batchCallbacks[i].includeCloseCallback = NULL;
+		batchCallbacks[i].data = &jobs[i].folder;
+		batch[i].source = jobs[i].source.c_str();
+		batch[i].entry = jobs[i].entryPoint;
+		batch[i].language = jobs[i].language;
+		batch[i].targetVersion = jobs[i].version;
+		batch[i].options = jobs[i].options;
+		batch[i].callbacks = &batchCallbacks[i];
+	}
+	int batchErrors = 0;
+	for (int iter = 0; iter < iterations; ++iter)
+	{
+		Hlsl2Glsl_TranslateBatch (&batch[0], (int)batch.size(), threadCount);
+		for (size_t i = 0; i < batch.size(); ++i)
+		{
+			if (BatchResult (batch[i].result, batch[i].shader.c_str(), batch[i].infoLog.c_str()) != expectedBatch[i])
+			{
+				if (batchErrors == 0)
+					printf ("%sbatch: first difference in %s\n", what, jobs[i].name.c_str());
+				++batchErrors;
+			}
+		}
+	}
+	if (batchErrors)
+		printf ("%sbatch: %i translations differ from single threaded output\n", what, batchErrors);
+	return batchErrors;
+}
+
+
+int main (int argc, const char** argv)
+{
+	if (argc < 2)
+	{
+		printf ("USAGE: hlsl2glslthreadtest testfolder [threadcount] [cachefolder]\n");
+		return 1;
+	}
+
+	int threadCount = argc > 2 ? atoi(argv[2]) : kDefaultThreadCount;
+	if (threadCount < 1)
+		threadCount = 1;
+
+	Hlsl2Glsl_Initialize ();
+
+	const std::string baseFolder = argv[1];
+	const ETargetVersion kAllTargets[] = { ETargetGLSL_110, ETargetGLSL_120, ETargetGLSL_ES_100, ETargetGLSL_ES_300 };
+	const ETargetVersion kGLTargets[] = { ETargetGLSL_110, ETargetGLSL_120 };
+
+	JobVector jobs;
+	AddJobs (jobs, baseFolder, "vertex", EShLangVertex, "main", kAllTargets, 4);
+	AddJobs (jobs, baseFolder, "fragment", EShLangFragment, "main", kAllTargets, 4);
+	AddJobs (jobs, baseFolder, "vertex-120", EShLangVertex, "main", kAllTargets, 4);
+	AddJobs (jobs, baseFolder, "fragment-120", EShLangFragment, "main", kAllTargets, 4);
+	AddJobs (jobs, baseFolder, "vertex-failures", EShLangVertex, "main", kGLTargets, 2);
+	AddJobs (jobs, baseFolder, "fragment-failures", EShLangFragment, "main", kGLTargets, 2);
+	AddJobs (jobs, baseFolder, "combined", EShLangVertex, "vs_main", kAllTargets, 4);
+	AddJobs (jobs, baseFolder, "combined", EShLangFragment, "ps_main", kAllTargets, 4);
+	if (jobs.empty())
+	{
+		printf ("no tests found in %s\n", baseFolder.c_str());
+		Hlsl2Glsl_Shutdown();
+		return 1;
+	}
+
+	// reference results, translated on this thread only
+	clock_t time0 = clock();
+	StringVector expected (jobs.size());
+	StringVector expectedBatch (jobs.size());
+	for (size_t i = 0; i < jobs.size(); ++i)
+		expected[i] = RunJob (jobs[i], &expectedBatch[i]);
+
+	// now translate everything from many threads at once, and through the batch API
+	int errors = RunThreads (jobs, expected, threadCount, kIterations, "");
+	errors += RunBatch (jobs, expectedBatch, threadCount, kIterations, "");
+	errors += RunTranslateMany (jobs, expected, "");
+	errors += RunVariants (jobs, expectedBatch, "");
+	errors += RunIncludeCache (jobs);
+	errors += RunIncludeCacheThreads (jobs, threadCount);
+	errors += RunZeroCopy (jobs, expected);
+	errors += RunPreprocess (jobs, expected);
+	errors += RunMemoryOptions (jobs, expected);
+
+	// and again with the cache; the first iteration fills it, then the results come from it.
+	// A small cache keeps dropping results, and one in files has to read them back.
+	Hlsl2Glsl_EnableCache (64 << 20, NULL);
+	errors += RunThreads (jobs, expected, threadCount, kCacheIterations, "cache: ");
+	errors += RunBatch (jobs, expectedBatch, threadCount, kCacheIterations, "cache: ");
+	errors += RunTranslateMany (jobs, expected, "cache: ");
+	errors += RunVariants (jobs, expectedBatch, "cache: ");
+	Hlsl2Glsl_EnableCache (64 << 10, NULL);
+	errors += RunThreads (jobs, expected, threadCount, kCacheIterations, "small cache: ");
+	if (argc > 3)
+	{
+		const std::string cacheFolder = argv[3];
+		StringVector oldFiles = GetFiles (cacheFolder, "");
+		for (size_t i = 0; i < oldFiles.size(); ++i)
+			remove ((cacheFolder + "/" + oldFiles[i]).c_str());
+
+		// only builds with a fingerprint of the library sources (the CMake one) keep files
+		if (!Hlsl2Glsl_EnableCache (0, cacheFolder.c_str()))
+			printf ("file cache: not supported by this build, skipped\n");
+		else
+		{
+			errors += RunThreads (jobs, expected, threadCount, kCacheIterations, "file cache: ");
+			if (GetFiles (cacheFolder, "").empty())
+			{
+				printf ("file cache: nothing written to %s\n", cacheFolder.c_str());
+				++errors;
+			}
+		}
+	}
+	Hlsl2Glsl_DisableCache ();
+
+	clock_t time1 = clock();
+	float t = float(time1-time0) / float(CLOCKS_PER_SEC);
+	if (errors != 0)
+		printf ("%i translations on %i threads, %i FAILED, %.2fs\n", (int)jobs.size()*kIterations*threadCount, threadCount, errors, t);
+	else
+		printf ("%i translations on %i threads succeeded, %.2fs\n", (int)jobs.size()*kIterations*threadCount, threadCount, t);
+
+	Hlsl2Glsl_Shutdown();
+
+	return errors ? 1 : 0;
+}